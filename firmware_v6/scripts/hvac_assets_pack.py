@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+"""
+Paczka obrazów UI na kartę SD (assets.bin) dla src/hvac_assets.c.
+
+    hvac_assets_pack.py -o assets.bin --builtin
+    hvac_assets_pack.py -o assets.bin heater=heater_new.bin snowflake=ikony/snowflake.c
+    hvac_assets_pack.py --list assets.bin
+
+Wejście: plik .bin z konwertera LVGL 9 (LVGLImage.py --ofmt BIN) albo
+plik .c z tablicą *_map[] i deskryptorem lv_image_dsc_t (jak src/ikony).
+--builtin dokłada wszystkie wkompilowane obrazy, więc paczka z kilkoma
+podmienionymi ikonami nie gubi pozostałych.
+
+Układ musi się zgadzać z src/hvac_assets.h (wersja 1, little-endian).
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+import zlib
+
+MAGIC = 0x54534148  # "HAST"
+VERSION = 1
+ALIGN = 64          # linia cache M7 / DMA2D
+
+HDR = struct.Struct("<IHHII")
+ENTRY = struct.Struct("<28sIIHHB3xI")
+LV_BIN_HDR = struct.Struct("<BBHHHHH")
+LV_IMAGE_HEADER_MAGIC = 0x19
+
+# lv_color_format_t z LVGL 9
+COLOR_FORMATS = {
+    "L8": 0x06, "I1": 0x07, "I2": 0x08, "I4": 0x09, "I8": 0x0A,
+    "A1": 0x0B, "A2": 0x0C, "A4": 0x0D, "A8": 0x0E,
+    "RGB888": 0x0F, "ARGB8888": 0x10, "XRGB8888": 0x11,
+    "RGB565": 0x12, "ARGB8565": 0x13, "RGB565A8": 0x14,
+}
+
+# nazwy z hvac_asset_names[] -> źródła wkompilowane
+SRC_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src", "ikony")
+BUILTIN = {
+    "setpoint": "TP_type1__not_active.c",
+    "snowflake": "snowflake.c",
+    "heater": "heater.c",
+    "heat_exchange": "heat_exchange.c",
+    "seq_cool_dead_heat": "seq_img_cool_dead_heat.c",
+    "seq_cool_rec_dead_rec_heat": "seq_img_cool_rec_dead_rec_heat.c",
+}
+
+
+def load_c(path):
+    with open(path, "r", encoding="utf-8") as f:
+        src = f.read()
+
+    m = re.search(r"_map\[\]\s*=\s*\{(.*?)\};", src, re.S)
+    if not m:
+        raise ValueError(f"{path}: no *_map[] array")
+    data = bytes(int(x, 16) for x in re.findall(r"0x([0-9a-fA-F]{2})", m.group(1)))
+
+    def field(name):
+        fm = re.search(r"\.header\." + name + r"\s*=\s*(\w+)", src)
+        if not fm:
+            raise ValueError(f"{path}: missing .header.{name}")
+        return fm.group(1)
+
+    cf_name = field("cf").replace("LV_COLOR_FORMAT_", "")
+    if cf_name not in COLOR_FORMATS:
+        raise ValueError(f"{path}: unsupported color format {cf_name}")
+    return COLOR_FORMATS[cf_name], int(field("w")), int(field("h")), data
+
+
+def load_bin(path):
+    with open(path, "rb") as f:
+        raw = f.read()
+    if len(raw) < LV_BIN_HDR.size:
+        raise ValueError(f"{path}: too short")
+    magic, cf, _flags, w, h, _stride, _ = LV_BIN_HDR.unpack_from(raw)
+    if magic != LV_IMAGE_HEADER_MAGIC:
+        raise ValueError(f"{path}: not an LVGL 9 image (.bin)")
+    return cf, w, h, raw[LV_BIN_HDR.size:]
+
+
+def load_image(path):
+    return load_c(path) if path.endswith(".c") else load_bin(path)
+
+
+def pack(images):
+    names = sorted(images)
+    table_end = HDR.size + ENTRY.size * len(names)
+    off = (table_end + ALIGN - 1) // ALIGN * ALIGN
+
+    entries = []
+    blobs = bytearray()
+    for name in names:
+        cf, w, h, data = images[name]
+        if len(name.encode()) >= 28:
+            raise ValueError(f"{name}: name too long")
+        entries.append(ENTRY.pack(name.encode(), off + len(blobs), len(data), w, h, cf,
+                                  zlib.crc32(data) & 0xFFFFFFFF))
+        blobs += data
+        blobs += bytes(-len(blobs) % ALIGN)
+
+    table = b"".join(entries)
+    hdr = HDR.pack(MAGIC, VERSION, len(names), ALIGN, zlib.crc32(table) & 0xFFFFFFFF)
+    head = hdr + table
+    return head + bytes(off - len(head)) + blobs
+
+
+def list_bundle(path):
+    with open(path, "rb") as f:
+        img = f.read()
+    magic, version, count, align, crc = HDR.unpack_from(img)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("not a v1 asset bundle")
+    table = img[HDR.size:HDR.size + ENTRY.size * count]
+    print(f"{path}: {count} images, align {align}, {len(img)} B, "
+          f"table CRC {'ok' if zlib.crc32(table) & 0xFFFFFFFF == crc else 'BAD'}")
+    for i in range(count):
+        name, off, size, w, h, cf, dcrc = ENTRY.unpack_from(table, i * ENTRY.size)
+        ok = zlib.crc32(img[off:off + size]) & 0xFFFFFFFF == dcrc
+        name = name.split(b"\0", 1)[0].decode()
+        print(f"  {name:28s} {w:3d}x{h:<3d} cf=0x{cf:02x} "
+              f"@{off:<7d} {size:6d} B {'ok' if ok else 'CRC BAD'}")
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("-o", "--output", help="bundle to write")
+    ap.add_argument("--builtin", action="store_true", help="include all images from src/ikony")
+    ap.add_argument("--list", metavar="BUNDLE", help="print bundle contents")
+    ap.add_argument("images", nargs="*", metavar="NAME=FILE")
+    args = ap.parse_args()
+
+    try:
+        if args.list:
+            list_bundle(args.list)
+            return 0
+
+        if not args.output:
+            ap.error("output file required")
+
+        images = {}
+        if args.builtin:
+            for name, fname in BUILTIN.items():
+                images[name] = load_c(os.path.join(SRC_DIR, fname))
+        for spec in args.images:
+            name, sep, path = spec.partition("=")
+            if not sep:
+                raise ValueError(f"{spec}: expected NAME=FILE")
+            if name not in BUILTIN:
+                print(f"hvac_assets_pack: warning: {name} is not used by the firmware",
+                      file=sys.stderr)
+            images[name] = load_image(path)
+        if not images:
+            raise ValueError("no images")
+
+        with open(args.output, "wb") as f:
+            f.write(pack(images))
+    except (OSError, ValueError) as e:
+        print(f"hvac_assets_pack: {e}", file=sys.stderr)
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""
+Konwerter konfiguracji HVAC: JSON -> binarny obraz (struct hvac_cfg_bin).
+
+    hvac_cfg2bin.py config1.json config1.bin
+    hvac_cfg2bin.py --dump config1.bin
+
+Układ musi się zgadzać z src/hvac_cfg_bin.h (wersja 1, 100 B, little-endian).
+Brakujące pola mają wartość 0, tak jak w loaderze JSON w firmware.
+"""
+
+import argparse
+import json
+import struct
+import sys
+import zlib
+
+MAGIC = 0x47464348  # "HCFG"
+VERSION = 1
+
+SEQ_TYPES = ["cool_dead_heat", "cool_rec_dead_rec_heat"]
+
+IO_FIELDS = [
+    "t_supply_ai", "t_extract_ai", "t_exhaust_ai", "t_outdoor_ai", "frost_ai",
+    "bypass_ao", "fan_vfd_ao", "heater_ao", "cooler_ao",
+]
+SEQ_BANDS = ["cooling", "heating", "heat_recovery", "deadband"]
+
+# magic, version, length, setpoint, pid(3), io(9), seq(8), sequence_type, reserved(3)
+BODY = struct.Struct("<IHHi3i9i8iB3x")
+LENGTH = BODY.size + 4
+
+
+def _int(obj, key):
+    v = obj.get(key, 0)
+    if not isinstance(v, int) or isinstance(v, bool):
+        raise ValueError(f"{key}: integer expected, got {v!r}")
+    if not -2**31 <= v < 2**31:
+        raise ValueError(f"{key}: out of int32 range")
+    return v
+
+
+def encode(cfg):
+    pid = cfg.get("pid", {})
+    io = cfg.get("io", {})
+    seq = cfg.get("seq", {})
+
+    seq_type = cfg.get("sequence_type")
+    if seq_type is None:
+        seq_idx = 0
+    elif seq_type in SEQ_TYPES:
+        seq_idx = SEQ_TYPES.index(seq_type) + 1
+    else:
+        raise ValueError(f"unknown sequence_type {seq_type!r}")
+
+    bands = []
+    for name in SEQ_BANDS:
+        band = seq.get(name, {})
+        bands += [_int(band, "from_percent"), _int(band, "to_percent")]
+
+    body = BODY.pack(
+        MAGIC, VERSION, LENGTH,
+        _int(cfg, "setpoint"),
+        _int(pid, "kp"), _int(pid, "ki"), _int(pid, "kd"),
+        *[_int(io, f) for f in IO_FIELDS],
+        *bands,
+        seq_idx,
+    )
+    return body + struct.pack("<I", zlib.crc32(body) & 0xFFFFFFFF)
+
+
+def decode(img):
+    if len(img) < LENGTH:
+        raise ValueError("image too short")
+
+    f = BODY.unpack_from(img)
+    magic, version, length = f[0], f[1], f[2]
+    if magic != MAGIC or version != VERSION or length != LENGTH:
+        raise ValueError("not a v1 HVAC config image")
+
+    (crc,) = struct.unpack_from("<I", img, length - 4)
+    if crc != zlib.crc32(img[:length - 4]) & 0xFFFFFFFF:
+        raise ValueError("CRC mismatch")
+
+    vals = list(f[3:])
+    cfg = {"setpoint": vals.pop(0)}
+    cfg["pid"] = dict(zip(["kp", "ki", "kd"], vals[0:3]))
+    cfg["io"] = dict(zip(IO_FIELDS, vals[3:12]))
+    cfg["seq"] = {
+        name: {"from_percent": vals[12 + 2 * i], "to_percent": vals[13 + 2 * i]}
+        for i, name in enumerate(SEQ_BANDS)
+    }
+    if vals[20]:
+        cfg["sequence_type"] = SEQ_TYPES[vals[20] - 1]
+    return cfg
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--dump", action="store_true", help="decode a binary image to JSON")
+    ap.add_argument("input")
+    ap.add_argument("output", nargs="?")
+    args = ap.parse_args()
+
+    try:
+        if args.dump:
+            with open(args.input, "rb") as f:
+                print(json.dumps(decode(f.read()), indent=4))
+            return 0
+
+        if not args.output:
+            ap.error("output file required")
+
+        with open(args.input, "r", encoding="utf-8") as f:
+            img = encode(json.load(f))
+        with open(args.output, "wb") as f:
+            f.write(img)
+    except (OSError, ValueError) as e:
+        print(f"hvac_cfg2bin: {e}", file=sys.stderr)
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
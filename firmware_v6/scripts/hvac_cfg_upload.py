@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+"""
+Wgrywanie configu JSON do sterownika HVAC bez karty SD.
+
+    hvac_cfg_upload.py /dev/ttyACM0 config1.json
+    hvac_cfg_upload.py --modbus 1 -b 19200 /dev/ttyUSB0 config1.json
+
+Powłoka (CONFIG_HVAC_SHELL): 'hvac upload begin', potem kawałki
+'hvac upload put <base64>' - każdy czeka na "ok", więc bufor linii
+powłoki nigdy się nie przepełni - i 'hvac upload commit'.
+
+Modbus RTU (--modbus ADRES, CONFIG_HVAC_MODBUS): FC 21 Write File Record,
+plik 1 = dokument (rekord = offset w słowach), plik 2 rekord 0 = 1
+zatwierdza. Nieparzysta długość dopełniona spacją.
+
+Firmware parsuje dokument w locie na kopii bieżącego configu (pola,
+których w dokumencie nie ma, zostają bez zmian) i waliduje wynik przed
+zastosowaniem; odrzucony config nie zmienia niczego. Wymaga pyserial.
+"""
+
+import argparse
+import base64
+import re
+import struct
+import sys
+import time
+
+SHELL_CHUNK = 150           # bajtów na 'put'; base64 ~200 znaków na linię
+MB_WORDS = 119              # słów na ramkę FC 21 (liczba bajtów <= 0xF5)
+MB_FILE_CFG = 1
+MB_FILE_CFG_CTL = 2
+
+ANSI = re.compile(rb"\x1b\[[0-9;]*[A-Za-z]")
+
+
+def open_port(args):
+    try:
+        import serial
+    except ImportError:
+        raise ValueError("serial port needs pyserial (pip install pyserial)")
+
+    return serial.Serial(args.port, args.baud, timeout=args.timeout)
+
+
+# --- Powłoka ---
+
+class Shell:
+    def __init__(self, port, timeout):
+        self.port = port
+        self.timeout = timeout
+
+    def cmd(self, line):
+        """Wysyła komendę i czeka na "ok..." albo błąd; zwraca linię odpowiedzi."""
+        self.port.reset_input_buffer()
+        self.port.write(line.encode() + b"\r")
+
+        buf = b""
+        deadline = time.monotonic() + self.timeout
+        while time.monotonic() < deadline:
+            buf += self.port.read(256)
+            while b"\n" in buf:
+                raw, buf = buf.split(b"\n", 1)
+                text = ANSI.sub(b"", raw).decode(errors="replace").strip()
+                # echo komendy i znak zachęty pomijamy
+                if not text or text.endswith(line):
+                    continue
+                if text.startswith("ok"):
+                    return text
+                raise ValueError(f"'{line.split(' ', 3)[2]}': {text}")
+        raise ValueError(f"no answer to '{line[:40]}'")
+
+
+def upload_shell(port, doc, timeout):
+    sh = Shell(port, timeout)
+
+    sh.cmd("hvac upload begin")
+    try:
+        for off in range(0, len(doc), SHELL_CHUNK):
+            chunk = base64.b64encode(doc[off:off + SHELL_CHUNK]).decode()
+            sh.cmd(f"hvac upload put {chunk}")
+    except (ValueError, KeyboardInterrupt):
+        port.write(b"hvac upload abort\r")
+        raise
+    return sh.cmd("hvac upload commit")
+
+
+# --- Modbus RTU ---
+
+def crc16_modbus(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return crc
+
+
+MB_EXCEPTIONS = {
+    0x02: "bad record number or file",
+    0x03: "config rejected (invalid JSON or value out of range)",
+    0x06: "another upload in progress",
+}
+
+
+def mb_write_file(port, addr, file, record, payload):
+    sub = struct.pack(">BHHH", 6, file, record, len(payload) // 2) + payload
+    pdu = struct.pack(">BB", 0x15, len(sub)) + sub
+    adu = bytes([addr]) + pdu
+    adu += struct.pack("<H", crc16_modbus(adu))
+
+    port.reset_input_buffer()
+    port.write(adu)
+
+    # echo żądania albo wyjątek (5 B)
+    rsp = port.read(5)
+    if len(rsp) == 5 and rsp[1] == 0x95:
+        if crc16_modbus(rsp) != 0:
+            raise ValueError("exception frame with bad CRC")
+        raise ValueError(MB_EXCEPTIONS.get(rsp[2], f"exception {rsp[2]:#04x}"))
+    rsp += port.read(len(adu) - len(rsp))
+    if rsp != adu:
+        raise ValueError(f"no answer or bad echo for record {record}")
+
+
+def upload_modbus(port, addr, doc):
+    if len(doc) % 2:
+        doc += b" "
+
+    words = len(doc) // 2
+    if words > 10000:
+        raise ValueError("document too large for Modbus file records (max 20000 B)")
+
+    try:
+        for rec in range(0, words, MB_WORDS):
+            mb_write_file(port, addr, MB_FILE_CFG, rec, doc[2 * rec:2 * (rec + MB_WORDS)])
+    except (ValueError, KeyboardInterrupt):
+        try:
+            mb_write_file(port, addr, MB_FILE_CFG_CTL, 0, struct.pack(">H", 0))
+        except ValueError:
+            pass
+        raise
+
+    mb_write_file(port, addr, MB_FILE_CFG_CTL, 0, struct.pack(">H", 1))
+    return "ok, applied on the next UI cycle"
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("port", help="serial port, e.g. /dev/ttyACM0")
+    ap.add_argument("config", help="JSON config file")
+    ap.add_argument("-b", "--baud", type=int, default=115200, help="baud rate")
+    ap.add_argument("--modbus", type=int, metavar="ADDR",
+                    help="upload over Modbus RTU to this slave instead of the shell")
+    ap.add_argument("--timeout", type=float, default=2.0, help="per-chunk answer timeout (s)")
+    args = ap.parse_args()
+
+    try:
+        with open(args.config, "rb") as f:
+            doc = f.read()
+        port = open_port(args)
+        start = time.monotonic()
+        if args.modbus is not None:
+            result = upload_modbus(port, args.modbus, doc)
+        else:
+            result = upload_shell(port, doc, args.timeout)
+    except KeyboardInterrupt:
+        return 1
+    except (OSError, ValueError) as e:
+        print(f"hvac_cfg_upload: {e}", file=sys.stderr)
+        return 1
+
+    print(f"{len(doc)} B in {time.monotonic() - start:.1f} s: {result}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
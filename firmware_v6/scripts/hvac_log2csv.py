@@ -0,0 +1,267 @@
+#!/usr/bin/env python3
+"""
+Dekoder logów HVAC (hvacNNNN.log) do CSV albo Parquet.
+
+    hvac_log2csv.py hvac0001.log hvac0002.log -o log.csv
+    hvac_log2csv.py --from 60000 --to 120000 hvac0001.log -o part.parquet
+    hvac_log2csv.py --info hvac0001.log
+
+Układ musi się zgadzać z src/hvac_log.h (wersja 3, little-endian;
+pliki v2 z 32-bitowym czasem też są czytane). t_ms to pełny czas pracy
+sterownika, boot numer jego uruchomienia - pliki są sortowane po
+(boot, t_ms). Zakres --from/--to (t_ms) szuka bloków w indeksie ze
+stopki; plik bez stopki (zanik zasilania) jest czytany blok po bloku.
+Parquet wymaga pyarrow.
+"""
+
+import argparse
+import csv
+import struct
+import sys
+import zlib
+
+MAGIC = 0x474F4C48         # "HLOG"
+FOOTER_MAGIC = 0x58444948  # "HIDX"
+VERSION = 3
+SECTOR = 512
+
+TAG_PAD, TAG_KEY, TAG_DELTA = 0, 1, 2
+F_TIMING = 1 << 19
+
+# magic, version, rec_size, period_ms, boot_no, num_ai, num_ao, reserved0, block_size, file_no,
+# reserved1, start_ms
+HDR = struct.Struct("<IHHIIBBHIIIQ")
+# v2: ... period_ms, start_ms (u32), num_ai, ...
+HDR_V2 = struct.Struct("<IHHIIBBHII")
+FOOTER = struct.Struct("<IIII")
+
+
+def rec_struct(num_ai, num_ao):
+    return struct.Struct(f"<II{num_ai}H{num_ao}HhhhH")
+
+
+def columns(num_ai, num_ao):
+    return (["boot", "t_ms", "frame"]
+            + [f"ai{i}_v" for i in range(num_ai)]
+            + [f"ao{i}_v" for i in range(num_ao)]
+            + ["setpoint_c", "u_pct", "i_term"])
+
+
+def _varint(buf, pos):
+    v = shift = 0
+    while True:
+        if pos >= len(buf):
+            raise ValueError("truncated varint")
+        b = buf[pos]
+        pos += 1
+        v |= (b & 0x7F) << shift
+        if b < 0x80:
+            return v, pos
+        shift += 7
+
+
+def _unzigzag(v):
+    return (v >> 1) ^ -(v & 1)
+
+
+def _unwrap(t32, ref):
+    """Pełny czas z 32-bitowego t_ms: najbliższy ref (plik < 2^31 ms)."""
+    d = (t32 - ref) & 0xFFFFFFFF
+    if d >= 1 << 31:
+        d -= 1 << 32
+    return ref + d
+
+
+class LogFile:
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        self.path = path
+
+        if len(self.data) < SECTOR:
+            raise ValueError(f"{path}: shorter than header")
+        magic, version = struct.unpack_from("<IH", self.data)
+        if magic != MAGIC or version not in (2, VERSION):
+            raise ValueError(f"{path}: not a v2/v{VERSION} HVAC log")
+        self.version = version
+        if version == VERSION:
+            (_, _, rec_size, self.period_ms, self.boot_no, self.num_ai, self.num_ao, _,
+             self.block_size, self.file_no, _, self.start_ms) = HDR.unpack_from(self.data)
+        else:
+            # v2: bez numeru uruchomienia, czas tylko 32-bitowy
+            (_, _, rec_size, self.period_ms, self.start_ms, self.num_ai, self.num_ao, _,
+             self.block_size, self.file_no) = HDR_V2.unpack_from(self.data)
+            self.boot_no = 0
+
+        self.rec = rec_struct(self.num_ai, self.num_ao)
+        if rec_size != self.rec.size or self.block_size % SECTOR:
+            raise ValueError(f"{path}: unexpected record/block size")
+
+        self.index = self._read_index()
+
+    def _read_index(self):
+        """Czas pierwszego rekordu każdego bloku albo None, gdy brak stopki."""
+        if len(self.data) < SECTOR + FOOTER.size:
+            return None
+        magic, count, crc, block_size = FOOTER.unpack_from(self.data, len(self.data) - FOOTER.size)
+        width = 8 if self.version == VERSION else 4
+        end = len(self.data) - FOOTER.size
+        start = end - width * count
+        if magic != FOOTER_MAGIC or block_size != self.block_size or start < SECTOR:
+            return None
+        raw = self.data[start:end]
+        if zlib.crc32(raw) & 0xFFFFFFFF != crc:
+            return None
+        self.data_end = start
+        return list(struct.unpack(f"<{count}{'Q' if width == 8 else 'I'}", raw))
+
+    def num_blocks(self):
+        if self.index is not None:
+            return len(self.index)
+        return (len(self.data) - SECTOR + self.block_size - 1) // self.block_size
+
+    def block(self, i):
+        off = SECTOR + i * self.block_size
+        end = off + self.block_size
+        if self.index is not None:
+            end = min(end, self.data_end)
+        return self.data[off:min(end, len(self.data))]
+
+    def decode_block(self, buf, ref):
+        """Rekordy bloku; t_ms klatki kluczowej odwijany względem ref."""
+        nvals = self.num_ai + self.num_ao + 3
+        prev = None
+        pos = 0
+
+        while pos < len(buf):
+            tag = buf[pos]
+            pos += 1
+
+            if tag == TAG_PAD:
+                return
+            if tag == TAG_KEY:
+                if pos + self.rec.size > len(buf):
+                    return
+                f = self.rec.unpack_from(buf, pos)
+                pos += self.rec.size
+                prev = list(f[:2 + nvals])
+                prev[0] = _unwrap(prev[0], ref)
+            elif tag == TAG_DELTA and prev is not None:
+                mask, pos = _varint(buf, pos)
+                dt, dframe = self.period_ms, 1
+                if mask & F_TIMING:
+                    v, pos = _varint(buf, pos)
+                    dt += _unzigzag(v)
+                    v, pos = _varint(buf, pos)
+                    dframe += v
+                prev[0] += dt
+                prev[1] = (prev[1] + dframe) & 0xFFFFFFFF
+                for i in range(nvals):
+                    if mask & (1 << i):
+                        v, pos = _varint(buf, pos)
+                        prev[2 + i] += _unzigzag(v)
+            else:
+                raise ValueError(f"{self.path}: bad record tag {tag:#x}")
+
+            yield prev
+
+    def rows(self, t_from=None, t_to=None):
+        first = 0
+        if self.index is not None and t_from is not None:
+            # ostatni blok zaczynający się nie później niż t_from
+            while first + 1 < len(self.index) and self.index[first + 1] <= t_from:
+                first += 1
+
+        na = self.num_ai
+        ref = self.start_ms
+        for i in range(first, self.num_blocks()):
+            if self.index is not None:
+                ref = _unwrap(self.index[i], ref) if self.version != VERSION else self.index[i]
+                if t_to is not None and ref > t_to:
+                    return
+            try:
+                for r in self.decode_block(self.block(i), ref):
+                    t = ref = r[0]
+                    if t_from is not None and t < t_from:
+                        continue
+                    if t_to is not None and t > t_to:
+                        return
+                    yield ([self.boot_no, t, r[1]]
+                           + [mv / 1000.0 for mv in r[2:2 + na + self.num_ao]]
+                           + [r[2 + na + self.num_ao] / 10.0,
+                              r[3 + na + self.num_ao] / 100.0,
+                              r[4 + na + self.num_ao] / 100.0])
+            except ValueError as e:
+                # uszkodzony blok - następny zaczyna się klatką kluczową
+                print(f"hvac_log2csv: block {i}: {e}", file=sys.stderr)
+
+
+def write_csv(path, cols, rows):
+    f = open(path, "w", newline="", encoding="utf-8") if path != "-" else sys.stdout
+    try:
+        w = csv.writer(f)
+        w.writerow(cols)
+        n = 0
+        for r in rows:
+            w.writerow(r)
+            n += 1
+    finally:
+        if f is not sys.stdout:
+            f.close()
+    return n
+
+
+def write_parquet(path, cols, rows):
+    try:
+        import pyarrow as pa
+        import pyarrow.parquet as pq
+    except ImportError:
+        raise ValueError("Parquet output needs pyarrow (pip install pyarrow)")
+
+    data = list(zip(*rows)) or [[] for _ in cols]
+    pq.write_table(pa.table(dict(zip(cols, data))), path)
+    return len(data[0])
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--info", action="store_true", help="print header and index summary")
+    ap.add_argument("--from", dest="t_from", type=int, help="first t_ms to output")
+    ap.add_argument("--to", dest="t_to", type=int, help="last t_ms to output")
+    ap.add_argument("-o", "--output", default="-", help="output .csv or .parquet (default: stdout CSV)")
+    ap.add_argument("input", nargs="+")
+    args = ap.parse_args()
+
+    try:
+        logs = sorted((LogFile(p) for p in args.input),
+                      key=lambda lf: (lf.boot_no, lf.start_ms, lf.file_no))
+
+        if args.info:
+            for lf in logs:
+                idx = lf.index
+                span = f"{idx[0]}..{idx[-1]} ms" if idx else "no footer"
+                print(f"{lf.path}: boot {lf.boot_no}, file {lf.file_no}, period {lf.period_ms} ms, "
+                      f"{lf.num_blocks()} blocks of {lf.block_size} B, {span}")
+            return 0
+
+        cols = columns(logs[0].num_ai, logs[0].num_ao)
+        if any(columns(lf.num_ai, lf.num_ao) != cols for lf in logs):
+            raise ValueError("input files differ in channel count")
+
+        rows = (r for lf in logs for r in lf.rows(args.t_from, args.t_to))
+        if args.output.endswith(".parquet"):
+            n = write_parquet(args.output, cols, rows)
+        else:
+            n = write_csv(args.output, cols, rows)
+        if args.output != "-":
+            print(f"{n} rows -> {args.output}", file=sys.stderr)
+    except (OSError, ValueError) as e:
+        print(f"hvac_log2csv: {e}", file=sys.stderr)
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
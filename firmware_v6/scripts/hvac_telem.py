@@ -0,0 +1,223 @@
+#!/usr/bin/env python3
+"""
+Odbiornik telemetrii HVAC (CONFIG_HVAC_TELEM): zapis do CSV i wykres na żywo.
+
+    hvac_telem.py /dev/ttyACM0 -o run.csv
+    hvac_telem.py /dev/ttyACM0 --plot ai0_v u_pct i_term --raw run.bin
+    hvac_telem.py --replay run.bin -o run.csv
+
+Układ musi się zgadzać z src/hvac_telem.h (wersja 1, little-endian):
+ramka = COBS(rekord + crc16) + 0x00, CRC-16/CCITT-FALSE po rekordzie.
+--raw zapisuje surowe bajty z łącza, --replay je odtwarza.
+Port szeregowy wymaga pyserial, wykres matplotlib.
+"""
+
+import argparse
+import binascii
+import csv
+import struct
+import sys
+import time
+
+TYPE_CYCLE = 0x01
+VERSION = 1
+
+# type, version, num_ai, num_ao, seq, t_us, frame, dt_us, exec_us, setpoint, u_pct, i_term
+HDR = struct.Struct("<BBBBIIIIIfff")
+
+
+def columns(num_ai, num_ao):
+    return (["seq", "t_us", "frame", "dt_us", "exec_us", "setpoint", "u_pct", "i_term"]
+            + [f"ai{i}_v" for i in range(num_ai)]
+            + [f"ao{i}_v" for i in range(num_ao)])
+
+
+def cobs_decode(buf):
+    out = bytearray()
+    i = 0
+    while i < len(buf):
+        code = buf[i]
+        if code == 0 or i + code > len(buf):
+            raise ValueError("bad COBS block")
+        out += buf[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(buf):
+            out.append(0)
+    return bytes(out)
+
+
+class Decoder:
+    """Dzieli strumień na ramki po zerach i dekoduje rekordy."""
+
+    def __init__(self):
+        self.pending = bytearray()
+        self.cols = None
+        self.last_seq = None
+        self.records = self.crc_err = self.bad = self.lost = 0
+
+    def feed(self, data):
+        self.pending += data
+        while True:
+            end = self.pending.find(0)
+            if end < 0:
+                return
+            frame = bytes(self.pending[:end])
+            del self.pending[:end + 1]
+            if frame:
+                row = self._frame(frame)
+                if row is not None:
+                    yield row
+
+    def _frame(self, frame):
+        try:
+            raw = cobs_decode(frame)
+        except ValueError:
+            self.bad += 1
+            return None
+
+        if len(raw) < HDR.size + 2:
+            self.bad += 1
+            return None
+        body, crc = raw[:-2], struct.unpack_from("<H", raw, len(raw) - 2)[0]
+        if binascii.crc_hqx(body, 0xFFFF) != crc:
+            self.crc_err += 1
+            return None
+
+        hdr = HDR.unpack_from(body)
+        rtype, version, num_ai, num_ao = hdr[:4]
+        if rtype != TYPE_CYCLE or version != VERSION or len(body) != HDR.size + 4 * (num_ai + num_ao):
+            self.bad += 1
+            return None
+
+        cols = columns(num_ai, num_ao)
+        if self.cols is None:
+            self.cols = cols
+        elif cols != self.cols:
+            self.bad += 1
+            return None
+
+        seq = hdr[4]
+        if self.last_seq is not None:
+            self.lost += (seq - self.last_seq - 1) & 0xFFFFFFFF
+        self.last_seq = seq
+        self.records += 1
+
+        chans = struct.unpack_from(f"<{num_ai + num_ao}f", body, HDR.size)
+        return list(hdr[4:]) + [round(v, 4) for v in chans]
+
+    def summary(self):
+        return (f"{self.records} records, {self.lost} lost, "
+                f"{self.crc_err} CRC errors, {self.bad} bad frames")
+
+
+def open_source(args):
+    if args.replay:
+        f = open(args.replay, "rb")
+        return lambda: f.read(4096)
+
+    try:
+        import serial
+    except ImportError:
+        raise ValueError("serial port needs pyserial (pip install pyserial)")
+
+    port = serial.Serial(args.port, args.baud, timeout=0.05)
+    return lambda: port.read(4096) or b""
+
+
+class Plot:
+    def __init__(self, names, window):
+        import matplotlib.pyplot as plt
+
+        self.plt = plt
+        self.names = names
+        self.window = window
+        self.t, self.y = [], {n: [] for n in names}
+        self.fig, self.ax = plt.subplots()
+        self.lines = {n: self.ax.plot([], [], label=n)[0] for n in names}
+        self.ax.set_xlabel("t [s]")
+        self.ax.legend(loc="upper left")
+        plt.ion()
+        plt.show()
+        self.next_draw = 0.0
+
+    def add(self, cols, row):
+        self.t.append(row[cols.index("t_us")] / 1e6)
+        for n in self.names:
+            self.y[n].append(row[cols.index(n)])
+        if len(self.t) > self.window:
+            del self.t[0]
+            for n in self.names:
+                del self.y[n][0]
+
+    def draw(self):
+        now = time.monotonic()
+        if now < self.next_draw or not self.t:
+            return
+        self.next_draw = now + 0.2
+        for n, line in self.lines.items():
+            line.set_data(self.t, self.y[n])
+        self.ax.relim()
+        self.ax.autoscale_view()
+        self.plt.pause(0.001)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("port", nargs="?", help="serial port, e.g. /dev/ttyACM0")
+    ap.add_argument("-b", "--baud", type=int, default=921600,
+                    help="baud rate (ignored for USB CDC ACM)")
+    ap.add_argument("--replay", help="decode a capture written with --raw")
+    ap.add_argument("--raw", help="also save the raw byte stream")
+    ap.add_argument("-o", "--output", help="output CSV")
+    ap.add_argument("--plot", nargs="+", metavar="COLUMN", help="live plot of these columns")
+    ap.add_argument("--window", type=int, default=600, help="records shown in the plot")
+    args = ap.parse_args()
+
+    if not args.port and not args.replay:
+        ap.error("need a port or --replay")
+
+    dec = Decoder()
+    out = writer = raw = plot = None
+
+    try:
+        read = open_source(args)
+        raw = open(args.raw, "wb") if args.raw else None
+        while True:
+            data = read()
+            if args.replay and not data:
+                break
+            if raw:
+                raw.write(data)
+            for row in dec.feed(data):
+                if writer is None and args.output:
+                    out = open(args.output, "w", newline="", encoding="utf-8")
+                    writer = csv.writer(out)
+                    writer.writerow(dec.cols)
+                if writer:
+                    writer.writerow(row)
+                if args.plot:
+                    if plot is None:
+                        missing = [n for n in args.plot if n not in dec.cols]
+                        if missing:
+                            raise ValueError(f"unknown columns: {', '.join(missing)}")
+                        plot = Plot(args.plot, args.window)
+                    plot.add(dec.cols, row)
+            if plot:
+                plot.draw()
+    except KeyboardInterrupt:
+        pass
+    except (OSError, ValueError) as e:
+        print(f"hvac_telem: {e}", file=sys.stderr)
+        return 1
+    finally:
+        for f in (out, raw):
+            if f:
+                f.close()
+        print(dec.summary(), file=sys.stderr)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
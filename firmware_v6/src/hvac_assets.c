@@ -0,0 +1,321 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include <string.h>
+
+#include "hvac_assets.h"
+
+#if defined(CONFIG_HVAC_ASSETS)
+#include <zephyr/devicetree.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/linker/devicetree_regions.h>
+#include <zephyr/sys/crc.h>
+#if defined(CONFIG_SHELL)
+#include <zephyr/shell/shell.h>
+#endif
+#include "hvac_storage.h"
+#endif
+
+LOG_MODULE_REGISTER(hvac_assets, CONFIG_LOG_DEFAULT_LEVEL);
+
+static const char *const hvac_asset_names[HVAC_ASSET_COUNT] = {
+    [HVAC_ASSET_SETPOINT]                 = "setpoint",
+    [HVAC_ASSET_SNOWFLAKE]                = "snowflake",
+    [HVAC_ASSET_HEATER]                   = "heater",
+    [HVAC_ASSET_HEAT_EXCHANGE]            = "heat_exchange",
+    [HVAC_ASSET_SEQ_COOL_DEAD_HEAT]       = "seq_cool_dead_heat",
+    [HVAC_ASSET_SEQ_COOL_REC_DEAD_REC_HEAT] = "seq_cool_rec_dead_rec_heat",
+};
+
+/* --- Obrazy wkompilowane --- */
+
+#if defined(CONFIG_HVAC_ASSETS_BUILTIN)
+
+LV_IMG_DECLARE(TP_type1__not_active);
+LV_IMG_DECLARE(snowflake);
+LV_IMG_DECLARE(heater);
+LV_IMG_DECLARE(heat_exchange);
+LV_IMG_DECLARE(seq_img_cool_dead_heat);
+LV_IMG_DECLARE(seq_img_cool_rec_dead_rec_heat);
+
+static const lv_image_dsc_t *const hvac_asset_builtin[HVAC_ASSET_COUNT] = {
+    [HVAC_ASSET_SETPOINT]                 = &TP_type1__not_active,
+    [HVAC_ASSET_SNOWFLAKE]                = &snowflake,
+    [HVAC_ASSET_HEATER]                   = &heater,
+    [HVAC_ASSET_HEAT_EXCHANGE]            = &heat_exchange,
+    [HVAC_ASSET_SEQ_COOL_DEAD_HEAT]       = &seq_img_cool_dead_heat,
+    [HVAC_ASSET_SEQ_COOL_REC_DEAD_REC_HEAT] = &seq_img_cool_rec_dead_rec_heat,
+};
+
+#endif
+
+/* --- Paczka z karty SD --- */
+
+#if defined(CONFIG_HVAC_ASSETS)
+
+#define HVAC_ASSETS_SLOT_SIZE (CONFIG_HVAC_ASSETS_CACHE_KB * 1024)
+#define HVAC_ASSETS_MAX_ENTRIES 32
+
+/* bufor w SDRAM płytki; na native_sim zwykły RAM */
+#if DT_NODE_HAS_STATUS(DT_NODELABEL(sdram1), okay)
+#define HVAC_ASSETS_SECTION Z_GENERIC_SECTION(LINKER_DT_NODE_REGION_NAME(DT_NODELABEL(sdram1)))
+#else
+#define HVAC_ASSETS_SECTION
+#endif
+
+BUILD_ASSERT(sizeof(struct hvac_assets_hdr) == 16, "bundle header layout changed");
+BUILD_ASSERT(sizeof(struct hvac_assets_entry) == 48, "bundle entry layout changed");
+
+/*
+ * Dwie połowy: widgety pokazują obrazy z aktywnej, nowa paczka ładuje
+ * się do drugiej. Stara połowa jest zwalniana dopiero po przepięciu
+ * widgetów w wątku LVGL.
+ */
+static uint8_t hvac_assets_cache[2][HVAC_ASSETS_SLOT_SIZE] __aligned(64) HVAC_ASSETS_SECTION;
+static lv_image_dsc_t hvac_assets_dsc[2][HVAC_ASSET_COUNT];
+static uint32_t hvac_assets_size[2];
+
+static int8_t hvac_assets_active = -1;          /* -1 = tylko wkompilowane */
+static atomic_t hvac_assets_pending = ATOMIC_INIT(0);
+static K_MUTEX_DEFINE(hvac_assets_lock);
+
+static int hvac_assets_find(const char *name)
+{
+    for (int i = 0; i < HVAC_ASSET_COUNT; i++) {
+        if (strncmp(name, hvac_asset_names[i], HVAC_ASSETS_NAME_LEN) == 0) {
+            return i;
+        }
+    }
+    return -ENOENT;
+}
+
+static int hvac_assets_parse(int slot, uint32_t len)
+{
+    const uint8_t *buf = hvac_assets_cache[slot];
+    const struct hvac_assets_hdr *hdr = (const void *)buf;
+    const struct hvac_assets_entry *ent = (const void *)(hdr + 1);
+    lv_image_dsc_t *dsc = hvac_assets_dsc[slot];
+
+    if (len < sizeof(*hdr) || hdr->magic != HVAC_ASSETS_MAGIC ||
+        hdr->version != HVAC_ASSETS_VERSION) {
+        LOG_ERR("Not an asset bundle");
+        return -EINVAL;
+    }
+
+    size_t table = (size_t)hdr->count * sizeof(*ent);
+
+    if (hdr->count > HVAC_ASSETS_MAX_ENTRIES || sizeof(*hdr) + table > len ||
+        hdr->align < 4 || (hdr->align & (hdr->align - 1)) != 0 ||
+        crc32_ieee((const uint8_t *)ent, table) != hdr->table_crc32) {
+        LOG_ERR("Bad asset table");
+        return -EBADMSG;
+    }
+
+    memset(dsc, 0, sizeof(hvac_assets_dsc[slot]));
+
+    for (int i = 0; i < hdr->count; i++) {
+        const struct hvac_assets_entry *e = &ent[i];
+        char name[HVAC_ASSETS_NAME_LEN + 1];
+
+        memcpy(name, e->name, HVAC_ASSETS_NAME_LEN);
+        name[HVAC_ASSETS_NAME_LEN] = '\0';
+
+        if (e->offset % hdr->align != 0 || e->offset > len || e->size > len - e->offset ||
+            e->size == 0 || e->w == 0 || e->h == 0) {
+            LOG_ERR("Asset %s out of bounds", name);
+            return -EBADMSG;
+        }
+        if (crc32_ieee(&buf[e->offset], e->size) != e->crc32) {
+            LOG_ERR("Asset %s CRC mismatch", name);
+            return -EBADMSG;
+        }
+
+        int id = hvac_assets_find(name);
+        if (id < 0) {
+            LOG_WRN("Unknown asset %s ignored", name);
+            continue;
+        }
+
+        /* deskryptor wskazuje prosto na dane w buforze */
+        dsc[id].header.magic = LV_IMAGE_HEADER_MAGIC;
+        dsc[id].header.cf    = e->cf;
+        dsc[id].header.w     = e->w;
+        dsc[id].header.h     = e->h;
+        dsc[id].data_size    = e->size;
+        dsc[id].data         = &buf[e->offset];
+    }
+
+    return hdr->count;
+}
+
+int hvac_assets_load(void)
+{
+    struct fs_file_t f;
+    struct fs_dirent ent;
+    int ret;
+
+    if (!hvac_storage_is_ready()) {
+        return -ENODEV;
+    }
+
+    k_mutex_lock(&hvac_assets_lock, K_FOREVER);
+
+    if (atomic_get(&hvac_assets_pending)) {
+        ret = -EBUSY;
+        goto out;
+    }
+
+    int slot = (hvac_assets_active == 0) ? 1 : 0;
+
+    ret = fs_stat(CONFIG_HVAC_ASSETS_FILE, &ent);
+    if (ret != 0) {
+        goto out;
+    }
+    if (ent.size > HVAC_ASSETS_SLOT_SIZE) {
+        LOG_ERR("%s: %u B does not fit in %u B cache", CONFIG_HVAC_ASSETS_FILE,
+                (uint32_t)ent.size, HVAC_ASSETS_SLOT_SIZE);
+        ret = -EFBIG;
+        goto out;
+    }
+
+    fs_file_t_init(&f);
+    ret = fs_open(&f, CONFIG_HVAC_ASSETS_FILE, FS_O_READ);
+    if (ret < 0) {
+        goto out;
+    }
+
+    /* jeden odczyt całego pliku - sterownik SD czyta wiele sektorów naraz */
+    ssize_t n = fs_read(&f, hvac_assets_cache[slot], ent.size);
+    fs_close(&f);
+    if (n != (ssize_t)ent.size) {
+        ret = (n < 0) ? (int)n : -EIO;
+        goto out;
+    }
+
+    ret = hvac_assets_parse(slot, n);
+    if (ret < 0) {
+        goto out;
+    }
+
+    hvac_assets_size[slot] = n;
+    atomic_set(&hvac_assets_pending, 1);
+    LOG_INF("Asset bundle loaded: %d images, %u B", ret, (uint32_t)n);
+    ret = 0;
+
+out:
+    k_mutex_unlock(&hvac_assets_lock);
+    if (ret != 0 && ret != -ENOENT && ret != -EBUSY) {
+        LOG_ERR("Asset bundle %s: %d", CONFIG_HVAC_ASSETS_FILE, ret);
+    }
+    return ret;
+}
+
+bool hvac_assets_apply_pending(void (*refresh)(void))
+{
+    if (!atomic_get(&hvac_assets_pending)) {
+        return false;
+    }
+
+    int old = hvac_assets_active;
+
+    hvac_assets_active = (old == 0) ? 1 : 0;
+
+    if (refresh != NULL) {
+        refresh();
+    }
+
+    /* dekoder LVGL mógł zapamiętać stare deskryptory - ich dane zaraz znikną */
+    if (old >= 0) {
+        for (int i = 0; i < HVAC_ASSET_COUNT; i++) {
+            if (hvac_assets_dsc[old][i].data != NULL) {
+                lv_image_cache_drop(&hvac_assets_dsc[old][i]);
+            }
+        }
+    }
+
+    atomic_set(&hvac_assets_pending, 0);
+    return true;
+}
+
+#if defined(CONFIG_SHELL)
+
+static int cmd_assets_reload(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    int ret = hvac_assets_load();
+    if (ret != 0) {
+        shell_error(sh, "Reload failed: %d", ret);
+        return ret;
+    }
+
+    shell_print(sh, "Loaded, UI switches on its next cycle");
+    return 0;
+}
+
+static int cmd_assets_info(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    int slot = hvac_assets_active;
+
+    if (slot < 0) {
+        shell_print(sh, "No bundle loaded (%s)", CONFIG_HVAC_ASSETS_FILE);
+    } else {
+        shell_print(sh, "Bundle %s: %u B in slot %d", CONFIG_HVAC_ASSETS_FILE,
+                    hvac_assets_size[slot], slot);
+    }
+
+    for (int i = 0; i < HVAC_ASSET_COUNT; i++) {
+        const lv_image_dsc_t *d = hvac_asset(i);
+        const char *src = (slot >= 0 && d == &hvac_assets_dsc[slot][i]) ? "sd" : "flash";
+
+        if (d == NULL) {
+            shell_print(sh, "  %-28s missing", hvac_asset_names[i]);
+        } else {
+            shell_print(sh, "  %-28s %3ux%-3u cf=0x%02x %6u B %s", hvac_asset_names[i],
+                        d->header.w, d->header.h, d->header.cf, d->data_size, src);
+        }
+    }
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(hvac_assets_cmds,
+    SHELL_CMD(reload, NULL, "Reload the asset bundle from SD", cmd_assets_reload),
+    SHELL_CMD(info, NULL, "Show where each image comes from", cmd_assets_info),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(assets, &hvac_assets_cmds, "UI image assets", NULL);
+
+#endif /* CONFIG_SHELL */
+
+#endif /* CONFIG_HVAC_ASSETS */
+
+/* --- API --- */
+
+const lv_image_dsc_t *hvac_asset(enum hvac_asset_id id)
+{
+    if ((unsigned int)id >= HVAC_ASSET_COUNT) {
+        return NULL;
+    }
+
+#if defined(CONFIG_HVAC_ASSETS)
+    if (hvac_assets_active >= 0 && hvac_assets_dsc[hvac_assets_active][id].data != NULL) {
+        return &hvac_assets_dsc[hvac_assets_active][id];
+    }
+#endif
+#if defined(CONFIG_HVAC_ASSETS_BUILTIN)
+    return hvac_asset_builtin[id];
+#else
+    return NULL;
+#endif
+}
+
+const char *hvac_asset_name(enum hvac_asset_id id)
+{
+    return ((unsigned int)id < HVAC_ASSET_COUNT) ? hvac_asset_names[id] : NULL;
+}
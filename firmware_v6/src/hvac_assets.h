@@ -0,0 +1,80 @@
+#ifndef HVAC_ASSETS_H
+#define HVAC_ASSETS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <lvgl.h>
+
+/*
+ * Ikony i wykresy sekwencji. Domyślnie wkompilowane (src/ikony), przy
+ * CONFIG_HVAC_ASSETS mogą pochodzić z paczki na karcie SD: plik jest
+ * wczytywany w całości do bufora w SDRAM, a deskryptory lv_image_dsc_t
+ * wskazują prosto na dane w buforze (bez kopiowania i dekodowania).
+ * Obraz nieobecny w paczce zostaje wkompilowany.
+ *
+ * Paczka (scripts/hvac_assets_pack.py), little-endian:
+ *   struct hvac_assets_hdr
+ *   struct hvac_assets_entry[count]
+ *   dane obrazów, każdy od offsetu wyrównanego do hdr.align
+ */
+
+enum hvac_asset_id {
+    HVAC_ASSET_SETPOINT,
+    HVAC_ASSET_SNOWFLAKE,
+    HVAC_ASSET_HEATER,
+    HVAC_ASSET_HEAT_EXCHANGE,
+    HVAC_ASSET_SEQ_COOL_DEAD_HEAT,
+    HVAC_ASSET_SEQ_COOL_REC_DEAD_REC_HEAT,
+    HVAC_ASSET_COUNT
+};
+
+#define HVAC_ASSETS_MAGIC    0x54534148u    /* "HAST" */
+#define HVAC_ASSETS_VERSION  1
+#define HVAC_ASSETS_NAME_LEN 28
+
+struct hvac_assets_hdr {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint32_t align;               /* wyrównanie danych, potęga dwójki >= 4 */
+    uint32_t table_crc32;         /* crc32 tablicy wpisów */
+};
+
+struct hvac_assets_entry {
+    char     name[HVAC_ASSETS_NAME_LEN];    /* np. "heater", zakończona zerem */
+    uint32_t offset;              /* od początku pliku */
+    uint32_t size;
+    uint16_t w;
+    uint16_t h;
+    uint8_t  cf;                  /* lv_color_format_t */
+    uint8_t  reserved[3];
+    uint32_t crc32;               /* crc32 danych */
+};
+
+/* aktualny obraz albo NULL, gdy nie ma go ani w paczce, ani we flashu */
+const lv_image_dsc_t *hvac_asset(enum hvac_asset_id id);
+
+/* nazwa obrazu w paczce */
+const char *hvac_asset_name(enum hvac_asset_id id);
+
+#if defined(CONFIG_HVAC_ASSETS)
+
+/*
+ * Wczytuje CONFIG_HVAC_ASSETS_FILE do wolnej połowy bufora i sprawdza
+ * sumy kontrolne. Z dowolnego wątku; nowe obrazy zaczynają obowiązywać
+ * dopiero w hvac_assets_apply_pending(). -EBUSY, gdy poprzednia paczka
+ * czeka na przełączenie.
+ */
+int hvac_assets_load(void);
+
+/*
+ * Wątek LVGL: przełącza na wczytaną paczkę i woła refresh(), żeby
+ * widgety dostały nowe deskryptory. Dopiero potem stara połowa bufora
+ * może zostać nadpisana. false, gdy nic nie czekało.
+ */
+bool hvac_assets_apply_pending(void (*refresh)(void));
+
+#endif /* CONFIG_HVAC_ASSETS */
+
+#endif /* HVAC_ASSETS_H */
@@ -0,0 +1,186 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/printk.h>
+#include <stdlib.h>
+
+#include "hvac_bench.h"
+
+#if !defined(CONFIG_ARCH_POSIX)
+#include <cmsis_core.h>
+#endif
+
+LOG_MODULE_REGISTER(hvac_bench, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define HVAC_BENCH_SAMPLES CONFIG_HVAC_BENCH_SAMPLES
+#define HVAC_BENCH_BATCH   CONFIG_HVAC_BENCH_BATCH
+
+static uint32_t hvac_bench_samples[HVAC_BENCH_SAMPLES];
+static uint32_t hvac_bench_overhead;
+static uint32_t hvac_bench_rng = CONFIG_HVAC_BENCH_SEED;
+
+/* --- Zegar --- */
+
+#if defined(CONFIG_ARCH_POSIX)
+
+/* hvac_bench_host.c - CLOCK_MONOTONIC hosta */
+uint64_t hvac_bench_host_ns(void);
+
+/*
+ * Ticki = ns. Licznik 32-bitowy przekręca się co 4.3 s, ale liczone są
+ * tylko różnice (modulo 2^32), a jedna partia trwa dużo krócej.
+ */
+static inline uint32_t hvac_bench_now(void)
+{
+    return (uint32_t)hvac_bench_host_ns();
+}
+
+static int hvac_bench_clock_init(void)
+{
+    return 0;
+}
+
+uint32_t hvac_bench_ticks_to_ns(uint32_t ticks)
+{
+    return ticks;
+}
+
+#else
+
+static inline uint32_t hvac_bench_now(void)
+{
+    return DWT->CYCCNT;
+}
+
+static int hvac_bench_clock_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+#if defined(CONFIG_CPU_CORTEX_M7)
+    DWT->LAR = 0xC5ACCE55;    /* odblokowanie rejestrów DWT na M7 */
+#endif
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    uint32_t c0 = DWT->CYCCNT;
+    k_busy_wait(10);
+    if (DWT->CYCCNT == c0) {
+        LOG_ERR("DWT cycle counter not running");
+        return -ENOTSUP;
+    }
+
+    return 0;
+}
+
+uint32_t hvac_bench_ticks_to_ns(uint32_t ticks)
+{
+    return (uint32_t)(((uint64_t)ticks * NSEC_PER_SEC) / SystemCoreClock);
+}
+
+#endif
+
+/* --- Wejścia losowe --- */
+
+uint32_t hvac_bench_rand(void)
+{
+    hvac_bench_rng ^= hvac_bench_rng << 13;
+    hvac_bench_rng ^= hvac_bench_rng >> 17;
+    hvac_bench_rng ^= hvac_bench_rng << 5;
+    return hvac_bench_rng;
+}
+
+float hvac_bench_rand_range(float lo, float hi)
+{
+    return lo + (hi - lo) * (float)(hvac_bench_rand() & 0xFFFFFF) / (float)0xFFFFFF;
+}
+
+/* --- Pomiar --- */
+
+static void hvac_bench_empty(void *ctx, uint32_t idx)
+{
+    ARG_UNUSED(ctx);
+    ARG_UNUSED(idx);
+}
+
+static uint32_t hvac_bench_sample(hvac_bench_fn_t fn, void *ctx, uint32_t *idx)
+{
+    uint32_t t0 = hvac_bench_now();
+
+    for (uint32_t i = 0; i < HVAC_BENCH_BATCH; i++) {
+        fn(ctx, (*idx)++);
+    }
+
+    return (hvac_bench_now() - t0) / HVAC_BENCH_BATCH;
+}
+
+static int hvac_bench_cmp(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+int hvac_bench_init(void)
+{
+    int ret = hvac_bench_clock_init();
+    if (ret != 0) {
+        return ret;
+    }
+
+    /* koszt pustego wywołania przez wskaźnik - odejmowany od wyników */
+    uint32_t idx = 0;
+    hvac_bench_overhead = UINT32_MAX;
+    for (int i = 0; i < 64; i++) {
+        hvac_bench_overhead = MIN(hvac_bench_overhead,
+                                  hvac_bench_sample(hvac_bench_empty, NULL, &idx));
+    }
+
+    return 0;
+}
+
+int hvac_bench_run(const char *name, hvac_bench_fn_t fn, void *ctx,
+                   uint32_t budget_ns, struct hvac_bench_result *res)
+{
+    uint32_t idx = 0;
+    uint64_t sum = 0;
+
+    /* rozgrzewka: cache, predyktor skoków */
+    for (int i = 0; i < 8; i++) {
+        (void)hvac_bench_sample(fn, ctx, &idx);
+    }
+
+    for (uint32_t i = 0; i < HVAC_BENCH_SAMPLES; i++) {
+        uint32_t t = hvac_bench_sample(fn, ctx, &idx);
+
+        t = (t > hvac_bench_overhead) ? (t - hvac_bench_overhead) : 0;
+        hvac_bench_samples[i] = t;
+        sum += t;
+    }
+
+    qsort(hvac_bench_samples, HVAC_BENCH_SAMPLES, sizeof(uint32_t), hvac_bench_cmp);
+
+    res->name       = name;
+    res->samples    = HVAC_BENCH_SAMPLES;
+    res->min_ticks  = hvac_bench_samples[0];
+    res->mean_ticks = (uint32_t)(sum / HVAC_BENCH_SAMPLES);
+    res->p99_ticks  = hvac_bench_samples[(HVAC_BENCH_SAMPLES * 99) / 100];
+    res->max_ticks  = hvac_bench_samples[HVAC_BENCH_SAMPLES - 1];
+    res->budget_ns  = budget_ns;
+    res->pass       = (budget_ns == 0) ||
+                      (hvac_bench_ticks_to_ns(res->p99_ticks) <= budget_ns);
+
+    return res->pass ? 0 : -ETIME;
+}
+
+void hvac_bench_print(const struct hvac_bench_result *res)
+{
+#if defined(CONFIG_ARCH_POSIX)
+    printk("BENCH %-28s min=%u ns mean=%u ns p99=%u ns max=%u ns budget=%u ns %s\n",
+           res->name, res->min_ticks, res->mean_ticks, res->p99_ticks,
+           res->max_ticks, res->budget_ns, res->pass ? "PASS" : "FAIL");
+#else
+    printk("BENCH %-28s min=%u mean=%u p99=%u max=%u cyc (p99=%u ns) budget=%u ns %s\n",
+           res->name, res->min_ticks, res->mean_ticks, res->p99_ticks,
+           res->max_ticks, hvac_bench_ticks_to_ns(res->p99_ticks),
+           res->budget_ns, res->pass ? "PASS" : "FAIL");
+#endif
+}
@@ -0,0 +1,39 @@
+#ifndef HVAC_BENCH_H
+#define HVAC_BENCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Mikrobenchmarki ścieżki regulacji.
+ * Zegar: DWT CYCCNT na Cortex-M (cykle), czas hosta na native_sim (ns).
+ * Każda próbka to średnia z CONFIG_HVAC_BENCH_BATCH wywołań.
+ */
+
+#define HVAC_BENCH_NUM_INPUTS 256
+
+/* idx to numer wywołania - wejścia bierze się z tablicy przygotowanej wcześniej */
+typedef void (*hvac_bench_fn_t)(void *ctx, uint32_t idx);
+
+struct hvac_bench_result {
+    const char *name;
+    uint32_t    samples;
+    uint32_t    min_ticks;
+    uint32_t    mean_ticks;
+    uint32_t    p99_ticks;
+    uint32_t    max_ticks;
+    uint32_t    budget_ns;   /* 0 = bez limitu */
+    bool        pass;
+};
+
+int      hvac_bench_init(void);
+uint32_t hvac_bench_rand(void);
+float    hvac_bench_rand_range(float lo, float hi);
+
+uint32_t hvac_bench_ticks_to_ns(uint32_t ticks);
+
+int  hvac_bench_run(const char *name, hvac_bench_fn_t fn, void *ctx,
+                    uint32_t budget_ns, struct hvac_bench_result *res);
+void hvac_bench_print(const struct hvac_bench_result *res);
+
+#endif /* HVAC_BENCH_H */
@@ -0,0 +1,16 @@
+/*
+ * Kontekst runnera native_simulator (kompilowany na hosta, poza obrazem
+ * Zephyra): zegar monotoniczny hosta dla hvac_bench.c. Czas wirtualny
+ * native_sim stoi podczas obliczeń, więc nie nadaje się do pomiaru.
+ */
+
+#include <stdint.h>
+#include <time.h>
+
+uint64_t hvac_bench_host_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
@@ -0,0 +1,112 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/sys/crc.h>
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+
+#if defined(CONFIG_FILE_SYSTEM)
+#include <zephyr/fs/fs.h>
+#endif
+
+#include "hvac_cfg_bin.h"
+
+LOG_MODULE_REGISTER(hvac_cfg_bin, CONFIG_LOG_DEFAULT_LEVEL);
+
+/* układ musi się zgadzać z scripts/hvac_cfg2bin.py */
+BUILD_ASSERT(sizeof(struct hvac_cfg_bin) == 100, "hvac_cfg_bin layout changed");
+BUILD_ASSERT(offsetof(struct hvac_cfg_bin, io) == 24, "hvac_cfg_bin layout changed");
+BUILD_ASSERT(offsetof(struct hvac_cfg_bin, seq) == 60, "hvac_cfg_bin layout changed");
+BUILD_ASSERT(offsetof(struct hvac_cfg_bin, sequence_type) == 92, "hvac_cfg_bin layout changed");
+
+const struct hvac_cfg_bin *hvac_cfg_bin_validate(const void *img, size_t len)
+{
+    const struct hvac_cfg_bin *bin = img;
+
+    if (img == NULL || len < sizeof(*bin) || ((uintptr_t)img & 3) != 0) {
+        return NULL;
+    }
+
+    if (bin->magic != HVAC_CFG_BIN_MAGIC) {
+        LOG_ERR("Binary config: bad magic");
+        return NULL;
+    }
+
+    if (bin->version != HVAC_CFG_BIN_VERSION) {
+        LOG_ERR("Binary config: unsupported version %u", bin->version);
+        return NULL;
+    }
+
+    /* crc32 leży na końcu `length` bajtów, wyrównany do 4 */
+    if (bin->length < sizeof(*bin) || bin->length > len || (bin->length & 3) != 0) {
+        LOG_ERR("Binary config: bad length %u", bin->length);
+        return NULL;
+    }
+
+    uint32_t crc_stored;
+    memcpy(&crc_stored, (const uint8_t *)img + bin->length - sizeof(uint32_t),
+           sizeof(crc_stored));
+
+    if (crc32_ieee(img, bin->length - sizeof(uint32_t)) != crc_stored) {
+        LOG_ERR("Binary config: CRC mismatch");
+        return NULL;
+    }
+
+    return bin;
+}
+
+void hvac_cfg_bin_to_config(const struct hvac_cfg_bin *bin, struct hvac_config *out)
+{
+    out->setpoint = bin->setpoint;
+    out->pid      = bin->pid;
+    out->io       = bin->io;
+    out->seq      = bin->seq;
+
+    uint8_t st = bin->sequence_type;
+    out->sequence_type = (st >= 1 && st <= HVAC_CFG_NUM_SEQ_TYPES) ?
+                         hvac_cfg_seq_types[st - 1] : NULL;
+}
+
+int hvac_cfg_bin_load(const void *img, size_t len, struct hvac_config *out)
+{
+    const struct hvac_cfg_bin *bin = hvac_cfg_bin_validate(img, len);
+    if (bin == NULL) {
+        return -EINVAL;
+    }
+
+    hvac_cfg_bin_to_config(bin, out);
+
+    /* CRC chroni przed uszkodzeniem, nie przed złymi wartościami z generatora */
+    if (!hvac_cfg_validate(out)) {
+        LOG_ERR("Binary config: value out of range");
+        return -ERANGE;
+    }
+    return 0;
+}
+
+#if defined(CONFIG_FILE_SYSTEM)
+/* SD nie jest mapowana w pamięci - obraz v1 ma 100 B, czytamy go na stos */
+int hvac_cfg_bin_load_file(const char *path, struct hvac_config *out)
+{
+    struct fs_file_t file;
+    uint32_t img[sizeof(struct hvac_cfg_bin) / sizeof(uint32_t)];
+
+    fs_file_t_init(&file);
+
+    int ret = fs_open(&file, path, FS_O_READ);
+    if (ret < 0) {
+        LOG_ERR("Cannot open %s: %d", path, ret);
+        return ret;
+    }
+
+    ssize_t n = fs_read(&file, img, sizeof(img));
+    fs_close(&file);
+
+    if (n < 0) {
+        return (int)n;
+    }
+
+    return hvac_cfg_bin_load(img, (size_t)n, out);
+}
+#endif
@@ -0,0 +1,51 @@
+#ifndef HVAC_CFG_BIN_H
+#define HVAC_CFG_BIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hvac_config.h"
+
+/*
+ * Binarny obraz konfiguracji (little-endian, wyrównanie 4 B).
+ * Tworzony na hoście przez scripts/hvac_cfg2bin.py z tego samego JSON-a,
+ * co loader tekstowy. Obraz jest walidowany i czytany w miejscu
+ * (flash mapowany w pamięci) - bez parsowania i bez kopii.
+ *
+ * Układ v1 (100 B):
+ *   0  magic "HCFG"     8  setpoint      24  io (9 x int32)
+ *   4  version (u16)   12  pid kp/ki/kd  60  seq cooling/heating/
+ *   6  length  (u16)                         heat_recovery/deadband (8 x int32)
+ *  92  sequence_type (u8, 0 = brak, n = hvac_cfg_seq_types[n-1]), 3 B rezerwy
+ *  96  crc32 (IEEE) bajtów [0 .. length-4)
+ */
+
+#define HVAC_CFG_BIN_MAGIC   0x47464348u    /* "HCFG" */
+#define HVAC_CFG_BIN_VERSION 1
+
+struct hvac_cfg_bin {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t length;                 /* całość razem z crc32 */
+
+    int32_t             setpoint;
+    struct hvac_pid_cfg pid;
+    struct hvac_io_cfg  io;
+    struct hvac_seq_cfg seq;
+
+    uint8_t  sequence_type;
+    uint8_t  reserved[3];
+
+    uint32_t crc32;
+};
+
+const struct hvac_cfg_bin *hvac_cfg_bin_validate(const void *img, size_t len);
+void hvac_cfg_bin_to_config(const struct hvac_cfg_bin *bin, struct hvac_config *out);
+/* -EINVAL przy złym obrazie, -ERANGE gdy config nie przechodzi hvac_cfg_validate() */
+int  hvac_cfg_bin_load(const void *img, size_t len, struct hvac_config *out);
+
+#if defined(CONFIG_FILE_SYSTEM)
+int  hvac_cfg_bin_load_file(const char *path, struct hvac_config *out);
+#endif
+
+#endif /* HVAC_CFG_BIN_H */
@@ -0,0 +1,512 @@
+#include <zephyr/kernel.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hvac_cfg_catalog.h"
+#include "hvac_cfg_json.h"
+#include "hvac_storage.h"
+
+#if defined(CONFIG_HVAC_CFG_BIN)
+#include "hvac_cfg_bin.h"
+#endif
+
+LOG_MODULE_REGISTER(hvac_cfg_catalog, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define HVAC_CATALOG_MAGIC    0x54414348u   /* "HCAT" */
+#define HVAC_CATALOG_VERSION  2       /* 2: F_BAD także za hvac_cfg_validate() */
+#define HVAC_CATALOG_MAX      CONFIG_HVAC_CFG_CATALOG_MAX_ENTRIES
+#define HVAC_CATALOG_PATH_LEN (sizeof(CONFIG_HVAC_CFG_CATALOG_DIR) + HVAC_CFG_CATALOG_NAME_LEN + 1)
+#define HVAC_CATALOG_TMP      CONFIG_HVAC_CFG_CATALOG_INDEX "~"
+
+/* plik indeksu: nagłówek + count wpisów */
+struct hvac_catalog_hdr {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t entry_size;
+    uint32_t count;
+    uint32_t crc32;             /* crc32 wpisów */
+};
+
+/*
+ * Dwa bufory: ekran czyta opublikowaną listę pod hvac_catalog_lock,
+ * skanowanie buduje nową w drugim buforze bez blokady (czytanie karty
+ * trwa sekundy) i podmienia wskaźnik pod blokadą.
+ */
+static struct hvac_cfg_catalog_entry hvac_catalog_buf[2][HVAC_CATALOG_MAX];
+static struct hvac_cfg_catalog_entry *hvac_catalog = hvac_catalog_buf[0];
+static int hvac_catalog_count;
+static uint32_t hvac_catalog_gen;       /* ++ przy czyszczeniu - skan w trakcie nie publikuje */
+static K_MUTEX_DEFINE(hvac_catalog_lock);
+
+/* tylko skanowanie */
+static struct hvac_cfg_catalog_entry *hvac_catalog_work;
+static int hvac_catalog_work_count;
+static K_MUTEX_DEFINE(hvac_catalog_scan_lock);
+
+/* odczyt wybranego pliku z wątku UI - wyjęcie karty czeka na jego koniec */
+static K_MUTEX_DEFINE(hvac_catalog_load_lock);
+
+/* --- Pomocnicze --- */
+
+static void hvac_catalog_path(char *buf, const char *name)
+{
+    snprintf(buf, HVAC_CATALOG_PATH_LEN, "%s/%s", CONFIG_HVAC_CFG_CATALOG_DIR, name);
+}
+
+static bool hvac_catalog_has_ext(const char *name, const char *ext)
+{
+    size_t n = strlen(name);
+    size_t e = strlen(ext);
+
+    if (n <= e) {
+        return false;
+    }
+
+    /* FAT nie rozróżnia wielkości liter */
+    for (size_t i = 0; i < e; i++) {
+        char c = name[n - e + i];
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+        if (c != ext[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool hvac_catalog_is_config(const char *name, bool *is_bin)
+{
+    *is_bin = false;
+
+    if (hvac_catalog_has_ext(name, ".json")) {
+        return true;
+    }
+#if defined(CONFIG_HVAC_CFG_BIN)
+    if (hvac_catalog_has_ext(name, ".bin")) {
+        *is_bin = true;
+        return true;
+    }
+#endif
+    return false;
+}
+
+static int hvac_catalog_find(const char *name, int from, int to)
+{
+    for (int i = from; i < to; i++) {
+        if (strcmp(hvac_catalog_work[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int hvac_catalog_cmp(const void *a, const void *b)
+{
+    const struct hvac_cfg_catalog_entry *ea = a;
+    const struct hvac_cfg_catalog_entry *eb = b;
+
+    return strcmp(ea->name, eb->name);
+}
+
+/* --- Indeksowanie jednego pliku --- */
+
+static void hvac_catalog_summarize(const struct hvac_config *cfg,
+                                   struct hvac_cfg_catalog_entry *e)
+{
+    const struct hvac_seq_band *bands[] = {
+        &cfg->seq.cooling, &cfg->seq.heating, &cfg->seq.heat_recovery, &cfg->seq.deadband,
+    };
+
+    e->setpoint = (int16_t)CLAMP(cfg->setpoint, INT16_MIN, INT16_MAX);
+
+    e->seq_type = 0;
+    for (int i = 0; i < HVAC_CFG_NUM_SEQ_TYPES; i++) {
+        if (cfg->sequence_type != NULL &&
+            strcmp(cfg->sequence_type, hvac_cfg_seq_types[i]) == 0) {
+            e->seq_type = i + 1;
+        }
+    }
+
+    e->bands = 0;
+    for (int i = 0; i < ARRAY_SIZE(bands); i++) {
+        if (bands[i]->from_percent != bands[i]->to_percent) {
+            e->bands |= BIT(i);
+        }
+    }
+}
+
+/*
+ * Jedno przejście po pliku: crc32 całej zawartości i parsowanie (JSON
+ * strumieniowo, obraz binarny z pierwszych sizeof(struct hvac_cfg_bin) B).
+ */
+static int hvac_catalog_index_file(const char *path, struct hvac_cfg_catalog_entry *e)
+{
+    struct hvac_config cfg;
+    struct fs_file_t file;
+    char chunk[CONFIG_HVAC_CFG_JSON_CHUNK_SIZE];
+    uint32_t crc = 0;
+    ssize_t n;
+    int ret;
+
+    memset(&cfg, 0, sizeof(cfg));
+    fs_file_t_init(&file);
+
+    ret = fs_open(&file, path, FS_O_READ);
+    if (ret < 0) {
+        LOG_ERR("Cannot open %s: %d", path, ret);
+        e->flags |= HVAC_CFG_CATALOG_F_BAD;
+        return ret;
+    }
+
+#if defined(CONFIG_HVAC_CFG_BIN)
+    if (e->flags & HVAC_CFG_CATALOG_F_BIN) {
+        struct hvac_cfg_bin img;
+
+        n = fs_read(&file, &img, sizeof(img));
+        if (n >= 0) {
+            crc = crc32_ieee_update(crc, (const uint8_t *)&img, n);
+            ret = hvac_cfg_bin_load(&img, (size_t)n, &cfg);
+        } else {
+            ret = (int)n;
+        }
+    } else
+#endif
+    {
+        struct hvac_cfg_json_parser p;
+
+        hvac_cfg_json_begin(&p, &cfg);
+        ret = 0;
+        while ((n = fs_read(&file, chunk, sizeof(chunk))) > 0) {
+            crc = crc32_ieee_update(crc, (const uint8_t *)chunk, n);
+            ret = hvac_cfg_json_feed(&p, chunk, n);
+            if (ret < 0) {
+                break;
+            }
+        }
+        if (n < 0) {
+            ret = (int)n;
+        } else if (ret >= 0) {
+            ret = hvac_cfg_json_end(&p);
+        }
+    }
+
+    /* reszta pliku tylko do sumy kontrolnej */
+    while (ret >= 0 && (n = fs_read(&file, chunk, sizeof(chunk))) > 0) {
+        crc = crc32_ieee_update(crc, (const uint8_t *)chunk, n);
+    }
+
+    fs_close(&file);
+
+    /* plik, który się parsuje, ale ma wartości poza zakresem, też jest zły */
+    if (ret >= 0 && !hvac_cfg_validate(&cfg)) {
+        ret = -ERANGE;
+    }
+    if (ret < 0) {
+        LOG_WRN("%s: invalid config (%d)", path, ret);
+        e->flags |= HVAC_CFG_CATALOG_F_BAD;
+        return ret;
+    }
+
+    e->hash = crc;
+    hvac_catalog_summarize(&cfg, e);
+    return 0;
+}
+
+/* --- Plik indeksu --- */
+
+static void hvac_catalog_read_index(void)
+{
+    struct hvac_catalog_hdr hdr;
+    struct fs_file_t file;
+    ssize_t n;
+
+    hvac_catalog_work_count = 0;
+    fs_file_t_init(&file);
+
+    if (fs_open(&file, CONFIG_HVAC_CFG_CATALOG_INDEX, FS_O_READ) < 0) {
+        return;
+    }
+
+    n = fs_read(&file, &hdr, sizeof(hdr));
+    if (n != sizeof(hdr) || hdr.magic != HVAC_CATALOG_MAGIC ||
+        hdr.version != HVAC_CATALOG_VERSION ||
+        hdr.entry_size != sizeof(struct hvac_cfg_catalog_entry) ||
+        hdr.count > HVAC_CATALOG_MAX) {
+        LOG_WRN("Catalog index ignored (format)");
+        goto out;
+    }
+
+    size_t len = hdr.count * sizeof(struct hvac_cfg_catalog_entry);
+
+    n = fs_read(&file, hvac_catalog_work, len);
+    if (n != (ssize_t)len || crc32_ieee((const uint8_t *)hvac_catalog_work, len) != hdr.crc32) {
+        LOG_WRN("Catalog index ignored (crc)");
+        goto out;
+    }
+
+    hvac_catalog_work_count = hdr.count;
+
+out:
+    fs_close(&file);
+}
+
+static int hvac_catalog_write_index(void)
+{
+    size_t len = hvac_catalog_work_count * sizeof(struct hvac_cfg_catalog_entry);
+    struct hvac_catalog_hdr hdr = {
+        .magic      = HVAC_CATALOG_MAGIC,
+        .version    = HVAC_CATALOG_VERSION,
+        .entry_size = sizeof(struct hvac_cfg_catalog_entry),
+        .count      = hvac_catalog_work_count,
+        .crc32      = crc32_ieee((const uint8_t *)hvac_catalog_work, len),
+    };
+    struct fs_file_t file;
+    int ret;
+
+    /* zapis do pliku tymczasowego i podmiana - urwany zapis zostawia stary indeks */
+    fs_file_t_init(&file);
+
+    ret = fs_open(&file, HVAC_CATALOG_TMP, FS_O_CREATE | FS_O_WRITE);
+    if (ret < 0) {
+        LOG_ERR("Cannot create %s: %d", HVAC_CATALOG_TMP, ret);
+        return ret;
+    }
+
+    ret = fs_truncate(&file, 0);
+    if (ret == 0 && fs_write(&file, &hdr, sizeof(hdr)) != sizeof(hdr)) {
+        ret = -EIO;
+    }
+    if (ret == 0 && fs_write(&file, hvac_catalog_work, len) != (ssize_t)len) {
+        ret = -EIO;
+    }
+    if (ret == 0) {
+        ret = fs_sync(&file);
+    }
+    fs_close(&file);
+
+    if (ret == 0) {
+        (void)fs_unlink(CONFIG_HVAC_CFG_CATALOG_INDEX);
+        ret = fs_rename(HVAC_CATALOG_TMP, CONFIG_HVAC_CFG_CATALOG_INDEX);
+    }
+    if (ret != 0) {
+        LOG_ERR("Catalog index write failed: %d", ret);
+    }
+
+    return ret;
+}
+
+/* nowa lista widoczna dla ekranu, o ile karty nie wyjęto w trakcie skanu */
+static void hvac_catalog_publish(uint32_t gen)
+{
+    k_mutex_lock(&hvac_catalog_lock, K_FOREVER);
+    if (gen == hvac_catalog_gen) {
+        hvac_catalog = hvac_catalog_work;
+        hvac_catalog_count = hvac_catalog_work_count;
+    }
+    k_mutex_unlock(&hvac_catalog_lock);
+}
+
+/* --- API --- */
+
+/*
+ * Wpisy z indeksu są dopasowywane do plików w katalogu w miejscu:
+ * [0, kept) - gotowe, [kept, old_end) - nieodwiedzone wpisy ze starego
+ * indeksu. Niezmieniony plik to tylko porównanie nazwy, rozmiaru i czasu.
+ */
+int hvac_cfg_catalog_scan(void)
+{
+    struct fs_dir_t dir;
+    struct fs_dirent ent;
+    char path[HVAC_CATALOG_PATH_LEN];
+    int kept = 0;
+    int old_end;
+    int indexed = 0;
+    uint32_t gen;
+    int ret;
+
+    if (!hvac_storage_is_ready()) {
+        return -ENODEV;
+    }
+
+    k_mutex_lock(&hvac_catalog_scan_lock, K_FOREVER);
+
+    k_mutex_lock(&hvac_catalog_lock, K_FOREVER);
+    gen = hvac_catalog_gen;
+    hvac_catalog_work = (hvac_catalog == hvac_catalog_buf[0]) ? hvac_catalog_buf[1]
+                                                              : hvac_catalog_buf[0];
+    k_mutex_unlock(&hvac_catalog_lock);
+
+    hvac_catalog_read_index();
+    old_end = hvac_catalog_work_count;
+
+    fs_dir_t_init(&dir);
+    ret = fs_opendir(&dir, CONFIG_HVAC_CFG_CATALOG_DIR);
+    if (ret < 0) {
+        LOG_WRN("No config directory %s: %d", CONFIG_HVAC_CFG_CATALOG_DIR, ret);
+        hvac_catalog_work_count = 0;
+        hvac_catalog_publish(gen);
+        k_mutex_unlock(&hvac_catalog_scan_lock);
+        return ret;
+    }
+
+    while (fs_readdir(&dir, &ent) == 0 && ent.name[0] != '\0') {
+        bool is_bin;
+        uint32_t mtime;
+
+        if (ent.type != FS_DIR_ENTRY_FILE || !hvac_catalog_is_config(ent.name, &is_bin)) {
+            continue;
+        }
+        if (strlen(ent.name) >= HVAC_CFG_CATALOG_NAME_LEN) {
+            LOG_WRN("%s: name too long, skipped", ent.name);
+            continue;
+        }
+        if (kept == HVAC_CATALOG_MAX) {
+            LOG_WRN("Config catalog full (%d entries)", HVAC_CATALOG_MAX);
+            break;
+        }
+
+        hvac_catalog_path(path, ent.name);
+        (void)hvac_storage_mtime(path, &mtime);
+
+        int j = hvac_catalog_find(ent.name, kept, old_end);
+        struct hvac_cfg_catalog_entry *e = &hvac_catalog_work[kept];
+
+        if (j >= 0) {
+            struct hvac_cfg_catalog_entry tmp = *e;
+            *e = hvac_catalog_work[j];
+            hvac_catalog_work[j] = tmp;
+
+            if (e->size == ent.size && e->mtime == mtime) {
+                kept++;
+                continue;
+            }
+        } else {
+            /* nieodwiedzony stary wpis odsuwamy na koniec, o ile jest miejsce */
+            if (kept < old_end && old_end < HVAC_CATALOG_MAX) {
+                hvac_catalog_work[old_end++] = *e;
+            }
+            memset(e, 0, sizeof(*e));
+            strcpy(e->name, ent.name);
+        }
+
+        e->size  = ent.size;
+        e->mtime = mtime;
+        e->flags = is_bin ? HVAC_CFG_CATALOG_F_BIN : 0;
+        (void)hvac_catalog_index_file(path, e);
+
+        indexed++;
+        kept++;
+        if (old_end < kept) {
+            old_end = kept;
+        }
+    }
+
+    fs_closedir(&dir);
+
+    bool dirty = (indexed > 0) || (old_end > kept) || (hvac_catalog_work_count != kept);
+
+    hvac_catalog_work_count = kept;
+
+    /* dopasowanie przestawia wpisy w kolejność katalogu - lista na ekranie wg nazwy */
+    qsort(hvac_catalog_work, kept, sizeof(hvac_catalog_work[0]), hvac_catalog_cmp);
+
+    if (dirty) {
+        (void)hvac_catalog_write_index();
+    }
+
+    hvac_catalog_publish(gen);
+
+    LOG_INF("Config catalog: %d entries (%d indexed)", kept, indexed);
+
+    k_mutex_unlock(&hvac_catalog_scan_lock);
+    return kept;
+}
+
+void hvac_cfg_catalog_clear(void)
+{
+    k_mutex_lock(&hvac_catalog_load_lock, K_FOREVER);
+    k_mutex_lock(&hvac_catalog_lock, K_FOREVER);
+    hvac_catalog_count = 0;
+    hvac_catalog_gen++;
+    k_mutex_unlock(&hvac_catalog_lock);
+    k_mutex_unlock(&hvac_catalog_load_lock);
+}
+
+int hvac_cfg_catalog_count(void)
+{
+    k_mutex_lock(&hvac_catalog_lock, K_FOREVER);
+    int n = hvac_catalog_count;
+    k_mutex_unlock(&hvac_catalog_lock);
+
+    return n;
+}
+
+int hvac_cfg_catalog_get(int idx, struct hvac_cfg_catalog_entry *out)
+{
+    int ret = -ENOENT;
+
+    k_mutex_lock(&hvac_catalog_lock, K_FOREVER);
+    if (idx >= 0 && idx < hvac_catalog_count) {
+        *out = hvac_catalog[idx];
+        ret = 0;
+    }
+    k_mutex_unlock(&hvac_catalog_lock);
+
+    return ret;
+}
+
+int hvac_cfg_catalog_load(int idx, struct hvac_config *out)
+{
+    struct hvac_cfg_catalog_entry e;
+    char path[HVAC_CATALOG_PATH_LEN];
+    int ret;
+
+    ret = hvac_cfg_catalog_get(idx, &e);
+    if (ret < 0) {
+        return ret;
+    }
+    if (e.flags & HVAC_CFG_CATALOG_F_BAD) {
+        return -EINVAL;
+    }
+
+    hvac_catalog_path(path, e.name);
+    memset(out, 0, sizeof(*out));
+
+    /*
+     * Wątek karty ustawia is_ready() na false, a przed fs_unmount() woła
+     * hvac_cfg_catalog_clear() - pod blokadą karta nie zniknie w trakcie
+     * odczytu, a po wyjęciu nowy odczyt nie zacznie się.
+     */
+    k_mutex_lock(&hvac_catalog_load_lock, K_FOREVER);
+
+    if (!hvac_storage_is_ready()) {
+        ret = -ENODEV;
+    }
+#if defined(CONFIG_HVAC_CFG_BIN)
+    else if (e.flags & HVAC_CFG_CATALOG_F_BIN) {
+        ret = hvac_cfg_bin_load_file(path, out);
+    }
+#endif
+    else {
+        ret = hvac_cfg_json_load_file(path, out);
+    }
+
+    k_mutex_unlock(&hvac_catalog_load_lock);
+
+    if (ret < 0) {
+        return ret;
+    }
+    /* plik mógł się zmienić od indeksowania */
+    if (!hvac_cfg_validate(out)) {
+        LOG_WRN("%s: config out of range", e.name);
+        return -ERANGE;
+    }
+    return 0;
+}
@@ -0,0 +1,46 @@
+#ifndef HVAC_CFG_CATALOG_H
+#define HVAC_CFG_CATALOG_H
+
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+
+#include "hvac_config.h"
+
+/*
+ * Katalog configów na karcie SD (CONFIG_HVAC_CFG_CATALOG_DIR, pliki .json
+ * i .bin z scripts/hvac_cfg2bin.py). Indeks z podsumowaniem każdego pliku
+ * jest trzymany w CONFIG_HVAC_CFG_CATALOG_INDEX - przy skanowaniu parsowane
+ * są tylko pliki nowe albo zmienione (inny rozmiar lub czas modyfikacji),
+ * a ekran loadera czyta wyłącznie indeks.
+ */
+
+#define HVAC_CFG_CATALOG_NAME_LEN 32
+
+#define HVAC_CFG_CATALOG_F_BIN    BIT(0)    /* obraz binarny, nie JSON */
+#define HVAC_CFG_CATALOG_F_BAD    BIT(1)    /* plik nie przeszedł walidacji */
+
+struct hvac_cfg_catalog_entry {
+    char     name[HVAC_CFG_CATALOG_NAME_LEN];
+    uint32_t size;
+    uint32_t mtime;             /* FAT: data << 16 | czas */
+    uint32_t hash;              /* crc32 zawartości */
+    int16_t  setpoint;
+    uint8_t  seq_type;          /* 0 = brak, n = hvac_cfg_seq_types[n-1] */
+    uint8_t  bands;             /* bit n = aktywne pasmo (cooling, heating, heat_recovery, deadband) */
+    uint8_t  flags;
+    uint8_t  reserved[3];
+};
+
+/* przegląd katalogu i aktualizacja indeksu; zwraca liczbę wpisów */
+int hvac_cfg_catalog_scan(void);
+
+/* karta wyjęta - ekran nie pokazuje plików, których już nie ma */
+void hvac_cfg_catalog_clear(void);
+
+int hvac_cfg_catalog_count(void);
+int hvac_cfg_catalog_get(int idx, struct hvac_cfg_catalog_entry *out);
+
+/* parsuje tylko wybrany plik; -ERANGE, gdy config nie przechodzi hvac_cfg_validate() */
+int hvac_cfg_catalog_load(int idx, struct hvac_config *out);
+
+#endif /* HVAC_CFG_CATALOG_H */
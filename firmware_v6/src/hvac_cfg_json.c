@@ -0,0 +1,613 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(CONFIG_FILE_SYSTEM)
+#include <zephyr/fs/fs.h>
+#endif
+
+#include "hvac_cfg_json.h"
+
+LOG_MODULE_REGISTER(hvac_cfg_json, CONFIG_LOG_DEFAULT_LEVEL);
+
+/* --- Mapa pól: ścieżka JSON -> pole struct hvac_config --- */
+
+enum {
+    HVAC_CFG_FIELD_INT,
+    HVAC_CFG_FIELD_SEQ_TYPE,
+};
+
+struct hvac_cfg_json_field {
+    const char *path;
+    uint16_t    offset;
+    uint8_t     type;
+};
+
+#define HVAC_CFG_JSON_INT(id, p, member, min, max) \
+    { p, offsetof(struct hvac_config, member), HVAC_CFG_FIELD_INT },
+
+/* pola liczbowe z HVAC_CFG_INT_FIELDS (hvac_config.h) */
+static const struct hvac_cfg_json_field hvac_cfg_json_fields[] = {
+    HVAC_CFG_INT_FIELDS(HVAC_CFG_JSON_INT)
+
+    { "sequence_type", offsetof(struct hvac_config, sequence_type), HVAC_CFG_FIELD_SEQ_TYPE },
+};
+
+/* sequence_type to wskaźnik - trzymamy tylko znane nazwy (obrazki sekwencji) */
+const char *const hvac_cfg_seq_types[HVAC_CFG_NUM_SEQ_TYPES] = {
+    "cool_dead_heat",
+    "cool_rec_dead_rec_heat",
+};
+
+/* --- Parser --- */
+
+enum {
+    ST_VALUE,          /* oczekiwana wartość */
+    ST_KEY,            /* oczekiwany klucz ('}' gdy allow_close) */
+    ST_COLON,
+    ST_STRING,
+    ST_NUMBER,
+    ST_LITERAL,
+    ST_AFTER_VALUE,    /* ',' albo zamknięcie */
+    ST_DONE,
+};
+
+static bool hvac_cfg_json_is_ws(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static bool hvac_cfg_json_in_array(const struct hvac_cfg_json_parser *p)
+{
+    return p->depth > 0 && (p->arr_bits & BIT(p->depth - 1));
+}
+
+static void hvac_cfg_json_tok_add(struct hvac_cfg_json_parser *p, char c)
+{
+    if (p->tok_len < sizeof(p->tok) - 1) {
+        p->tok[p->tok_len++] = c;
+    } else {
+        p->tok_overflow = true;
+    }
+}
+
+static const struct hvac_cfg_json_field *hvac_cfg_json_lookup(const struct hvac_cfg_json_parser *p)
+{
+    if (p->depth == 0 || hvac_cfg_json_in_array(p) || p->bad_depth <= p->depth ||
+        p->key_len == 0) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(hvac_cfg_json_fields); i++) {
+        const char *f = hvac_cfg_json_fields[i].path;
+
+        if (p->path_len > 0) {
+            if (strncmp(f, p->path, p->path_len) != 0 || f[p->path_len] != '.') {
+                continue;
+            }
+            f += p->path_len + 1;
+        }
+
+        if (strlen(f) == p->key_len && memcmp(f, p->key, p->key_len) == 0) {
+            return &hvac_cfg_json_fields[i];
+        }
+    }
+
+    return NULL;
+}
+
+static int hvac_cfg_json_parse_int(const char *s, size_t len, int32_t *out)
+{
+    int64_t v = 0;
+    bool neg = false;
+    size_t i = 0;
+
+    if (i < len && s[i] == '-') {
+        neg = true;
+        i++;
+    }
+    if (i == len) {
+        return -EINVAL;
+    }
+
+    for (; i < len; i++) {
+        if (s[i] < '0' || s[i] > '9') {
+            return -EINVAL;
+        }
+        v = v * 10 + (s[i] - '0');
+        if (v > (int64_t)INT32_MAX + 1) {
+            return -ERANGE;
+        }
+    }
+
+    v = neg ? -v : v;
+    if (v > INT32_MAX) {
+        return -ERANGE;
+    }
+
+    *out = (int32_t)v;
+    return 0;
+}
+
+/* koniec wartości prostej (string/number/literal) */
+static int hvac_cfg_json_value(struct hvac_cfg_json_parser *p, uint8_t tok_state)
+{
+    const struct hvac_cfg_json_field *f = hvac_cfg_json_lookup(p);
+    if (f == NULL) {
+        return 0;
+    }
+
+    uint8_t *dst = (uint8_t *)p->out + f->offset;
+
+    switch (f->type) {
+    case HVAC_CFG_FIELD_INT: {
+        int32_t v;
+
+        if (tok_state != ST_NUMBER || p->tok_overflow) {
+            LOG_ERR("%s: integer expected", f->path);
+            return -EINVAL;
+        }
+
+        int ret = hvac_cfg_json_parse_int(p->tok, p->tok_len, &v);
+        if (ret < 0) {
+            LOG_ERR("%s: bad integer", f->path);
+            return ret;
+        }
+
+        memcpy(dst, &v, sizeof(v));
+        break;
+    }
+
+    case HVAC_CFG_FIELD_SEQ_TYPE: {
+        const char *name = NULL;
+
+        if (tok_state != ST_STRING) {
+            LOG_ERR("%s: string expected", f->path);
+            return -EINVAL;
+        }
+
+        for (size_t i = 0; i < ARRAY_SIZE(hvac_cfg_seq_types) && !p->tok_overflow; i++) {
+            if (strlen(hvac_cfg_seq_types[i]) == p->tok_len &&
+                memcmp(hvac_cfg_seq_types[i], p->tok, p->tok_len) == 0) {
+                name = hvac_cfg_seq_types[i];
+            }
+        }
+
+        if (name == NULL) {
+            LOG_WRN("Unknown sequence_type ignored");
+            return 0;
+        }
+
+        memcpy(dst, &name, sizeof(name));
+        break;
+    }
+
+    default:
+        return 0;
+    }
+
+    p->fields++;
+    return 0;
+}
+
+static int hvac_cfg_json_open(struct hvac_cfg_json_parser *p, bool array)
+{
+    if (p->depth >= HVAC_CFG_JSON_MAX_DEPTH) {
+        return -E2BIG;
+    }
+
+    p->path_len_stack[p->depth] = p->path_len;
+
+    /* korzeń nie dodaje segmentu, elementy tablic dostają "#" */
+    if (p->depth > 0) {
+        const char *seg = hvac_cfg_json_in_array(p) ? "#" : p->key;
+        size_t seg_len  = hvac_cfg_json_in_array(p) ? 1 : p->key_len;
+        size_t need     = seg_len + (p->path_len ? 1 : 0);
+
+        if (p->bad_depth > p->depth && seg_len > 0 &&
+            p->path_len + need < sizeof(p->path)) {
+            if (p->path_len) {
+                p->path[p->path_len++] = '.';
+            }
+            memcpy(&p->path[p->path_len], seg, seg_len);
+            p->path_len += seg_len;
+        } else if (p->bad_depth > p->depth) {
+            p->bad_depth = p->depth + 1;
+        }
+    }
+
+    WRITE_BIT(p->arr_bits, p->depth, array);
+    p->depth++;
+    p->allow_close = true;
+    p->state = array ? ST_VALUE : ST_KEY;
+
+    return 0;
+}
+
+static int hvac_cfg_json_close(struct hvac_cfg_json_parser *p, bool array)
+{
+    if (p->depth == 0 || hvac_cfg_json_in_array(p) != array) {
+        return -EINVAL;
+    }
+
+    p->depth--;
+    p->path_len = p->path_len_stack[p->depth];
+    if (p->bad_depth > p->depth) {
+        p->bad_depth = UINT8_MAX;
+    }
+
+    p->state = (p->depth == 0) ? ST_DONE : ST_AFTER_VALUE;
+    return 0;
+}
+
+static int hvac_cfg_json_char(struct hvac_cfg_json_parser *p, char c)
+{
+    int ret;
+
+    switch (p->state) {
+    case ST_STRING:
+        if (p->escape) {
+            p->escape = false;
+            hvac_cfg_json_tok_add(p, c);
+        } else if (c == '\\') {
+            p->escape = true;
+        } else if (c == '"') {
+            if (p->is_key) {
+                if (p->tok_overflow) {
+                    p->key_len = 0;    /* za długi klucz - nie pasuje do żadnego pola */
+                } else {
+                    memcpy(p->key, p->tok, p->tok_len);
+                    p->key_len = p->tok_len;
+                }
+                p->state = ST_COLON;
+            } else {
+                ret = hvac_cfg_json_value(p, ST_STRING);
+                if (ret < 0) {
+                    return ret;
+                }
+                p->state = ST_AFTER_VALUE;
+            }
+        } else if ((uint8_t)c < 0x20) {
+            return -EINVAL;
+        } else {
+            hvac_cfg_json_tok_add(p, c);
+        }
+        return 0;
+
+    case ST_NUMBER:
+        if ((c >= '0' && c <= '9') || c == '-' || c == '+' ||
+            c == '.' || c == 'e' || c == 'E') {
+            hvac_cfg_json_tok_add(p, c);
+            return 0;
+        }
+        ret = hvac_cfg_json_value(p, ST_NUMBER);
+        if (ret < 0) {
+            return ret;
+        }
+        p->state = ST_AFTER_VALUE;
+        break;    /* znak kończący liczbę obsługujemy niżej */
+
+    case ST_LITERAL:
+        if (c >= 'a' && c <= 'z') {
+            hvac_cfg_json_tok_add(p, c);
+            return 0;
+        }
+        if (p->tok_overflow ||
+            !((p->tok_len == 4 && memcmp(p->tok, "true", 4) == 0) ||
+              (p->tok_len == 5 && memcmp(p->tok, "false", 5) == 0) ||
+              (p->tok_len == 4 && memcmp(p->tok, "null", 4) == 0))) {
+            return -EINVAL;
+        }
+        ret = hvac_cfg_json_value(p, ST_LITERAL);
+        if (ret < 0) {
+            return ret;
+        }
+        p->state = ST_AFTER_VALUE;
+        break;
+
+    default:
+        break;
+    }
+
+    if (hvac_cfg_json_is_ws(c)) {
+        return 0;
+    }
+
+    switch (p->state) {
+    case ST_VALUE:
+        if (p->depth == 0 && c != '{') {
+            return -EINVAL;    /* korzeń musi być obiektem */
+        }
+        if (c == ']' && p->allow_close) {
+            return hvac_cfg_json_close(p, true);
+        }
+        p->allow_close  = false;
+        p->tok_len      = 0;
+        p->tok_overflow = false;
+
+        if (c == '{' || c == '[') {
+            return hvac_cfg_json_open(p, c == '[');
+        } else if (c == '"') {
+            p->is_key = false;
+            p->state  = ST_STRING;
+        } else if (c == '-' || (c >= '0' && c <= '9')) {
+            hvac_cfg_json_tok_add(p, c);
+            p->state = ST_NUMBER;
+        } else if (c == 't' || c == 'f' || c == 'n') {
+            hvac_cfg_json_tok_add(p, c);
+            p->state = ST_LITERAL;
+        } else {
+            return -EINVAL;
+        }
+        return 0;
+
+    case ST_KEY:
+        if (c == '}' && p->allow_close) {
+            return hvac_cfg_json_close(p, false);
+        }
+        if (c != '"') {
+            return -EINVAL;
+        }
+        p->allow_close  = false;
+        p->is_key       = true;
+        p->tok_len      = 0;
+        p->tok_overflow = false;
+        p->state        = ST_STRING;
+        return 0;
+
+    case ST_COLON:
+        if (c != ':') {
+            return -EINVAL;
+        }
+        p->state = ST_VALUE;
+        return 0;
+
+    case ST_AFTER_VALUE:
+        if (c == ',') {
+            p->state = hvac_cfg_json_in_array(p) ? ST_VALUE : ST_KEY;
+            return 0;
+        }
+        if (c == '}' || c == ']') {
+            return hvac_cfg_json_close(p, c == ']');
+        }
+        return -EINVAL;
+
+    case ST_DONE:
+    default:
+        return -EINVAL;    /* śmieci za końcem dokumentu */
+    }
+}
+
+void hvac_cfg_json_begin(struct hvac_cfg_json_parser *p, struct hvac_config *out)
+{
+    memset(p, 0, sizeof(*p));
+    p->out       = out;
+    p->state     = ST_VALUE;
+    p->bad_depth = UINT8_MAX;
+
+    memset(out, 0, sizeof(*out));
+}
+
+int hvac_cfg_json_feed(struct hvac_cfg_json_parser *p, const char *data, size_t len)
+{
+    if (p->err) {
+        return p->err;
+    }
+
+    for (size_t i = 0; i < len; i++, p->offset++) {
+        int ret = hvac_cfg_json_char(p, data[i]);
+        if (ret < 0) {
+            LOG_ERR("JSON parse error %d at byte %u", ret, p->offset);
+            p->err = ret;
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+int hvac_cfg_json_end(struct hvac_cfg_json_parser *p)
+{
+    if (p->err) {
+        return p->err;
+    }
+
+    if (p->state != ST_DONE) {
+        LOG_ERR("JSON truncated at byte %u", p->offset);
+        return -EINVAL;
+    }
+
+    return (int)p->fields;
+}
+
+/* --- Źródła bajtów --- */
+
+int hvac_cfg_json_load(hvac_cfg_read_fn read, void *ctx, struct hvac_config *out)
+{
+    struct hvac_cfg_json_parser p;
+    char chunk[CONFIG_HVAC_CFG_JSON_CHUNK_SIZE];
+
+    hvac_cfg_json_begin(&p, out);
+
+    while (1) {
+        int n = read(ctx, chunk, sizeof(chunk));
+        if (n < 0) {
+            return n;
+        }
+        if (n == 0) {
+            break;
+        }
+
+        int ret = hvac_cfg_json_feed(&p, chunk, n);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    return hvac_cfg_json_end(&p);
+}
+
+int hvac_cfg_json_load_mem(const char *src, size_t len, struct hvac_config *out)
+{
+    struct hvac_cfg_json_parser p;
+
+    /* sizeof() tablicy znakowej liczy końcowe '\0' */
+    if (len > 0 && src[len - 1] == '\0') {
+        len--;
+    }
+
+    hvac_cfg_json_begin(&p, out);
+
+    int ret = hvac_cfg_json_feed(&p, src, len);
+    if (ret < 0) {
+        return ret;
+    }
+
+    return hvac_cfg_json_end(&p);
+}
+
+/* --- Zapis --- */
+
+struct hvac_cfg_json_out {
+    char  *buf;
+    size_t len;
+    size_t pos;
+};
+
+static void hvac_cfg_json_put(struct hvac_cfg_json_out *o, const char *s, size_t n)
+{
+    if (o->pos + n < o->len) {
+        memcpy(&o->buf[o->pos], s, n);
+    }
+    o->pos += n;
+}
+
+static void hvac_cfg_json_puts(struct hvac_cfg_json_out *o, const char *s)
+{
+    hvac_cfg_json_put(o, s, strlen(s));
+}
+
+/* długość wspólnych członów (do kropki) ścieżek a i b, bez liścia */
+static size_t hvac_cfg_json_common(const char *a, const char *b)
+{
+    size_t common = 0;
+
+    for (size_t i = 0; a[i] == b[i] && a[i] != '\0'; i++) {
+        if (a[i] == '.') {
+            common = i + 1;
+        }
+    }
+    return common;
+}
+
+/*
+ * Pola z tablicy są pogrupowane po obiektach, więc wystarczy porównać
+ * ścieżkę z poprzednią: zamknąć obiekty, które się skończyły, i otworzyć
+ * nowe.
+ */
+int hvac_cfg_json_write(const struct hvac_config *cfg, char *buf, size_t len)
+{
+    struct hvac_cfg_json_out o = { .buf = buf, .len = len };
+    const char *prev = "";
+    bool first = true;
+
+    hvac_cfg_json_puts(&o, "{");
+
+    for (size_t i = 0; i < ARRAY_SIZE(hvac_cfg_json_fields); i++) {
+        const struct hvac_cfg_json_field *f = &hvac_cfg_json_fields[i];
+        const char *path = f->path;
+        size_t common = hvac_cfg_json_common(prev, path);
+        char tmp[24];
+
+        /* zamknięcie obiektów z poprzedniej ścieżki */
+        for (const char *c = &prev[common]; *c != '\0'; c++) {
+            if (*c == '.') {
+                hvac_cfg_json_puts(&o, "}");
+            }
+        }
+
+        /* otwarcie nowych, potem liść */
+        const char *seg = &path[common];
+        const char *dot;
+
+        while (1) {
+            dot = strchr(seg, '.');
+            if (!first) {
+                hvac_cfg_json_puts(&o, ",");
+            }
+            hvac_cfg_json_puts(&o, "\"");
+            hvac_cfg_json_put(&o, seg, (dot != NULL) ? (size_t)(dot - seg) : strlen(seg));
+            hvac_cfg_json_puts(&o, "\":");
+            if (dot == NULL) {
+                break;
+            }
+            hvac_cfg_json_puts(&o, "{");
+            first = true;
+            seg = dot + 1;
+        }
+
+        const void *field = (const uint8_t *)cfg + f->offset;
+
+        if (f->type == HVAC_CFG_FIELD_INT) {
+            int32_t v;
+
+            memcpy(&v, field, sizeof(v));
+            snprintf(tmp, sizeof(tmp), "%d", v);
+            hvac_cfg_json_puts(&o, tmp);
+        } else {
+            const char *name = *(const char *const *)field;
+
+            /* tylko nazwy z hvac_cfg_seq_types - bez znaków do escapowania */
+            hvac_cfg_json_puts(&o, (name != NULL) ? "\"" : "null");
+            if (name != NULL) {
+                hvac_cfg_json_puts(&o, name);
+                hvac_cfg_json_puts(&o, "\"");
+            }
+        }
+
+        first = false;
+        prev = path;
+    }
+
+    for (const char *c = prev; *c != '\0'; c++) {
+        if (*c == '.') {
+            hvac_cfg_json_puts(&o, "}");
+        }
+    }
+    hvac_cfg_json_puts(&o, "}");
+
+    if (o.pos >= len) {
+        return -ENOMEM;
+    }
+    buf[o.pos] = '\0';
+    return (int)o.pos;
+}
+
+#if defined(CONFIG_FILE_SYSTEM)
+static int hvac_cfg_json_file_read(void *ctx, char *buf, size_t len)
+{
+    return (int)fs_read(ctx, buf, len);
+}
+
+int hvac_cfg_json_load_file(const char *path, struct hvac_config *out)
+{
+    struct fs_file_t file;
+
+    fs_file_t_init(&file);
+
+    int ret = fs_open(&file, path, FS_O_READ);
+    if (ret < 0) {
+        LOG_ERR("Cannot open %s: %d", path, ret);
+        return ret;
+    }
+
+    ret = hvac_cfg_json_load(hvac_cfg_json_file_read, &file, out);
+    fs_close(&file);
+
+    return ret;
+}
+#endif
@@ -0,0 +1,67 @@
+#ifndef HVAC_CFG_JSON_H
+#define HVAC_CFG_JSON_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "hvac_config.h"
+
+/*
+ * Strumieniowy parser konfiguracji JSON.
+ * Dane podawane są w dowolnych kawałkach (hvac_cfg_json_feed), pamięć
+ * parsera jest stała - rozmiar configu ogranicza tylko nośnik.
+ * Nieznane klucze (również całe poddrzewa i tablice) są pomijane.
+ */
+
+#define HVAC_CFG_JSON_MAX_DEPTH 32
+#define HVAC_CFG_JSON_PATH_LEN  48
+#define HVAC_CFG_JSON_TOK_LEN   32
+
+struct hvac_cfg_json_parser {
+    struct hvac_config *out;
+
+    uint8_t  state;
+    uint8_t  depth;
+    uint8_t  bad_depth;       /* od tej głębokości ścieżka się nie zmieściła */
+    bool     is_key;
+    bool     escape;
+    bool     tok_overflow;
+    bool     allow_close;     /* pusty obiekt/tablica */
+
+    uint32_t arr_bits;        /* bit n = poziom n jest tablicą */
+    uint8_t  path_len_stack[HVAC_CFG_JSON_MAX_DEPTH];
+
+    char     path[HVAC_CFG_JSON_PATH_LEN];
+    uint8_t  path_len;
+    char     key[HVAC_CFG_JSON_TOK_LEN];
+    uint8_t  key_len;
+    char     tok[HVAC_CFG_JSON_TOK_LEN];
+    uint8_t  tok_len;
+
+    uint32_t offset;          /* pozycja w strumieniu, do komunikatów błędów */
+    uint32_t fields;          /* liczba rozpoznanych pól */
+    int      err;
+};
+
+void hvac_cfg_json_begin(struct hvac_cfg_json_parser *p, struct hvac_config *out);
+int  hvac_cfg_json_feed(struct hvac_cfg_json_parser *p, const char *data, size_t len);
+int  hvac_cfg_json_end(struct hvac_cfg_json_parser *p);
+
+/* źródło bajtów: > 0 liczba bajtów, 0 = koniec, < 0 = błąd */
+typedef int (*hvac_cfg_read_fn)(void *ctx, char *buf, size_t len);
+
+int hvac_cfg_json_load(hvac_cfg_read_fn read, void *ctx, struct hvac_config *out);
+int hvac_cfg_json_load_mem(const char *src, size_t len, struct hvac_config *out);
+
+/*
+ * Config jako JSON w formacie plików z configs/ (bez wcięć), zakończony
+ * zerem. Długość bez zera albo -ENOMEM, gdy bufor za mały.
+ */
+int hvac_cfg_json_write(const struct hvac_config *cfg, char *buf, size_t len);
+
+#if defined(CONFIG_FILE_SYSTEM)
+int hvac_cfg_json_load_file(const char *path, struct hvac_config *out);
+#endif
+
+#endif /* HVAC_CFG_JSON_H */
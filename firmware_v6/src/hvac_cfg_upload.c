@@ -0,0 +1,102 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <errno.h>
+
+#include "hvac_cfg_json.h"
+#include "hvac_cfg_upload.h"
+
+LOG_MODULE_REGISTER(hvac_cfg_upload, CONFIG_LOG_DEFAULT_LEVEL);
+
+/* wołają wątki HTTP, powłoki i Modbus - parser jest jeden */
+static K_MUTEX_DEFINE(hvac_upload_lock);
+
+static struct {
+    const void                 *owner;
+    int64_t                     last_ms;
+    uint32_t                    bytes;
+    struct hvac_cfg_json_parser parser;
+    struct hvac_config          cfg;
+} hvac_upload;
+
+/* pod hvac_upload_lock */
+static bool hvac_upload_owned(const void *owner)
+{
+    return hvac_upload.owner != NULL && hvac_upload.owner == owner;
+}
+
+int hvac_cfg_upload_begin(const void *owner, const struct hvac_config *base)
+{
+    int64_t now = k_uptime_get();
+    int ret = 0;
+
+    k_mutex_lock(&hvac_upload_lock, K_FOREVER);
+
+    if (hvac_upload.owner != NULL && hvac_upload.owner != owner &&
+        now - hvac_upload.last_ms < CONFIG_HVAC_CFG_UPLOAD_TIMEOUT_S * MSEC_PER_SEC) {
+        ret = -EBUSY;
+    } else {
+        if (hvac_upload.owner != NULL && hvac_upload.owner != owner) {
+            LOG_WRN("Stale config upload dropped after %u B", hvac_upload.bytes);
+        }
+        hvac_upload.owner   = owner;
+        hvac_upload.last_ms = now;
+        hvac_upload.bytes   = 0;
+        hvac_cfg_json_begin(&hvac_upload.parser, &hvac_upload.cfg);
+        /* begin zeruje config - parser nadpisuje tylko pola z dokumentu */
+        hvac_upload.cfg = *base;
+    }
+
+    k_mutex_unlock(&hvac_upload_lock);
+    return ret;
+}
+
+int hvac_cfg_upload_feed(const void *owner, const char *data, size_t len)
+{
+    int ret = -EPERM;
+
+    k_mutex_lock(&hvac_upload_lock, K_FOREVER);
+
+    if (hvac_upload_owned(owner)) {
+        hvac_upload.last_ms = k_uptime_get();
+        hvac_upload.bytes  += len;
+        ret = hvac_cfg_json_feed(&hvac_upload.parser, data, len);
+    }
+
+    k_mutex_unlock(&hvac_upload_lock);
+    return ret;
+}
+
+int hvac_cfg_upload_commit(const void *owner, struct hvac_config *out)
+{
+    int ret = -EPERM;
+
+    k_mutex_lock(&hvac_upload_lock, K_FOREVER);
+
+    if (hvac_upload_owned(owner)) {
+        ret = hvac_cfg_json_end(&hvac_upload.parser);
+        if (ret >= 0 && !hvac_cfg_validate(&hvac_upload.cfg)) {
+            ret = -ERANGE;
+        }
+        if (ret >= 0) {
+            *out = hvac_upload.cfg;
+            LOG_INF("Config uploaded: %u B, %d fields", hvac_upload.bytes, ret);
+        } else {
+            LOG_WRN("Config upload rejected: %d", ret);
+        }
+        hvac_upload.owner = NULL;
+    }
+
+    k_mutex_unlock(&hvac_upload_lock);
+    return ret;
+}
+
+void hvac_cfg_upload_abort(const void *owner)
+{
+    k_mutex_lock(&hvac_upload_lock, K_FOREVER);
+
+    if (hvac_upload_owned(owner)) {
+        hvac_upload.owner = NULL;
+    }
+
+    k_mutex_unlock(&hvac_upload_lock);
+}
@@ -0,0 +1,35 @@
+#ifndef HVAC_CFG_UPLOAD_H
+#define HVAC_CFG_UPLOAD_H
+
+#include <stddef.h>
+
+#include "hvac_config.h"
+
+/*
+ * Wgrywanie configu kawałkami (HTTP, powłoka, Modbus FC 21). Dokument
+ * idzie prosto do parsera strumieniowego - pamięć jest stała, niezależna
+ * od rozmiaru dokumentu. Parser pisze na kopię bieżącej konfiguracji -
+ * pola nieobecne w dokumencie zostają bez zmian, {"setpoint":22} zmienia
+ * tylko nastawę. Po końcu hvac_cfg_validate(); dopiero poprawny config
+ * w całości wraca do wołającego, który przekazuje go do UI.
+ *
+ * Jedna sesja naraz. owner to dowolny wskaźnik identyfikujący kanał
+ * (klient HTTP, powłoka); sesję bez ruchu dłużej niż
+ * CONFIG_HVAC_CFG_UPLOAD_TIMEOUT_S przejmuje kolejny begin.
+ */
+
+/* -EBUSY, gdy trwa cudza sesja; własną zaczyna od nowa. base - bieżący config */
+int  hvac_cfg_upload_begin(const void *owner, const struct hvac_config *base);
+
+/* -EPERM bez sesji, błąd parsera (sesja trwa do commit/abort) */
+int  hvac_cfg_upload_feed(const void *owner, const char *data, size_t len);
+
+/*
+ * Kończy sesję. Liczba pól albo -EINVAL (JSON), -ERANGE (walidacja),
+ * -EPERM (brak sesji); out jest zapisany tylko przy sukcesie.
+ */
+int  hvac_cfg_upload_commit(const void *owner, struct hvac_config *out);
+
+void hvac_cfg_upload_abort(const void *owner);
+
+#endif /* HVAC_CFG_UPLOAD_H */
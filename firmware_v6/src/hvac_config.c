@@ -0,0 +1,117 @@
+#include <zephyr/sys/util.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "hvac_config.h"
+#include "hvac_io.h"
+
+static bool hvac_band_eq(const struct hvac_seq_band *a, const struct hvac_seq_band *b)
+{
+    return a->from_percent == b->from_percent && a->to_percent == b->to_percent;
+}
+
+static bool hvac_seq_type_eq(const char *a, const char *b)
+{
+    if (a == b) {
+        return true;
+    }
+    if (a == NULL || b == NULL) {
+        return false;
+    }
+    return strcmp(a, b) == 0;
+}
+
+uint32_t hvac_cfg_diff(const struct hvac_config *a, const struct hvac_config *b)
+{
+    const struct hvac_io_cfg *ia = &a->io;
+    const struct hvac_io_cfg *ib = &b->io;
+    uint32_t changed = 0;
+
+    if (a->setpoint != b->setpoint) {
+        changed |= HVAC_CFG_CH_SETPOINT;
+    }
+
+    if (a->pid.kp != b->pid.kp || a->pid.ki != b->pid.ki || a->pid.kd != b->pid.kd) {
+        changed |= HVAC_CFG_CH_PID;
+    }
+
+    if (ia->t_extract_ai != ib->t_extract_ai) {
+        changed |= HVAC_CFG_CH_LOOP_INPUT | HVAC_CFG_CH_IO_AI;
+    }
+
+    if (ia->t_supply_ai  != ib->t_supply_ai  ||
+        ia->t_exhaust_ai != ib->t_exhaust_ai ||
+        ia->t_outdoor_ai != ib->t_outdoor_ai ||
+        ia->frost_ai     != ib->frost_ai) {
+        changed |= HVAC_CFG_CH_IO_AI;
+    }
+
+    if (ia->bypass_ao  != ib->bypass_ao  ||
+        ia->fan_vfd_ao != ib->fan_vfd_ao ||
+        ia->heater_ao  != ib->heater_ao  ||
+        ia->cooler_ao  != ib->cooler_ao) {
+        changed |= HVAC_CFG_CH_IO_AO;
+    }
+
+    if (!hvac_band_eq(&a->seq.cooling, &b->seq.cooling)) {
+        changed |= HVAC_CFG_CH_SEQ_COOLING;
+    }
+    if (!hvac_band_eq(&a->seq.heating, &b->seq.heating)) {
+        changed |= HVAC_CFG_CH_SEQ_HEATING;
+    }
+    if (!hvac_band_eq(&a->seq.heat_recovery, &b->seq.heat_recovery)) {
+        changed |= HVAC_CFG_CH_SEQ_HEAT_REC;
+    }
+    if (!hvac_band_eq(&a->seq.deadband, &b->seq.deadband)) {
+        changed |= HVAC_CFG_CH_SEQ_DEADBAND;
+    }
+
+    if (!hvac_seq_type_eq(a->sequence_type, b->sequence_type)) {
+        changed |= HVAC_CFG_CH_SEQ_TYPE;
+    }
+
+    return changed;
+}
+
+/* --- Pola liczbowe --- */
+
+struct hvac_cfg_field_desc {
+    uint16_t offset;
+    int32_t  min;
+    int32_t  max;
+};
+
+#define HVAC_CFG_F_DESC(id, path, member, lo, hi) \
+    [HVAC_CFG_F_##id] = { offsetof(struct hvac_config, member), lo, hi },
+
+static const struct hvac_cfg_field_desc hvac_cfg_fields[HVAC_CFG_NUM_INT_FIELDS] = {
+    HVAC_CFG_INT_FIELDS(HVAC_CFG_F_DESC)
+};
+
+BUILD_ASSERT(CONFIG_HVAC_SETPOINT_MIN <= CONFIG_HVAC_SETPOINT_DEFAULT &&
+             CONFIG_HVAC_SETPOINT_DEFAULT <= CONFIG_HVAC_SETPOINT_MAX,
+             "default setpoint outside its range");
+
+int32_t *hvac_cfg_field(struct hvac_config *cfg, enum hvac_cfg_field_id id)
+{
+    return (int32_t *)((uint8_t *)cfg + hvac_cfg_fields[id].offset);
+}
+
+static bool hvac_band_ok(const struct hvac_seq_band *b)
+{
+    return b->from_percent <= b->to_percent;
+}
+
+bool hvac_cfg_validate(const struct hvac_config *cfg)
+{
+    for (int i = 0; i < HVAC_CFG_NUM_INT_FIELDS; i++) {
+        const int32_t *v = (const int32_t *)((const uint8_t *)cfg + hvac_cfg_fields[i].offset);
+
+        if (*v < hvac_cfg_fields[i].min || *v > hvac_cfg_fields[i].max) {
+            return false;
+        }
+    }
+
+    return hvac_band_ok(&cfg->seq.cooling) && hvac_band_ok(&cfg->seq.heating) &&
+           hvac_band_ok(&cfg->seq.heat_recovery) && hvac_band_ok(&cfg->seq.deadband);
+}
@@ -0,0 +1,122 @@
+#ifndef HVAC_CONFIG_H
+#define HVAC_CONFIG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* --- Struktury konfiguracji --- */
+
+struct hvac_pid_cfg {
+    int32_t kp;
+    int32_t ki;
+    int32_t kd;
+};
+
+struct hvac_io_cfg {
+    int32_t t_supply_ai;        // temp. nawiewu
+    int32_t t_extract_ai;       // temp. wyciągu
+    int32_t t_exhaust_ai;       // temp. wyrzutni
+    int32_t t_outdoor_ai;       // temp. zewnętrzna / czerpnia
+    int32_t frost_ai;           // czujnik przeciwzamrożeniowy
+
+    int32_t bypass_ao;          // sterowanie bypassem wymiennika
+    int32_t fan_vfd_ao;         // falownik wentylatora
+    int32_t heater_ao;          // grzałka / nagrzewnica
+    int32_t cooler_ao;          // chłodnica
+};
+
+struct hvac_seq_band {
+    int32_t from_percent;
+    int32_t to_percent;
+};
+
+struct hvac_seq_cfg {
+    struct hvac_seq_band cooling;
+    struct hvac_seq_band heating;
+    struct hvac_seq_band heat_recovery;
+    struct hvac_seq_band deadband;
+};
+
+struct hvac_config {
+    int32_t setpoint;
+    struct hvac_pid_cfg pid;
+    struct hvac_io_cfg  io;
+    struct hvac_seq_cfg seq;
+    const char *sequence_type;   /* np. "cool_dead_heat" albo "cool_rec_dead_rec_heat" */
+};
+
+/*
+ * Pola liczbowe struct hvac_config - jedyna lista, z której powstają
+ * mapa pól JSON (hvac_cfg_json.c), rejestry holding Modbus
+ * (hvac_modbus.c) i zakresy hvac_cfg_validate(). Pozycja na liście
+ * to numer rejestru, więc nowe pola dopisujemy tylko na końcu.
+ *
+ * X(ID, "ścieżka JSON", pole, min, max) - min/max rozwijane tylko
+ * w hvac_config.c, gdzie HVAC_NUM_* są znane.
+ */
+#define HVAC_CFG_INT_FIELDS(X)                                                            \
+    X(SETPOINT,      "setpoint",                       setpoint,                   CONFIG_HVAC_SETPOINT_MIN, CONFIG_HVAC_SETPOINT_MAX) \
+    X(SEQ_COOL_FROM, "seq.cooling.from_percent",       seq.cooling.from_percent,       -100, 100) \
+    X(SEQ_COOL_TO,   "seq.cooling.to_percent",         seq.cooling.to_percent,         -100, 100) \
+    X(SEQ_HEAT_FROM, "seq.heating.from_percent",       seq.heating.from_percent,       -100, 100) \
+    X(SEQ_HEAT_TO,   "seq.heating.to_percent",         seq.heating.to_percent,         -100, 100) \
+    X(SEQ_REC_FROM,  "seq.heat_recovery.from_percent", seq.heat_recovery.from_percent, -100, 100) \
+    X(SEQ_REC_TO,    "seq.heat_recovery.to_percent",   seq.heat_recovery.to_percent,   -100, 100) \
+    X(SEQ_DEAD_FROM, "seq.deadband.from_percent",      seq.deadband.from_percent,      -100, 100) \
+    X(SEQ_DEAD_TO,   "seq.deadband.to_percent",        seq.deadband.to_percent,        -100, 100) \
+    X(PID_KP,        "pid.kp",                         pid.kp,                     0, INT16_MAX) \
+    X(PID_KI,        "pid.ki",                         pid.ki,                     0, INT16_MAX) \
+    X(PID_KD,        "pid.kd",                         pid.kd,                     0, INT16_MAX) \
+    X(IO_SUPPLY_AI,  "io.t_supply_ai",                 io.t_supply_ai,             -1, HVAC_NUM_AI_INPUTS - 1)   \
+    X(IO_EXTRACT_AI, "io.t_extract_ai",                io.t_extract_ai,            -1, HVAC_NUM_AI_INPUTS - 1)   \
+    X(IO_EXHAUST_AI, "io.t_exhaust_ai",                io.t_exhaust_ai,            -1, HVAC_NUM_AI_INPUTS - 1)   \
+    X(IO_OUTDOOR_AI, "io.t_outdoor_ai",                io.t_outdoor_ai,            -1, HVAC_NUM_AI_INPUTS - 1)   \
+    X(IO_FROST_AI,   "io.frost_ai",                    io.frost_ai,                -1, HVAC_NUM_AI_INPUTS - 1)   \
+    X(IO_BYPASS_AO,  "io.bypass_ao",                   io.bypass_ao,               -1, HVAC_NUM_AO_CHANNELS - 1) \
+    X(IO_FAN_AO,     "io.fan_vfd_ao",                  io.fan_vfd_ao,              -1, HVAC_NUM_AO_CHANNELS - 1) \
+    X(IO_HEATER_AO,  "io.heater_ao",                   io.heater_ao,               -1, HVAC_NUM_AO_CHANNELS - 1) \
+    X(IO_COOLER_AO,  "io.cooler_ao",                   io.cooler_ao,               -1, HVAC_NUM_AO_CHANNELS - 1)
+
+#define HVAC_CFG_F_ENUM(id, path, member, min, max) HVAC_CFG_F_##id,
+
+enum hvac_cfg_field_id {
+    HVAC_CFG_INT_FIELDS(HVAC_CFG_F_ENUM)
+    HVAC_CFG_NUM_INT_FIELDS
+};
+
+/* adres pola liczbowego w konfiguracji */
+int32_t *hvac_cfg_field(struct hvac_config *cfg, enum hvac_cfg_field_id id);
+
+/*
+ * Zakresy pól z listy i kolejność pasm (from <= to). Dla zapisów
+ * z zewnątrz (Modbus) - UI i loadery pilnują tego same.
+ */
+bool hvac_cfg_validate(const struct hvac_config *cfg);
+
+/* znane nazwy sequence_type (hvac_cfg_json.c) */
+#define HVAC_CFG_NUM_SEQ_TYPES 2
+extern const char *const hvac_cfg_seq_types[HVAC_CFG_NUM_SEQ_TYPES];
+
+/* --- Różnice między konfiguracjami --- */
+
+#define HVAC_CFG_CH_SETPOINT        (1U << 0)
+#define HVAC_CFG_CH_PID             (1U << 1)
+#define HVAC_CFG_CH_LOOP_INPUT      (1U << 2)   /* io.t_extract_ai - wejście regulatora */
+#define HVAC_CFG_CH_IO_AI           (1U << 3)
+#define HVAC_CFG_CH_IO_AO           (1U << 4)
+#define HVAC_CFG_CH_SEQ_TYPE        (1U << 5)
+#define HVAC_CFG_CH_SEQ_COOLING     (1U << 8)
+#define HVAC_CFG_CH_SEQ_HEATING     (1U << 9)
+#define HVAC_CFG_CH_SEQ_HEAT_REC    (1U << 10)
+#define HVAC_CFG_CH_SEQ_DEADBAND    (1U << 11)
+
+#define HVAC_CFG_CH_SEQ_BANDS       (HVAC_CFG_CH_SEQ_COOLING | HVAC_CFG_CH_SEQ_HEATING | \
+                                     HVAC_CFG_CH_SEQ_HEAT_REC | HVAC_CFG_CH_SEQ_DEADBAND)
+
+/*
+ * Maska HVAC_CFG_CH_* pól, którymi różnią się a i b (0 = identyczne).
+ * Zmiana t_extract_ai ustawia też HVAC_CFG_CH_IO_AI.
+ */
+uint32_t hvac_cfg_diff(const struct hvac_config *a, const struct hvac_config *b);
+
+#endif /* HVAC_CONFIG_H */
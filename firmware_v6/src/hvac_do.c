@@ -0,0 +1,305 @@
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+
+#include "hvac_do.h"
+
+LOG_MODULE_REGISTER(hvac_do, CONFIG_LOG_DEFAULT_LEVEL);
+
+/* demand trzymany w 0.01 % żeby dało się go zapisać atomowo */
+#define HVAC_DO_DEMAND_FULL 10000
+
+#define HVAC_DO_NODE DT_NODELABEL(hvac_do)
+
+#if DT_NODE_EXISTS(HVAC_DO_NODE)
+#define HVAC_DO_GPIO_SPEC(node) GPIO_DT_SPEC_GET(node, gpios),
+static const struct gpio_dt_spec hvac_do_gpios[] = {
+    DT_FOREACH_CHILD_STATUS_OKAY(HVAC_DO_NODE, HVAC_DO_GPIO_SPEC)
+};
+#define HVAC_DO_NUM_LINES ARRAY_SIZE(hvac_do_gpios)
+#else
+/* brak węzła w DT (np. native_sim) - linie tylko w RAM */
+#define HVAC_DO_NUM_LINES CONFIG_HVAC_DO_NUM_VIRTUAL_LINES
+#endif
+
+struct hvac_do_line {
+    bool     on;
+    uint32_t since;          /* ticki od ostatniego przełączenia */
+};
+
+struct hvac_do_out {
+    enum hvac_do_mode mode;
+    uint8_t  first_line;
+    uint8_t  num_lines;
+    uint32_t period_ticks;
+    uint32_t min_on_ticks;
+    uint32_t min_off_ticks;
+
+    atomic_t demand;         /* 0..HVAC_DO_DEMAND_FULL */
+
+    /* TPWM */
+    uint32_t phase;
+    uint32_t on_ticks;
+    int32_t  carry;          /* zadane minus faktycznie załączone ticki z poprzednich okresów */
+
+    /* STAGED */
+    uint8_t  active_stages;
+};
+
+static struct hvac_do_line hvac_do_lines[HVAC_DO_NUM_LINES];
+static struct hvac_do_out  hvac_do_outs[HVAC_DO_OUT_COUNT];
+static struct k_spinlock   hvac_do_lock;
+static struct k_timer      hvac_do_timer;
+
+static uint32_t hvac_do_ms_to_ticks(uint32_t ms)
+{
+    return DIV_ROUND_UP(ms, CONFIG_HVAC_DO_TICK_MS);
+}
+
+static void hvac_do_line_write(int line, bool on)
+{
+    struct hvac_do_line *l = &hvac_do_lines[line];
+
+    if (l->on == on) {
+        return;
+    }
+
+    l->on = on;
+    l->since = 0;
+
+#if DT_NODE_EXISTS(HVAC_DO_NODE)
+    gpio_pin_set_dt(&hvac_do_gpios[line], on ? 1 : 0);
+#endif
+}
+
+/* Przełącza linię tylko wtedy, gdy pozwalają na to minimalne czasy on/off. */
+static bool hvac_do_line_request(const struct hvac_do_out *out, int line, bool on)
+{
+    struct hvac_do_line *l = &hvac_do_lines[line];
+
+    if (l->on == on) {
+        return true;
+    }
+
+    uint32_t min_ticks = l->on ? out->min_on_ticks : out->min_off_ticks;
+    if (l->since < min_ticks) {
+        return false;
+    }
+
+    hvac_do_line_write(line, on);
+    return true;
+}
+
+static void hvac_do_tpwm_tick(struct hvac_do_out *out)
+{
+    if (out->phase == 0) {
+        uint32_t demand = (uint32_t)atomic_get(&out->demand);
+        int32_t period = (int32_t)out->period_ticks;
+        int32_t req = (int32_t)((out->period_ticks * demand +
+                                 HVAC_DO_DEMAND_FULL / 2) / HVAC_DO_DEMAND_FULL);
+
+        /*
+         * Impulsy krótsze niż min_on (albo przerwy krótsze niż min_off)
+         * są pomijane, a różnica przechodzi na kolejne okresy, więc
+         * średnia moc dalej odpowiada zadanej wartości. Carry liczy
+         * faktyczny czas załączenia linii, więc nadmiar też wraca - np.
+         * gdy min_on przytrzymał linię dłużej niż plan.
+         */
+        if (out->carry > period)  out->carry = period;
+        if (out->carry < -period) out->carry = -period;
+
+        int32_t on = out->carry + req;
+        if (on < 0)      on = 0;
+        if (on > period) on = period;
+
+        if (on < (int32_t)out->min_on_ticks) {
+            on = 0;
+        } else if (period - on < (int32_t)out->min_off_ticks) {
+            on = period;
+        }
+
+        out->carry += req;
+        out->on_ticks = (uint32_t)on;
+    }
+
+    hvac_do_line_request(out, out->first_line, out->phase < out->on_ticks);
+    if (hvac_do_lines[out->first_line].on) {
+        out->carry--;
+    }
+
+    out->phase++;
+    if (out->phase >= out->period_ticks) {
+        out->phase = 0;
+    }
+}
+
+static void hvac_do_staged_tick(struct hvac_do_out *out)
+{
+    uint32_t demand = (uint32_t)atomic_get(&out->demand);
+    uint8_t target = (uint8_t)((demand * out->num_lines + HVAC_DO_DEMAND_FULL / 2) /
+                               HVAC_DO_DEMAND_FULL);
+
+    /* jeden stopień na tick - styczniki nie załączają się jednocześnie */
+    if (out->active_stages < target) {
+        if (hvac_do_line_request(out, out->first_line + out->active_stages, true)) {
+            out->active_stages++;
+        }
+    } else if (out->active_stages > target) {
+        if (hvac_do_line_request(out, out->first_line + out->active_stages - 1, false)) {
+            out->active_stages--;
+        }
+    }
+}
+
+static void hvac_do_timer_fn(struct k_timer *timer)
+{
+    ARG_UNUSED(timer);
+
+    k_spinlock_key_t key = k_spin_lock(&hvac_do_lock);
+
+    for (int i = 0; i < HVAC_DO_OUT_COUNT; i++) {
+        struct hvac_do_out *out = &hvac_do_outs[i];
+
+        switch (out->mode) {
+        case HVAC_DO_MODE_TPWM:   hvac_do_tpwm_tick(out);   break;
+        case HVAC_DO_MODE_STAGED: hvac_do_staged_tick(out); break;
+        default:                                            break;
+        }
+    }
+
+    for (int i = 0; i < (int)HVAC_DO_NUM_LINES; i++) {
+        if (hvac_do_lines[i].since < UINT32_MAX) {
+            hvac_do_lines[i].since++;
+        }
+    }
+
+    k_spin_unlock(&hvac_do_lock, key);
+}
+
+int hvac_do_init(void)
+{
+#if DT_NODE_EXISTS(HVAC_DO_NODE)
+    for (int i = 0; i < (int)HVAC_DO_NUM_LINES; i++) {
+        if (!device_is_ready(hvac_do_gpios[i].port)) {
+            LOG_ERR("DO line %d GPIO not ready", i);
+            return -ENODEV;
+        }
+
+        int ret = gpio_pin_configure_dt(&hvac_do_gpios[i], GPIO_OUTPUT_INACTIVE);
+        if (ret < 0) {
+            LOG_ERR("DO line %d configure failed: %d", i, ret);
+            return ret;
+        }
+    }
+#endif
+
+    /* po starcie linie traktujemy jak "dawno wyłączone" */
+    for (int i = 0; i < (int)HVAC_DO_NUM_LINES; i++) {
+        hvac_do_lines[i].on = false;
+        hvac_do_lines[i].since = UINT32_MAX;
+    }
+
+    k_timer_init(&hvac_do_timer, hvac_do_timer_fn, NULL);
+    k_timer_start(&hvac_do_timer,
+                  K_MSEC(CONFIG_HVAC_DO_TICK_MS),
+                  K_MSEC(CONFIG_HVAC_DO_TICK_MS));
+
+    LOG_INF("DO driver: %d lines, tick %d ms",
+            (int)HVAC_DO_NUM_LINES, CONFIG_HVAC_DO_TICK_MS);
+
+    return 0;
+}
+
+int hvac_do_configure(int out_idx, const struct hvac_do_cfg *cfg)
+{
+    if (out_idx < 0 || out_idx >= HVAC_DO_OUT_COUNT) {
+        return -EINVAL;
+    }
+
+    uint8_t num_lines = 0;
+
+    switch (cfg->mode) {
+    case HVAC_DO_MODE_OFF:    num_lines = 0;               break;
+    case HVAC_DO_MODE_TPWM:   num_lines = 1;               break;
+    case HVAC_DO_MODE_STAGED: num_lines = cfg->num_stages; break;
+    default:                  return -EINVAL;
+    }
+
+    if (cfg->first_line + num_lines > HVAC_DO_NUM_LINES) {
+        LOG_ERR("DO out %d: lines %d..%d out of range",
+                out_idx, cfg->first_line, cfg->first_line + num_lines - 1);
+        return -EINVAL;
+    }
+
+    if (cfg->mode == HVAC_DO_MODE_TPWM && cfg->period_ms < CONFIG_HVAC_DO_TICK_MS) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&hvac_do_lock);
+
+    /* jedna linia - jedno wyjście */
+    for (int i = 0; i < HVAC_DO_OUT_COUNT; i++) {
+        const struct hvac_do_out *o = &hvac_do_outs[i];
+
+        if (i != out_idx && num_lines > 0 && o->num_lines > 0 &&
+            cfg->first_line < o->first_line + o->num_lines &&
+            o->first_line < cfg->first_line + num_lines) {
+            k_spin_unlock(&hvac_do_lock, key);
+            LOG_ERR("DO out %d: lines overlap out %d", out_idx, i);
+            return -EBUSY;
+        }
+    }
+
+    struct hvac_do_out *out = &hvac_do_outs[out_idx];
+
+    /* stare linie wyłączamy od razu, zmiana konfiguracji to nie praca normalna */
+    for (int i = 0; i < out->num_lines; i++) {
+        hvac_do_line_write(out->first_line + i, false);
+    }
+
+    out->mode          = cfg->mode;
+    out->first_line    = cfg->first_line;
+    out->num_lines     = num_lines;
+    out->period_ticks  = hvac_do_ms_to_ticks(cfg->period_ms);
+    out->min_on_ticks  = hvac_do_ms_to_ticks(cfg->min_on_ms);
+    out->min_off_ticks = hvac_do_ms_to_ticks(cfg->min_off_ms);
+    out->phase         = 0;
+    out->on_ticks      = 0;
+    out->carry         = 0;
+    out->active_stages = 0;
+
+    k_spin_unlock(&hvac_do_lock, key);
+
+    return 0;
+}
+
+void hvac_do_set_pct(int out_idx, float pct)
+{
+    if (out_idx < 0 || out_idx >= HVAC_DO_OUT_COUNT) {
+        return;
+    }
+
+    if (pct < 0.0f)   pct = 0.0f;
+    if (pct > 100.0f) pct = 100.0f;
+
+    atomic_set(&hvac_do_outs[out_idx].demand,
+               (atomic_val_t)(pct * (HVAC_DO_DEMAND_FULL / 100) + 0.5f));
+}
+
+int hvac_do_num_lines(void)
+{
+    return (int)HVAC_DO_NUM_LINES;
+}
+
+bool hvac_do_line_get(int line)
+{
+    if (line < 0 || line >= (int)HVAC_DO_NUM_LINES) {
+        return false;
+    }
+
+    return hvac_do_lines[line].on;
+}
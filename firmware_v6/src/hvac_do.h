@@ -0,0 +1,41 @@
+#ifndef HVAC_DO_H
+#define HVAC_DO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Wyjścia cyfrowe (SSR / styczniki) sterowane procentem z sekwencji.
+ * Przełączanie odbywa się w k_timer co CONFIG_HVAC_DO_TICK_MS,
+ * niezależnie od okresu pętli regulacji.
+ */
+
+enum hvac_do_mode {
+    HVAC_DO_MODE_OFF = 0,
+    HVAC_DO_MODE_TPWM,      /* time-proportioning PWM na jednej linii */
+    HVAC_DO_MODE_STAGED,    /* N stopni, każdy na osobnej linii */
+};
+
+enum {
+    HVAC_DO_OUT_HEATER = 0,
+    HVAC_DO_OUT_COOLER,
+    HVAC_DO_OUT_COUNT
+};
+
+struct hvac_do_cfg {
+    enum hvac_do_mode mode;
+    uint8_t  first_line;
+    uint8_t  num_stages;     /* tylko HVAC_DO_MODE_STAGED */
+    uint32_t period_ms;      /* tylko HVAC_DO_MODE_TPWM */
+    uint32_t min_on_ms;
+    uint32_t min_off_ms;
+};
+
+int  hvac_do_init(void);
+int  hvac_do_configure(int out, const struct hvac_do_cfg *cfg);
+void hvac_do_set_pct(int out, float pct);
+
+int  hvac_do_num_lines(void);
+bool hvac_do_line_get(int line);
+
+#endif /* HVAC_DO_H */
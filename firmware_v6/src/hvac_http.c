@@ -0,0 +1,539 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/http/server.h>
+#include <zephyr/net/http/service.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(CONFIG_HVAC_HTTP_WS)
+#include <zephyr/net/websocket.h>
+#endif
+
+#include "hvac_cfg_json.h"
+#include "hvac_cfg_upload.h"
+#include "hvac_http.h"
+#include "hvac_io.h"
+
+LOG_MODULE_REGISTER(hvac_http, CONFIG_LOG_DEFAULT_LEVEL);
+
+static const struct hvac_http_ops *hvac_http_ops;
+
+/* serwer obsługuje klientów w jednym wątku - bufory odpowiedzi są wspólne */
+static char hvac_http_body[768];
+
+static uint16_t hvac_http_port = CONFIG_HVAC_HTTP_PORT;
+
+HTTP_SERVICE_DEFINE(hvac_http_service, NULL, &hvac_http_port,
+                    CONFIG_HTTP_SERVER_MAX_CLIENTS, 4, NULL);
+
+/* --- Pomocnicze --- */
+
+static int hvac_http_reply(struct http_response_ctx *rsp, enum http_status status,
+                           const char *body, size_t len)
+{
+    rsp->status      = status;
+    rsp->body        = (const uint8_t *)body;
+    rsp->body_len    = len;
+    rsp->final_chunk = true;
+    return 0;
+}
+
+static int hvac_http_error(struct http_response_ctx *rsp, enum http_status status,
+                           const char *msg)
+{
+    int n = snprintf(hvac_http_body, sizeof(hvac_http_body), "{\"error\":\"%s\"}", msg);
+
+    return hvac_http_reply(rsp, status, hvac_http_body, n);
+}
+
+static const char hvac_http_ok[] = "{\"ok\":true}";
+
+/* --- /api/config --- */
+
+/*
+ * POST przychodzi kawałkami prosto do parsera (hvac_cfg_upload.h) -
+ * dokument nie jest nigdzie składany w całości. Klient odrzucony przy
+ * pierwszym kawałku dostaje 503 dopiero po odebraniu całej treści.
+ */
+static struct http_client_ctx *hvac_http_rejected;
+
+static int hvac_http_config_cb(struct http_client_ctx *client, enum http_data_status status,
+                               const struct http_request_ctx *req,
+                               struct http_response_ctx *rsp, void *user_data)
+{
+    struct hvac_config cfg;
+    int ret;
+
+    ARG_UNUSED(user_data);
+
+    if (status == HTTP_SERVER_DATA_ABORTED) {
+        hvac_cfg_upload_abort(client);
+        if (hvac_http_rejected == client) {
+            hvac_http_rejected = NULL;
+        }
+        return 0;
+    }
+
+    if (client->method == HTTP_GET) {
+        if (status != HTTP_SERVER_DATA_FINAL) {
+            return 0;
+        }
+
+        hvac_http_ops->get_cfg(&cfg);
+        int n = hvac_cfg_json_write(&cfg, hvac_http_body, sizeof(hvac_http_body));
+        if (n < 0) {
+            return hvac_http_error(rsp, HTTP_500_INTERNAL_SERVER_ERROR, "config too large");
+        }
+        return hvac_http_reply(rsp, HTTP_200_OK, hvac_http_body, n);
+    }
+
+    /* POST */
+    if (hvac_http_rejected != client) {
+        ret = hvac_cfg_upload_feed(client, (const char *)req->data, req->data_len);
+        if (ret == -EPERM) {
+            /* pierwszy kawałek tego żądania */
+            hvac_http_ops->get_cfg(&cfg);
+            if (hvac_cfg_upload_begin(client, &cfg) != 0) {
+                hvac_http_rejected = client;
+            } else {
+                (void)hvac_cfg_upload_feed(client, (const char *)req->data, req->data_len);
+            }
+        }
+    }
+
+    if (status != HTTP_SERVER_DATA_FINAL) {
+        return 0;
+    }
+
+    if (hvac_http_rejected == client) {
+        hvac_http_rejected = NULL;
+        return hvac_http_error(rsp, HTTP_503_SERVICE_UNAVAILABLE, "upload in progress");
+    }
+
+    ret = hvac_cfg_upload_commit(client, &cfg);
+    if (ret == -ERANGE) {
+        return hvac_http_error(rsp, HTTP_400_BAD_REQUEST, "value out of range");
+    }
+    if (ret < 0) {
+        return hvac_http_error(rsp, HTTP_400_BAD_REQUEST, "invalid JSON");
+    }
+
+    hvac_http_ops->set_cfg(&cfg);
+
+    return hvac_http_reply(rsp, HTTP_200_OK, hvac_http_ok, sizeof(hvac_http_ok) - 1);
+}
+
+static struct http_resource_detail_dynamic hvac_http_config_res = {
+    .common = {
+        .type = HTTP_RESOURCE_TYPE_DYNAMIC,
+        .bitmask_of_supported_http_methods = BIT(HTTP_GET) | BIT(HTTP_POST),
+        .content_type = "application/json",
+    },
+    .cb = hvac_http_config_cb,
+};
+
+HTTP_RESOURCE_DEFINE(hvac_http_config, hvac_http_service, "/api/config",
+                     &hvac_http_config_res);
+
+/* --- /api/setpoint --- */
+
+static char   hvac_http_sp_buf[16];
+static size_t hvac_http_sp_len;
+
+static int hvac_http_setpoint_cb(struct http_client_ctx *client, enum http_data_status status,
+                                 const struct http_request_ctx *req,
+                                 struct http_response_ctx *rsp, void *user_data)
+{
+    struct hvac_config cfg;
+
+    ARG_UNUSED(user_data);
+
+    if (status == HTTP_SERVER_DATA_ABORTED) {
+        hvac_http_sp_len = 0;
+        return 0;
+    }
+
+    if (client->method == HTTP_POST) {
+        size_t n = MIN(req->data_len, sizeof(hvac_http_sp_buf) - 1 - hvac_http_sp_len);
+
+        memcpy(&hvac_http_sp_buf[hvac_http_sp_len], req->data, n);
+        hvac_http_sp_len += n;
+    }
+
+    if (status != HTTP_SERVER_DATA_FINAL) {
+        return 0;
+    }
+
+    hvac_http_ops->get_cfg(&cfg);
+
+    if (client->method == HTTP_POST) {
+        char *end;
+
+        hvac_http_sp_buf[hvac_http_sp_len] = '\0';
+        hvac_http_sp_len = 0;
+
+        long v = strtol(hvac_http_sp_buf, &end, 10);
+        while (*end == ' ' || *end == '\r' || *end == '\n') {
+            end++;
+        }
+        if (end == hvac_http_sp_buf || *end != '\0') {
+            return hvac_http_error(rsp, HTTP_400_BAD_REQUEST, "expected an integer");
+        }
+
+        cfg.setpoint = (int32_t)CLAMP(v, INT32_MIN, INT32_MAX);
+        if (!hvac_cfg_validate(&cfg)) {
+            return hvac_http_error(rsp, HTTP_400_BAD_REQUEST, "value out of range");
+        }
+        hvac_http_ops->set_cfg(&cfg);
+    }
+
+    int n = snprintf(hvac_http_body, sizeof(hvac_http_body), "{\"setpoint\":%d}", cfg.setpoint);
+
+    return hvac_http_reply(rsp, HTTP_200_OK, hvac_http_body, n);
+}
+
+static struct http_resource_detail_dynamic hvac_http_setpoint_res = {
+    .common = {
+        .type = HTTP_RESOURCE_TYPE_DYNAMIC,
+        .bitmask_of_supported_http_methods = BIT(HTTP_GET) | BIT(HTTP_POST),
+        .content_type = "application/json",
+    },
+    .cb = hvac_http_setpoint_cb,
+};
+
+HTTP_RESOURCE_DEFINE(hvac_http_setpoint, hvac_http_service, "/api/setpoint",
+                     &hvac_http_setpoint_res);
+
+/* --- /api/io --- */
+
+static int hvac_http_put_floats(char *buf, size_t len, const char *name,
+                                const float *v, size_t n)
+{
+    int pos = snprintf(buf, len, "\"%s\":[", name);
+
+    for (size_t i = 0; i < n && pos < (int)len; i++) {
+        pos += snprintf(&buf[pos], len - pos, "%s%.3f", i ? "," : "", (double)v[i]);
+    }
+    if (pos < (int)len) {
+        pos += snprintf(&buf[pos], len - pos, "]");
+    }
+    return pos;
+}
+
+static int hvac_http_io_cb(struct http_client_ctx *client, enum http_data_status status,
+                           const struct http_request_ctx *req,
+                           struct http_response_ctx *rsp, void *user_data)
+{
+    struct hvac_io_image img;
+    char *b = hvac_http_body;
+    size_t len = sizeof(hvac_http_body);
+    int pos;
+
+    ARG_UNUSED(client);
+    ARG_UNUSED(req);
+    ARG_UNUSED(user_data);
+
+    if (status != HTTP_SERVER_DATA_FINAL) {
+        return 0;
+    }
+
+    hvac_io_snapshot(&img);
+
+    pos = snprintf(b, len, "{\"frame\":%u,", img.frame);
+    pos += hvac_http_put_floats(&b[pos], len - MIN(pos, len), "ai", img.ai_v,
+                                HVAC_NUM_AI_CHANNELS);
+    pos += snprintf(&b[pos], len - MIN(pos, len), ",");
+    pos += hvac_http_put_floats(&b[pos], len - MIN(pos, len), "ao", img.ao_v,
+                                HVAC_NUM_AO_CHANNELS);
+#if HVAC_NUM_EXT_CHANNELS > 0
+    pos += snprintf(&b[pos], len - MIN(pos, len), ",");
+    pos += hvac_http_put_floats(&b[pos], len - MIN(pos, len), "ext", img.ext_v,
+                                HVAC_NUM_EXT_CHANNELS);
+    pos += snprintf(&b[pos], len - MIN(pos, len), ",\"ext_valid\":%u", img.ext_valid);
+#endif
+    pos += snprintf(&b[pos], len - MIN(pos, len), "}");
+
+    if (pos >= (int)len) {
+        return hvac_http_error(rsp, HTTP_500_INTERNAL_SERVER_ERROR, "image too large");
+    }
+    return hvac_http_reply(rsp, HTTP_200_OK, b, pos);
+}
+
+static struct http_resource_detail_dynamic hvac_http_io_res = {
+    .common = {
+        .type = HTTP_RESOURCE_TYPE_DYNAMIC,
+        .bitmask_of_supported_http_methods = BIT(HTTP_GET),
+        .content_type = "application/json",
+    },
+    .cb = hvac_http_io_cb,
+};
+
+HTTP_RESOURCE_DEFINE(hvac_http_io, hvac_http_service, "/api/io", &hvac_http_io_res);
+
+/* --- /ws/io --- */
+
+#if defined(CONFIG_HVAC_HTTP_WS)
+
+#define HVAC_WS_CH      (HVAC_NUM_AI_CHANNELS + HVAC_NUM_AO_CHANNELS + HVAC_NUM_EXT_CHANNELS)
+#define HVAC_WS_CLIENTS CONFIG_HVAC_HTTP_WS_CLIENTS
+
+struct hvac_ws_client {
+    int  sock;                    /* -1 = wolne */
+    bool need_full;
+};
+
+static struct hvac_ws_client hvac_ws_clients[HVAC_WS_CLIENTS];
+static K_MUTEX_DEFINE(hvac_ws_lock);
+
+/* wartości ostatnio wysłane - względem nich liczone są zmiany */
+static int32_t hvac_ws_last[HVAC_WS_CH];
+
+static char   hvac_ws_batch[CONFIG_HVAC_HTTP_WS_BATCH_SIZE];
+static size_t hvac_ws_batch_len;
+static uint8_t hvac_ws_rx[64];
+
+static void hvac_ws_values(const struct hvac_io_image *img, int32_t *out)
+{
+    int n = 0;
+
+    for (int i = 0; i < HVAC_NUM_AI_CHANNELS; i++) {
+        out[n++] = (int32_t)(img->ai_v[i] * 1000.0f);
+    }
+    for (int i = 0; i < HVAC_NUM_AO_CHANNELS; i++) {
+        out[n++] = (int32_t)(img->ao_v[i] * 1000.0f);
+    }
+#if HVAC_NUM_EXT_CHANNELS > 0
+    for (int i = 0; i < HVAC_NUM_EXT_CHANNELS; i++) {
+        out[n++] = (int32_t)(img->ext_v[i] * 1000.0f);
+    }
+#endif
+}
+
+/* dopisuje próbkę ze zmienionymi kanałami; false = nie mieści się w paczce */
+static bool hvac_ws_sample(const struct hvac_io_image *img)
+{
+    int32_t v[HVAC_WS_CH];
+    char tmp[24];
+    char line[HVAC_WS_CH * 18 + 24];
+    int pos;
+    bool any = false;
+
+    hvac_ws_values(img, v);
+
+    pos = snprintf(line, sizeof(line), "%s[%u", (hvac_ws_batch_len > 0) ? "," : "",
+                   img->frame);
+
+    for (int ch = 0; ch < HVAC_WS_CH; ch++) {
+        if (abs(v[ch] - hvac_ws_last[ch]) < CONFIG_HVAC_HTTP_WS_DEADBAND_MV) {
+            continue;
+        }
+        int n = snprintf(tmp, sizeof(tmp), ",%d,%d", ch, v[ch]);
+        memcpy(&line[pos], tmp, n);
+        pos += n;
+        any = true;
+    }
+    line[pos++] = ']';
+
+    if (!any) {
+        return true;
+    }
+
+    /* miejsce na "{"s":[" i "]}" */
+    if (hvac_ws_batch_len + pos + 8 > sizeof(hvac_ws_batch)) {
+        return false;
+    }
+
+    if (hvac_ws_batch_len == 0) {
+        memcpy(hvac_ws_batch, "{\"s\":[", 6);
+        hvac_ws_batch_len = 6;
+    }
+    memcpy(&hvac_ws_batch[hvac_ws_batch_len], line, pos);
+    hvac_ws_batch_len += pos;
+
+    for (int ch = 0; ch < HVAC_WS_CH; ch++) {
+        if (abs(v[ch] - hvac_ws_last[ch]) >= CONFIG_HVAC_HTTP_WS_DEADBAND_MV) {
+            hvac_ws_last[ch] = v[ch];
+        }
+    }
+    return true;
+}
+
+/* wątek strumienia; slot zwalnia tylko on, hvac_ws_setup() zajmuje tylko wolne */
+static void hvac_ws_drop(int slot)
+{
+    k_mutex_lock(&hvac_ws_lock, K_FOREVER);
+    (void)websocket_unregister(hvac_ws_clients[slot].sock);
+    hvac_ws_clients[slot].sock = -1;
+    k_mutex_unlock(&hvac_ws_lock);
+}
+
+/*
+ * Lista klientów kopiowana pod hvac_ws_lock, wysyłanie bez blokady -
+ * wolny klient (do CONFIG_HVAC_HTTP_WS_PUSH_MS na send) nie zatrzymuje
+ * hvac_ws_setup() w wątku serwera HTTP.
+ */
+static void hvac_ws_push(void)
+{
+    static char full[HVAC_WS_CH * 12 + 16];
+    struct hvac_ws_client clients[HVAC_WS_CLIENTS];
+    int full_len = -1;
+
+    if (hvac_ws_batch_len > 0) {
+        memcpy(&hvac_ws_batch[hvac_ws_batch_len], "]}", 2);
+        hvac_ws_batch_len += 2;
+    }
+
+    k_mutex_lock(&hvac_ws_lock, K_FOREVER);
+    memcpy(clients, hvac_ws_clients, sizeof(clients));
+    for (int i = 0; i < HVAC_WS_CLIENTS; i++) {
+        hvac_ws_clients[i].need_full = false;
+    }
+    k_mutex_unlock(&hvac_ws_lock);
+
+    for (int i = 0; i < HVAC_WS_CLIENTS; i++) {
+        struct hvac_ws_client *c = &clients[i];
+        uint32_t type;
+        uint64_t remaining;
+        int ret;
+
+        if (c->sock < 0) {
+            continue;
+        }
+
+        /* przeglądarka nic nie wysyła; czytamy tylko zamknięcie i ping */
+        ret = websocket_recv_msg(c->sock, hvac_ws_rx, sizeof(hvac_ws_rx), &type, &remaining, 0);
+        if ((ret < 0 && ret != -EAGAIN) || (ret >= 0 && (type & WEBSOCKET_FLAG_CLOSE))) {
+            hvac_ws_drop(i);
+            continue;
+        }
+
+        if (c->need_full) {
+            /* stan odniesienia już zawiera bieżącą paczkę */
+            if (full_len < 0) {
+                full_len = snprintf(full, sizeof(full), "{\"full\":[");
+                for (int ch = 0; ch < HVAC_WS_CH; ch++) {
+                    full_len += snprintf(&full[full_len], sizeof(full) - full_len, "%s%d",
+                                         ch ? "," : "", hvac_ws_last[ch]);
+                }
+                full_len += snprintf(&full[full_len], sizeof(full) - full_len, "]}");
+            }
+            ret = websocket_send_msg(c->sock, (const uint8_t *)full, full_len, WEBSOCKET_OPCODE_DATA_TEXT,
+                                     false, true, CONFIG_HVAC_HTTP_WS_PUSH_MS);
+        } else if (hvac_ws_batch_len > 0) {
+            ret = websocket_send_msg(c->sock, (const uint8_t *)hvac_ws_batch,
+                                     hvac_ws_batch_len,
+                                     WEBSOCKET_OPCODE_DATA_TEXT, false, true,
+                                     CONFIG_HVAC_HTTP_WS_PUSH_MS);
+        } else {
+            ret = 0;
+        }
+
+        if (ret < 0) {
+            LOG_DBG("WebSocket client %d dropped: %d", c->sock, ret);
+            hvac_ws_drop(i);
+        }
+    }
+
+    hvac_ws_batch_len = 0;
+}
+
+/* paczka i hvac_ws_last należą tylko do tego wątku */
+static void hvac_ws_thread(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    int64_t next_sample = k_uptime_get();
+    int64_t next_push = next_sample + CONFIG_HVAC_HTTP_WS_PUSH_MS;
+
+    while (1) {
+        struct hvac_io_image img;
+
+        k_sleep(K_TIMEOUT_ABS_MS(next_sample));
+        next_sample += CONFIG_HVAC_HTTP_WS_SAMPLE_MS;
+
+        hvac_io_snapshot(&img);
+
+        if (!hvac_ws_sample(&img)) {
+            hvac_ws_push();
+            (void)hvac_ws_sample(&img);
+        }
+
+        if (k_uptime_get() >= next_push) {
+            hvac_ws_push();
+            next_push += CONFIG_HVAC_HTTP_WS_PUSH_MS;
+        }
+    }
+}
+
+K_THREAD_DEFINE(hvac_ws_thread_id, CONFIG_HVAC_HTTP_WS_STACK_SIZE,
+                hvac_ws_thread, NULL, NULL, NULL,
+                CONFIG_HVAC_HTTP_WS_PRIORITY, 0, SYS_FOREVER_MS);  /* startuje hvac_http_start() */
+
+/* wątek serwera HTTP: gniazdo przechodzi na własność strumienia */
+static int hvac_ws_setup(int ws_socket, struct http_request_ctx *req, void *user_data)
+{
+    int ret = -ENOENT;
+
+    ARG_UNUSED(req);
+    ARG_UNUSED(user_data);
+
+    k_mutex_lock(&hvac_ws_lock, K_FOREVER);
+    for (int i = 0; i < HVAC_WS_CLIENTS; i++) {
+        if (hvac_ws_clients[i].sock < 0) {
+            hvac_ws_clients[i].sock = ws_socket;
+            hvac_ws_clients[i].need_full = true;
+            ret = 0;
+            break;
+        }
+    }
+    k_mutex_unlock(&hvac_ws_lock);
+
+    if (ret < 0) {
+        LOG_WRN("No free WebSocket slot");
+    }
+    return ret;
+}
+
+static uint8_t hvac_ws_buf[64];
+
+static struct http_resource_detail_websocket hvac_http_ws_res = {
+    .common = {
+        .type = HTTP_RESOURCE_TYPE_WEBSOCKET,
+        .bitmask_of_supported_http_methods = BIT(HTTP_GET),
+    },
+    .cb = hvac_ws_setup,
+    .data_buffer = hvac_ws_buf,
+    .data_buffer_len = sizeof(hvac_ws_buf),
+};
+
+HTTP_RESOURCE_DEFINE(hvac_http_ws, hvac_http_service, "/ws/io", &hvac_http_ws_res);
+
+#endif /* CONFIG_HVAC_HTTP_WS */
+
+/* --- API --- */
+
+int hvac_http_start(const struct hvac_http_ops *ops)
+{
+    hvac_http_ops = ops;
+
+#if defined(CONFIG_HVAC_HTTP_WS)
+    for (int i = 0; i < HVAC_WS_CLIENTS; i++) {
+        hvac_ws_clients[i].sock = -1;
+    }
+    k_thread_start(hvac_ws_thread_id);
+#endif
+
+    int ret = http_server_start();
+    if (ret < 0) {
+        LOG_ERR("HTTP server start failed: %d", ret);
+        return ret;
+    }
+
+    LOG_INF("HTTP server on port %u", hvac_http_port);
+    return 0;
+}
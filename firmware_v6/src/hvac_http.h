@@ -0,0 +1,33 @@
+#ifndef HVAC_HTTP_H
+#define HVAC_HTTP_H
+
+#include "hvac_config.h"
+
+/*
+ * REST i WebSocket na serwerze HTTP Zephyra (CONFIG_HVAC_HTTP_PORT):
+ *
+ *   GET  /api/config    config w formacie plików z configs/
+ *   POST /api/config    nowy config (cały dokument) - parsowany w trakcie
+ *                       odbioru, po walidacji trafia do UI w całości
+ *   GET  /api/setpoint  {"setpoint":21}
+ *   POST /api/setpoint  liczba całkowita w treści
+ *   GET  /api/io        obraz procesu: AI, AO [V], wejścia zewnętrzne
+ *   GET  /ws/io         WebSocket ze zmianami obrazu procesu
+ *
+ * Strumień /ws/io: po połączeniu {"full":[...]}, potem paczki
+ * {"s":[[frame,kanał,wartość,kanał,wartość...],...]} - próbka co
+ * CONFIG_HVAC_HTTP_WS_SAMPLE_MS zawiera tylko kanały zmienione o co
+ * najmniej CONFIG_HVAC_HTTP_WS_DEADBAND_MV, paczka idzie co
+ * CONFIG_HVAC_HTTP_WS_PUSH_MS jednym zapisem na klienta. Kanały: AI 0..7,
+ * AO 8..15, dalej wejścia zewnętrzne; wartości w mV (tysięcznych).
+ */
+
+/* jak hvac_modbus_ops: config należy do wątku UI, obie nie blokują */
+struct hvac_http_ops {
+    void (*get_cfg)(struct hvac_config *out);
+    void (*set_cfg)(const struct hvac_config *cfg);
+};
+
+int hvac_http_start(const struct hvac_http_ops *ops);
+
+#endif /* HVAC_HTTP_H */
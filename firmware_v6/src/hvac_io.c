@@ -0,0 +1,315 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+
+#if defined(CONFIG_HVAC_IO_REGS)
+#include <zephyr/sys/byteorder.h>
+#endif
+
+#include "hvac_io.h"
+#include "hvac_io_backend.h"
+
+LOG_MODULE_REGISTER(hvac_io, CONFIG_LOG_DEFAULT_LEVEL);
+
+/* --- Backend "none": brak sprzętu, wejścia zawsze 0 V --- */
+
+static int hvac_io_none_start_read(void)
+{
+    static const float zero[HVAC_NUM_AI_CHANNELS];
+
+    hvac_io_ai_frame_done(zero, 0);
+    return 0;
+}
+
+static void hvac_io_none_write(const float ao_v[HVAC_NUM_AO_CHANNELS])
+{
+    ARG_UNUSED(ao_v);
+}
+
+static const struct hvac_io_backend hvac_io_backend_none = {
+    .name       = "none",
+    .start_read = hvac_io_none_start_read,
+    .write      = hvac_io_none_write,
+};
+
+/* --- Obraz procesu --- */
+
+static const struct hvac_io_backend *hvac_io_backend;
+
+static struct hvac_io_image hvac_io_img;
+static float                hvac_io_ao_staged[HVAC_NUM_AO_CHANNELS];
+static struct k_spinlock    hvac_io_lock;
+
+/* wymuszenia: wartość i koniec (k_uptime_get), aktywne bity w img.ao_forced */
+static float   hvac_io_force_v[HVAC_NUM_AO_CHANNELS];
+static int64_t hvac_io_force_until[HVAC_NUM_AO_CHANNELS];
+
+#if defined(CONFIG_HVAC_IO_REGS)
+static uint8_t hvac_io_regs[HVAC_IO_REG_COUNT * 2];
+
+static uint16_t hvac_io_mv(float v)
+{
+    return (uint16_t)CLAMP((int32_t)(v * 1000.0f + 0.5f), 0, UINT16_MAX);
+}
+
+/* pod hvac_io_lock */
+static void hvac_io_regs_put(uint16_t reg, const float *v, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        sys_put_be16(hvac_io_mv(v[i]), &hvac_io_regs[(reg + i) * 2]);
+    }
+}
+#endif
+
+static K_SEM_DEFINE(hvac_io_frame_sem, 0, 1);
+static atomic_t hvac_io_read_busy;
+static int      hvac_io_read_result;
+static uint32_t hvac_io_read_start_cyc;
+static uint32_t hvac_io_read_us;          /* ostatni czas odczytu ramki */
+
+static struct k_timer hvac_io_prefetch_timer;
+
+static void hvac_io_start_read(void)
+{
+    if (!atomic_cas(&hvac_io_read_busy, 0, 1)) {
+        return;    /* odczyt już trwa */
+    }
+
+    hvac_io_read_start_cyc = k_cycle_get_32();
+
+    int ret = hvac_io_backend->start_read();
+    if (ret < 0) {
+        hvac_io_ai_frame_done(NULL, ret);
+    }
+}
+
+void hvac_io_ai_frame_done(const float ai_v[HVAC_NUM_AI_CHANNELS], int result)
+{
+    uint32_t cyc = k_cycle_get_32() - hvac_io_read_start_cyc;
+
+    k_spinlock_key_t key = k_spin_lock(&hvac_io_lock);
+
+    if (result == 0 && ai_v != NULL) {
+        memcpy(hvac_io_img.ai_v, ai_v, sizeof(hvac_io_img.ai_v));
+        hvac_io_img.frame++;
+        hvac_io_img.ai_ts_ticks = k_uptime_ticks();
+#if defined(CONFIG_HVAC_IO_REGS)
+        hvac_io_regs_put(HVAC_IO_REG_AI, ai_v, HVAC_NUM_AI_CHANNELS);
+        sys_put_be32(hvac_io_img.frame, &hvac_io_regs[HVAC_IO_REG_FRAME * 2]);
+#endif
+    }
+
+    k_spin_unlock(&hvac_io_lock, key);
+
+    hvac_io_read_us = (uint32_t)k_cyc_to_us_floor32(cyc);
+    hvac_io_read_result = result;
+
+    atomic_clear(&hvac_io_read_busy);
+    k_sem_give(&hvac_io_frame_sem);
+}
+
+static void hvac_io_prefetch_fn(struct k_timer *timer)
+{
+    ARG_UNUSED(timer);
+    hvac_io_start_read();
+}
+
+int hvac_io_init(void)
+{
+#if defined(CONFIG_HVAC_IO_BACKEND_SPI)
+    hvac_io_backend = &hvac_io_backend_spi;
+#elif defined(CONFIG_HVAC_IO_BACKEND_SIM)
+    hvac_io_backend = &hvac_io_backend_sim;
+#else
+    hvac_io_backend = &hvac_io_backend_none;
+#endif
+
+    if (hvac_io_backend->init) {
+        int ret = hvac_io_backend->init();
+        if (ret < 0) {
+            LOG_ERR("I/O backend %s init failed: %d", hvac_io_backend->name, ret);
+            hvac_io_backend = &hvac_io_backend_none;
+        }
+    }
+
+    k_timer_init(&hvac_io_prefetch_timer, hvac_io_prefetch_fn, NULL);
+
+    LOG_INF("I/O backend: %s", hvac_io_backend->name);
+    return 0;
+}
+
+int hvac_io_cycle_begin(k_timeout_t timeout)
+{
+    /* pierwszy cykl albo spóźniony prefetch - odczyt na żądanie */
+    if (k_sem_count_get(&hvac_io_frame_sem) == 0) {
+        k_timer_stop(&hvac_io_prefetch_timer);
+        hvac_io_start_read();
+    }
+
+    int ret = k_sem_take(&hvac_io_frame_sem, timeout);
+    if (ret < 0) {
+        return ret;
+    }
+
+    return hvac_io_read_result;
+}
+
+void hvac_io_cycle_end(uint32_t next_cycle_us)
+{
+    float ao_v[HVAC_NUM_AO_CHANNELS];
+
+    k_spinlock_key_t key = k_spin_lock(&hvac_io_lock);
+    memcpy(ao_v, hvac_io_ao_staged, sizeof(ao_v));
+    if (hvac_io_img.ao_forced != 0) {
+        int64_t now = k_uptime_get();
+
+        for (int ch = 0; ch < HVAC_NUM_AO_CHANNELS; ch++) {
+            if (!(hvac_io_img.ao_forced & BIT(ch))) {
+                continue;
+            }
+            if (now >= hvac_io_force_until[ch]) {
+                hvac_io_img.ao_forced &= ~BIT(ch);
+            } else {
+                ao_v[ch] = hvac_io_force_v[ch];
+            }
+        }
+    }
+    memcpy(hvac_io_img.ao_v, ao_v, sizeof(ao_v));
+#if defined(CONFIG_HVAC_IO_REGS)
+    hvac_io_regs_put(HVAC_IO_REG_AO, ao_v, HVAC_NUM_AO_CHANNELS);
+#endif
+    k_spin_unlock(&hvac_io_lock, key);
+
+    /* DAC i ADC są na osobnych magistralach - zapis nie blokuje odczytu */
+    hvac_io_backend->write(ao_v);
+
+    uint32_t lead_us = hvac_io_read_us + CONFIG_HVAC_IO_PREFETCH_MARGIN_US;
+    uint32_t delay_us = (next_cycle_us > lead_us) ? (next_cycle_us - lead_us) : 0;
+
+    if (delay_us == 0) {
+        hvac_io_start_read();
+    } else {
+        k_timer_start(&hvac_io_prefetch_timer, K_USEC(delay_us), K_NO_WAIT);
+    }
+}
+
+float hvac_io_ai_voltage(int ch)
+{
+    if (ch < 0 || ch >= HVAC_NUM_AI_INPUTS) {
+        return 0.0f;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&hvac_io_lock);
+#if HVAC_NUM_EXT_CHANNELS > 0
+    float v;
+
+    if (ch < HVAC_NUM_AI_CHANNELS) {
+        v = hvac_io_img.ai_v[ch];
+    } else if (hvac_io_img.ext_valid & BIT(ch - HVAC_NUM_AI_CHANNELS)) {
+        v = hvac_io_img.ext_v[ch - HVAC_NUM_AI_CHANNELS];
+    } else {
+        v = NAN;                /* ostatni odczyt nieudany - nie podajemy starej wartości */
+    }
+#else
+    float v = hvac_io_img.ai_v[ch];
+#endif
+    k_spin_unlock(&hvac_io_lock, key);
+
+    return v;
+}
+
+float hvac_io_ao_voltage(int ch)
+{
+    if (ch < 0 || ch >= HVAC_NUM_AO_CHANNELS) {
+        return 0.0f;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&hvac_io_lock);
+    float v = hvac_io_img.ao_v[ch];
+    k_spin_unlock(&hvac_io_lock, key);
+
+    return v;
+}
+
+void hvac_io_set_ao_voltage(int ch, float voltage)
+{
+    if (ch < 0 || ch >= HVAC_NUM_AO_CHANNELS) {
+        return;
+    }
+
+    if (voltage < 0.0f)  voltage = 0.0f;
+    if (voltage > 10.0f) voltage = 10.0f;
+
+    k_spinlock_key_t key = k_spin_lock(&hvac_io_lock);
+    hvac_io_ao_staged[ch] = voltage;
+    k_spin_unlock(&hvac_io_lock, key);
+}
+
+void hvac_io_snapshot(struct hvac_io_image *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&hvac_io_lock);
+    *out = hvac_io_img;
+    k_spin_unlock(&hvac_io_lock, key);
+}
+
+int hvac_io_force_ao(int ch, float voltage, uint32_t timeout_ms)
+{
+    if (ch < 0 || ch >= HVAC_NUM_AO_CHANNELS || timeout_ms == 0) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&hvac_io_lock);
+    hvac_io_force_v[ch]     = CLAMP(voltage, 0.0f, 10.0f);
+    hvac_io_force_until[ch] = k_uptime_get() + timeout_ms;
+    hvac_io_img.ao_forced  |= BIT(ch);
+    k_spin_unlock(&hvac_io_lock, key);
+
+    return 0;
+}
+
+void hvac_io_release_ao(int ch)
+{
+    k_spinlock_key_t key = k_spin_lock(&hvac_io_lock);
+    if (ch < 0) {
+        hvac_io_img.ao_forced = 0;
+    } else if (ch < HVAC_NUM_AO_CHANNELS) {
+        hvac_io_img.ao_forced &= ~BIT(ch);
+    }
+    k_spin_unlock(&hvac_io_lock, key);
+}
+
+#if HVAC_NUM_EXT_CHANNELS > 0
+void hvac_io_ext_set(int ch, float value, bool valid)
+{
+    if (ch < 0 || ch >= HVAC_NUM_EXT_CHANNELS) {
+        return;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&hvac_io_lock);
+    if (valid) {
+        hvac_io_img.ext_v[ch] = value;
+        hvac_io_img.ext_valid |= BIT(ch);
+    } else {
+        hvac_io_img.ext_valid &= ~BIT(ch);
+    }
+    k_spin_unlock(&hvac_io_lock, key);
+}
+#endif
+
+#if defined(CONFIG_HVAC_IO_REGS)
+int hvac_io_regs_read(uint16_t start, uint16_t count, uint8_t *dst)
+{
+    if ((uint32_t)start + count > HVAC_IO_REG_COUNT) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&hvac_io_lock);
+    memcpy(dst, &hvac_io_regs[start * 2], count * 2);
+    k_spin_unlock(&hvac_io_lock, key);
+
+    return 0;
+}
+#endif
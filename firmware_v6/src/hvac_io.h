@@ -0,0 +1,90 @@
+#ifndef HVAC_IO_H
+#define HVAC_IO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+#define HVAC_NUM_AI_CHANNELS 8
+#define HVAC_NUM_AO_CHANNELS 8
+
+/* wejścia z magistrali (Modbus master) za lokalnymi AI */
+#if defined(CONFIG_HVAC_IO_EXT_CHANNELS)
+#define HVAC_NUM_EXT_CHANNELS CONFIG_HVAC_IO_EXT_CHANNELS
+#else
+#define HVAC_NUM_EXT_CHANNELS 0
+#endif
+
+/* zakres numerów wejść w io.*_ai */
+#define HVAC_NUM_AI_INPUTS (HVAC_NUM_AI_CHANNELS + HVAC_NUM_EXT_CHANNELS)
+
+/* liniowy model czujnika temperatury: 1 V = 5 C */
+#define HVAC_TEMP_C_PER_VOLT 5.0f
+
+/*
+ * Obraz procesu: ostatnia ramka wejść i ostatnio wysłana ramka wyjść.
+ * UI i inne moduły czytają wyłącznie obraz, nigdy magistralę.
+ */
+struct hvac_io_image {
+    float    ai_v[HVAC_NUM_AI_CHANNELS];
+    float    ao_v[HVAC_NUM_AO_CHANNELS];
+    uint32_t frame;           /* licznik ramek wejść */
+    int64_t  ai_ts_ticks;     /* koniec odczytu ramki wejść (k_uptime_ticks) */
+#if HVAC_NUM_EXT_CHANNELS > 0
+    float    ext_v[HVAC_NUM_EXT_CHANNELS];  /* w jednostkach AI, po skalowaniu */
+    uint32_t ext_valid;       /* bit n = ext_v[n] z ostatniego udanego odczytu */
+#endif
+    uint32_t ao_forced;       /* bit n = ao_v[n] wymuszone (hvac_io_force_ao) */
+};
+
+int   hvac_io_init(void);
+
+/*
+ * Cykl regulacji:
+ *   hvac_io_cycle_begin()  - czeka na ramkę wejść (zwykle już gotową, bo
+ *                            odczyt wystartował przed początkiem cyklu),
+ *   hvac_io_set_ao_voltage() ...,
+ *   hvac_io_cycle_end()    - wysyła ramkę wyjść i planuje odczyt kolejnej
+ *                            ramki wejść tak, żeby skończył się tuż przed
+ *                            następnym cyklem.
+ */
+int   hvac_io_cycle_begin(k_timeout_t timeout);
+void  hvac_io_cycle_end(uint32_t next_cycle_us);
+
+/* ch < HVAC_NUM_AI_INPUTS; kanał zewnętrzny bez ważnego odczytu (ext_valid) zwraca NAN */
+float hvac_io_ai_voltage(int ch);
+float hvac_io_ao_voltage(int ch);
+void  hvac_io_set_ao_voltage(int ch, float voltage);
+
+void  hvac_io_snapshot(struct hvac_io_image *out);
+
+/*
+ * Wymuszenie wyjścia (serwis): przez timeout_ms ramki wyjść niosą voltage
+ * zamiast wartości regulatora, potem kanał sam wraca do regulacji.
+ * Bez wymuszeń bezterminowych - timeout_ms == 0 to -EINVAL.
+ */
+int   hvac_io_force_ao(int ch, float voltage, uint32_t timeout_ms);
+/* ch < 0 - wszystkie kanały */
+void  hvac_io_release_ao(int ch);
+
+#if HVAC_NUM_EXT_CHANNELS > 0
+/* wątek magistrali: ch liczony od 0 (wejście HVAC_NUM_AI_CHANNELS + ch) */
+void  hvac_io_ext_set(int ch, float value, bool valid);
+#endif
+
+#if defined(CONFIG_HVAC_IO_REGS)
+/*
+ * Obraz procesu jako słowa 16-bit big-endian (rejestry wejściowe Modbus),
+ * aktualizowany razem z obrazem - odczyt bloku to jeden memcpy:
+ *   AI [mV], AO [mV], licznik ramek (starsze, młodsze słowo)
+ */
+#define HVAC_IO_REG_AI     0
+#define HVAC_IO_REG_AO     (HVAC_IO_REG_AI + HVAC_NUM_AI_CHANNELS)
+#define HVAC_IO_REG_FRAME  (HVAC_IO_REG_AO + HVAC_NUM_AO_CHANNELS)
+#define HVAC_IO_REG_COUNT  (HVAC_IO_REG_FRAME + 2)
+
+/* count słów od start do dst; -EINVAL poza obrazem */
+int   hvac_io_regs_read(uint16_t start, uint16_t count, uint8_t *dst);
+#endif
+
+#endif /* HVAC_IO_H */
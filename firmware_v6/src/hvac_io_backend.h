@@ -0,0 +1,25 @@
+#ifndef HVAC_IO_BACKEND_H
+#define HVAC_IO_BACKEND_H
+
+#include "hvac_io.h"
+
+/* Interfejs sprzętowej (albo symulowanej) strony obrazu procesu. */
+struct hvac_io_backend {
+    const char *name;
+    int  (*init)(void);
+    /* startuje odczyt ramki wejść, koniec zgłaszany przez hvac_io_ai_frame_done() */
+    int  (*start_read)(void);
+    void (*write)(const float ao_v[HVAC_NUM_AO_CHANNELS]);
+};
+
+#if defined(CONFIG_HVAC_IO_BACKEND_SPI)
+extern const struct hvac_io_backend hvac_io_backend_spi;
+#endif
+#if defined(CONFIG_HVAC_IO_BACKEND_SIM)
+extern const struct hvac_io_backend hvac_io_backend_sim;
+#endif
+
+/* Może być wołane z ISR, wątku magistrali albo synchronicznie z start_read(). */
+void hvac_io_ai_frame_done(const float ai_v[HVAC_NUM_AI_CHANNELS], int result);
+
+#endif /* HVAC_IO_BACKEND_H */
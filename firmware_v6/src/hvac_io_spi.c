@@ -0,0 +1,215 @@
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+
+#include "hvac_io.h"
+#include "hvac_io_backend.h"
+#include "hvac_spi_sched.h"
+
+LOG_MODULE_REGISTER(hvac_io_spi, CONFIG_LOG_DEFAULT_LEVEL);
+
+/* ADS8688 i DAC7568: SPI mode 1, MSB first, ramki 32-bitowe */
+#define HVAC_SPI_OP (SPI_OP_MODE_MASTER | SPI_WORD_SET(8) | SPI_TRANSFER_MSB | SPI_MODE_CPHA)
+
+static const struct spi_dt_spec hvac_adc_spec =
+    SPI_DT_SPEC_GET(DT_NODELABEL(hvac_adc), HVAC_SPI_OP, 0);
+static const struct spi_dt_spec hvac_dac_spec =
+    SPI_DT_SPEC_GET(DT_NODELABEL(hvac_dac), HVAC_SPI_OP, 0);
+
+#define HVAC_FRAME_LEN 4
+
+/* --- ADS8688 --- */
+
+#define ADS8688_CMD_NO_OP       0x0000
+#define ADS8688_CMD_AUTO_RST    0xA000
+#define ADS8688_REG_AUTO_SEQ_EN 0x01
+#define ADS8688_REG_RANGE_CH0   0x05
+#define ADS8688_RANGE_0_2V5REF  0x05      /* 0 .. 2.5 x VREF = 0 .. 10.24 V */
+
+/* AUTO_RST + 8x NO_OP; wynik kanału n przychodzi w ramce n+1 */
+#define ADS8688_READ_FRAMES (HVAC_NUM_AI_CHANNELS + 1)
+
+static uint8_t adc_tx_data[ADS8688_READ_FRAMES][HVAC_FRAME_LEN];
+static uint8_t adc_rx_data[ADS8688_READ_FRAMES][HVAC_FRAME_LEN];
+static struct spi_buf     adc_tx_buf[ADS8688_READ_FRAMES];
+static struct spi_buf     adc_rx_buf[ADS8688_READ_FRAMES];
+static struct spi_buf_set adc_tx_set[ADS8688_READ_FRAMES];
+static struct spi_buf_set adc_rx_set[ADS8688_READ_FRAMES];
+static struct hvac_spi_xfer adc_xfer;
+
+/* --- DAC7568 --- */
+
+#define DAC7568_CTRL_WRITE          0x0   /* zapis do rejestru wejściowego */
+#define DAC7568_CTRL_WRITE_UPD_ALL  0x2   /* zapis + aktualizacja wszystkich kanałów */
+#define DAC7568_INT_REF_ON          0x08000001u
+
+static uint8_t dac_tx_data[HVAC_NUM_AO_CHANNELS][HVAC_FRAME_LEN];
+static struct spi_buf     dac_tx_buf[HVAC_NUM_AO_CHANNELS];
+static struct spi_buf_set dac_tx_set[HVAC_NUM_AO_CHANNELS];
+static struct hvac_spi_xfer dac_xfer;
+
+static atomic_t dac_busy;
+static atomic_t dac_dirty;
+static float    dac_next_v[HVAC_NUM_AO_CHANNELS];
+static struct k_spinlock dac_lock;
+
+static int hvac_spi_frame_sync(const struct spi_dt_spec *spec, uint32_t word, uint8_t rx[4])
+{
+    uint8_t tx[HVAC_FRAME_LEN];
+    sys_put_be32(word, tx);
+
+    const struct spi_buf tx_buf = { .buf = tx, .len = sizeof(tx) };
+    const struct spi_buf rx_buf = { .buf = rx, .len = HVAC_FRAME_LEN };
+    const struct spi_buf_set tx_set = { .buffers = &tx_buf, .count = 1 };
+    const struct spi_buf_set rx_set = { .buffers = &rx_buf, .count = 1 };
+
+    return spi_transceive_dt(spec, &tx_set, rx ? &rx_set : NULL);
+}
+
+static int ads8688_write_reg(uint8_t reg, uint8_t val)
+{
+    uint32_t cmd = ((uint32_t)reg << 9) | BIT(8) | val;
+    return hvac_spi_frame_sync(&hvac_adc_spec, cmd << 16, NULL);
+}
+
+static void hvac_adc_done(struct hvac_spi_xfer *xfer)
+{
+    float ai_v[HVAC_NUM_AI_CHANNELS];
+
+    for (int ch = 0; ch < HVAC_NUM_AI_CHANNELS; ch++) {
+        uint16_t code = sys_get_be16(&adc_rx_data[ch + 1][2]);
+        ai_v[ch] = (float)code * (CONFIG_HVAC_IO_AI_FULL_SCALE_MV / 1000.0f) / 65536.0f;
+    }
+
+    hvac_io_ai_frame_done(ai_v, xfer->result);
+}
+
+static void hvac_dac_encode(const float ao_v[HVAC_NUM_AO_CHANNELS])
+{
+    for (int ch = 0; ch < HVAC_NUM_AO_CHANNELS; ch++) {
+        float rel = ao_v[ch] * 1000.0f / CONFIG_HVAC_IO_AO_FULL_SCALE_MV;
+        if (rel < 0.0f) rel = 0.0f;
+        if (rel > 1.0f) rel = 1.0f;
+
+        uint32_t code = (uint32_t)(rel * 4095.0f + 0.5f);
+        /* ostatni kanał przeładowuje wszystkie wyjścia naraz */
+        uint32_t ctrl = (ch == HVAC_NUM_AO_CHANNELS - 1) ?
+                        DAC7568_CTRL_WRITE_UPD_ALL : DAC7568_CTRL_WRITE;
+
+        sys_put_be32((ctrl << 24) | ((uint32_t)ch << 20) | (code << 8),
+                     dac_tx_data[ch]);
+    }
+}
+
+static void hvac_dac_submit(void)
+{
+    float ao_v[HVAC_NUM_AO_CHANNELS];
+
+    k_spinlock_key_t key = k_spin_lock(&dac_lock);
+    memcpy(ao_v, dac_next_v, sizeof(ao_v));
+    atomic_clear(&dac_dirty);
+    k_spin_unlock(&dac_lock, key);
+
+    hvac_dac_encode(ao_v);
+
+    if (hvac_spi_submit(HVAC_SPI_BUS_DAC, &dac_xfer) < 0) {
+        atomic_clear(&dac_busy);
+    }
+}
+
+static void hvac_dac_done(struct hvac_spi_xfer *xfer)
+{
+    ARG_UNUSED(xfer);
+
+    atomic_clear(&dac_busy);
+
+    /* w trakcie zapisu przyszła nowsza ramka - wysyłamy tylko najnowszą */
+    if (atomic_get(&dac_dirty) && atomic_cas(&dac_busy, 0, 1)) {
+        hvac_dac_submit();
+    }
+}
+
+static int hvac_io_spi_init(void)
+{
+    if (!spi_is_ready_dt(&hvac_adc_spec) || !spi_is_ready_dt(&hvac_dac_spec)) {
+        LOG_ERR("ADC/DAC SPI bus not ready");
+        return -ENODEV;
+    }
+
+    int ret = ads8688_write_reg(ADS8688_REG_AUTO_SEQ_EN, 0xFF);
+    for (int ch = 0; ret == 0 && ch < HVAC_NUM_AI_CHANNELS; ch++) {
+        ret = ads8688_write_reg(ADS8688_REG_RANGE_CH0 + ch, ADS8688_RANGE_0_2V5REF);
+    }
+    if (ret < 0) {
+        LOG_ERR("ADS8688 setup failed: %d", ret);
+        return ret;
+    }
+
+    ret = hvac_spi_frame_sync(&hvac_dac_spec, DAC7568_INT_REF_ON, NULL);
+    if (ret < 0) {
+        LOG_ERR("DAC7568 setup failed: %d", ret);
+        return ret;
+    }
+
+    for (int i = 0; i < ADS8688_READ_FRAMES; i++) {
+        uint16_t cmd = (i == 0) ? ADS8688_CMD_AUTO_RST : ADS8688_CMD_NO_OP;
+        sys_put_be32((uint32_t)cmd << 16, adc_tx_data[i]);
+
+        adc_tx_buf[i] = (struct spi_buf){ .buf = adc_tx_data[i], .len = HVAC_FRAME_LEN };
+        adc_rx_buf[i] = (struct spi_buf){ .buf = adc_rx_data[i], .len = HVAC_FRAME_LEN };
+        adc_tx_set[i] = (struct spi_buf_set){ .buffers = &adc_tx_buf[i], .count = 1 };
+        adc_rx_set[i] = (struct spi_buf_set){ .buffers = &adc_rx_buf[i], .count = 1 };
+    }
+
+    adc_xfer = (struct hvac_spi_xfer){
+        .spec  = &hvac_adc_spec,
+        .tx    = adc_tx_set,
+        .rx    = adc_rx_set,
+        .count = ADS8688_READ_FRAMES,
+        .done  = hvac_adc_done,
+    };
+
+    for (int ch = 0; ch < HVAC_NUM_AO_CHANNELS; ch++) {
+        dac_tx_buf[ch] = (struct spi_buf){ .buf = dac_tx_data[ch], .len = HVAC_FRAME_LEN };
+        dac_tx_set[ch] = (struct spi_buf_set){ .buffers = &dac_tx_buf[ch], .count = 1 };
+    }
+
+    dac_xfer = (struct hvac_spi_xfer){
+        .spec  = &hvac_dac_spec,
+        .tx    = dac_tx_set,
+        .rx    = NULL,
+        .count = HVAC_NUM_AO_CHANNELS,
+        .done  = hvac_dac_done,
+    };
+
+    return hvac_spi_sched_init();
+}
+
+static int hvac_io_spi_start_read(void)
+{
+    return hvac_spi_submit(HVAC_SPI_BUS_ADC, &adc_xfer);
+}
+
+static void hvac_io_spi_write(const float ao_v[HVAC_NUM_AO_CHANNELS])
+{
+    k_spinlock_key_t key = k_spin_lock(&dac_lock);
+    memcpy(dac_next_v, ao_v, sizeof(dac_next_v));
+    atomic_set(&dac_dirty, 1);
+    k_spin_unlock(&dac_lock, key);
+
+    if (atomic_cas(&dac_busy, 0, 1)) {
+        hvac_dac_submit();
+    }
+}
+
+const struct hvac_io_backend hvac_io_backend_spi = {
+    .name       = "ads8688+dac7568",
+    .init       = hvac_io_spi_init,
+    .start_read = hvac_io_spi_start_read,
+    .write      = hvac_io_spi_write,
+};
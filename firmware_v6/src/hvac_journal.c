@@ -0,0 +1,275 @@
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/crc.h>
+#include <errno.h>
+#include <stddef.h>
+
+#include "hvac_journal.h"
+
+LOG_MODULE_REGISTER(hvac_journal, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define HVAC_JOURNAL_REC   sizeof(struct hvac_journal_rec)
+#define HVAC_JOURNAL_EMPTY 0xffffffffU
+
+BUILD_ASSERT(sizeof(struct hvac_journal_rec) == 16, "record layout changed");
+
+/* rekord przed nadaniem numeru - tyle idzie przez kolejkę */
+struct hvac_journal_ev {
+    uint32_t t_s;
+    uint16_t code;
+    uint8_t  channel;
+    int32_t  value;
+};
+
+K_MSGQ_DEFINE(hvac_journal_q, sizeof(struct hvac_journal_ev),
+              CONFIG_HVAC_JOURNAL_QUEUE_LEN, 4);
+
+static const struct flash_area *hvac_journal_fa;
+static uint32_t hvac_journal_slots;
+static uint32_t hvac_journal_per_sector;
+static uint32_t hvac_journal_sector;
+static atomic_t hvac_journal_next;
+static atomic_t hvac_journal_lost;
+
+static const char *const hvac_journal_names[HVAC_EV_COUNT] = {
+    [HVAC_EV_BOOT]          = "Boot",
+    [HVAC_EV_IO_FRAME_LATE] = "I/O frame late",
+    [HVAC_EV_CFG_APPLIED]   = "Config applied",
+    [HVAC_EV_SD_MOUNTED]    = "SD inserted",
+    [HVAC_EV_SD_REMOVED]    = "SD removed",
+    [HVAC_EV_LOG_FAILED]    = "Log write failed",
+};
+
+/* --- Pierścień --- */
+
+/* jedna suma liczona dalej przez pola przed i za crc8 */
+static uint8_t hvac_journal_crc(const struct hvac_journal_rec *r)
+{
+    uint8_t crc = crc8_ccitt(0xff, r, offsetof(struct hvac_journal_rec, crc8));
+
+    return crc8_ccitt(crc, &r->value, sizeof(r->value));
+}
+
+/* rekord o numerze seq albo -ENOENT, gdy slot zawiera coś innego */
+static int hvac_journal_get(uint32_t seq, struct hvac_journal_rec *r)
+{
+    off_t off = (off_t)(seq % hvac_journal_slots) * HVAC_JOURNAL_REC;
+    int ret = flash_area_read(hvac_journal_fa, off, r, sizeof(*r));
+
+    if (ret < 0) {
+        return ret;
+    }
+    if (r->seq != seq || r->crc8 != hvac_journal_crc(r)) {
+        return -ENOENT;
+    }
+    return 0;
+}
+
+static bool hvac_journal_erased(uint32_t slot)
+{
+    uint32_t w[HVAC_JOURNAL_REC / 4];
+
+    if (flash_area_read(hvac_journal_fa, slot * HVAC_JOURNAL_REC, w, sizeof(w)) < 0) {
+        return false;
+    }
+    for (size_t i = 0; i < ARRAY_SIZE(w); i++) {
+        if (w[i] != HVAC_JOURNAL_EMPTY) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Po starcie: pierwszy rekord każdego sektora wskazuje sektor z
+ * najnowszymi wpisami, w nim wyszukiwanie binarne pierwszego pustego
+ * slotu. Rekord przerwany zanikiem zasilania nie jest pusty, więc
+ * zostaje pominięty, a nie nadpisany.
+ */
+static uint32_t hvac_journal_find_head(void)
+{
+    uint32_t best = HVAC_JOURNAL_EMPTY;
+    uint32_t base = 0;
+
+    for (uint32_t s = 0; s < hvac_journal_slots / hvac_journal_per_sector; s++) {
+        struct hvac_journal_rec r;
+        uint32_t slot = s * hvac_journal_per_sector;
+
+        if (flash_area_read(hvac_journal_fa, slot * HVAC_JOURNAL_REC, &r, sizeof(r)) < 0 ||
+            r.seq == HVAC_JOURNAL_EMPTY || r.crc8 != hvac_journal_crc(&r) ||
+            r.seq % hvac_journal_slots != slot) {
+            continue;
+        }
+        if (best == HVAC_JOURNAL_EMPTY || r.seq > best) {
+            best = r.seq;
+            base = slot;
+        }
+    }
+
+    if (best == HVAC_JOURNAL_EMPTY) {
+        return 0;
+    }
+
+    uint32_t lo = 1;
+    uint32_t hi = hvac_journal_per_sector;
+
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+
+        if (hvac_journal_erased(base + mid)) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+
+    return best + lo;
+}
+
+static int hvac_journal_write(const struct hvac_journal_ev *ev)
+{
+    uint32_t seq = (uint32_t)atomic_get(&hvac_journal_next);
+    uint32_t slot = seq % hvac_journal_slots;
+    struct hvac_journal_rec r = {
+        .seq     = seq,
+        .t_s     = ev->t_s,
+        .code    = ev->code,
+        .channel = ev->channel,
+        .value   = ev->value,
+    };
+    int ret;
+
+    /* wejście w sektor - kasowanie zabiera najstarsze wpisy */
+    if (slot % hvac_journal_per_sector == 0) {
+        ret = flash_area_erase(hvac_journal_fa, slot * HVAC_JOURNAL_REC, hvac_journal_sector);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    r.crc8 = hvac_journal_crc(&r);
+
+    ret = flash_area_write(hvac_journal_fa, slot * HVAC_JOURNAL_REC, &r, sizeof(r));
+
+    /* slot zużyty także po błędzie - nie da się go zapisać drugi raz */
+    atomic_set(&hvac_journal_next, seq + 1);
+    return ret;
+}
+
+/* --- Wątek zapisu --- */
+
+static void hvac_journal_thread(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    struct hvac_journal_ev ev;
+
+    while (1) {
+        (void)k_msgq_get(&hvac_journal_q, &ev, K_FOREVER);
+
+        int ret = hvac_journal_write(&ev);
+        if (ret < 0) {
+            LOG_ERR("Journal write failed: %d", ret);
+        }
+    }
+}
+
+K_THREAD_DEFINE(hvac_journal_thread_id, CONFIG_HVAC_JOURNAL_STACK_SIZE,
+                hvac_journal_thread, NULL, NULL, NULL,
+                CONFIG_HVAC_JOURNAL_PRIORITY, 0, SYS_FOREVER_MS);  /* startuje hvac_journal_init() */
+
+/* --- API --- */
+
+int hvac_journal_init(void)
+{
+    struct flash_pages_info info;
+    int ret;
+
+    ret = flash_area_open(FIXED_PARTITION_ID(hvac_journal_partition), &hvac_journal_fa);
+    if (ret < 0) {
+        LOG_ERR("Journal partition open failed: %d", ret);
+        return ret;
+    }
+
+    ret = flash_get_page_info_by_offs(flash_area_get_device(hvac_journal_fa),
+                                      hvac_journal_fa->fa_off, &info);
+    if (ret < 0) {
+        return ret;
+    }
+
+    hvac_journal_sector     = info.size;
+    hvac_journal_per_sector = info.size / HVAC_JOURNAL_REC;
+    hvac_journal_slots      = (hvac_journal_fa->fa_size / info.size) * hvac_journal_per_sector;
+
+    /* co najmniej dwa sektory - kasowany nie zabiera wszystkiego */
+    if (hvac_journal_slots < 2 * hvac_journal_per_sector) {
+        LOG_ERR("Journal partition too small");
+        return -ENOSPC;
+    }
+
+    uint32_t head = hvac_journal_find_head();
+
+    atomic_set(&hvac_journal_next, head);
+    LOG_INF("Journal: %u slots, next record %u", hvac_journal_slots, head);
+
+    k_thread_start(hvac_journal_thread_id);
+
+    hvac_journal_add(HVAC_EV_BOOT, 0, 0);
+    return 0;
+}
+
+void hvac_journal_add(uint16_t code, uint8_t channel, int32_t value)
+{
+    struct hvac_journal_ev ev = {
+        .t_s     = (uint32_t)(k_uptime_get() / MSEC_PER_SEC),
+        .code    = code,
+        .channel = channel,
+        .value   = value,
+    };
+
+    if (k_msgq_put(&hvac_journal_q, &ev, K_NO_WAIT) != 0) {
+        atomic_inc(&hvac_journal_lost);
+    }
+}
+
+uint32_t hvac_journal_head(void)
+{
+    return (uint32_t)atomic_get(&hvac_journal_next);
+}
+
+int hvac_journal_read(uint32_t before, struct hvac_journal_rec *out, int max)
+{
+    int n = 0;
+
+    if (hvac_journal_fa == NULL) {
+        return -ENODEV;
+    }
+
+    /* starsze niż jedno okrążenie już nadpisane */
+    while (n < max && before > 0 && hvac_journal_head() - (before - 1) <= hvac_journal_slots) {
+        if (hvac_journal_get(before - 1, &out[n]) != 0) {
+            break;
+        }
+        n++;
+        before--;
+    }
+
+    return n;
+}
+
+uint32_t hvac_journal_dropped(void)
+{
+    return (uint32_t)atomic_get(&hvac_journal_lost);
+}
+
+const char *hvac_journal_code_name(uint16_t code)
+{
+    if (code < HVAC_EV_COUNT && hvac_journal_names[code] != NULL) {
+        return hvac_journal_names[code];
+    }
+    return "?";
+}
@@ -0,0 +1,56 @@
+#ifndef HVAC_JOURNAL_H
+#define HVAC_JOURNAL_H
+
+#include <stdint.h>
+
+/*
+ * Dziennik zdarzeń i alarmów w pierścieniu na partycji
+ * hvac_journal_partition. Rekordy mają stały rozmiar, numer kolejny
+ * rekordu wyznacza jego miejsce (slot = seq % liczba slotów), więc
+ * dopisanie i odczyt dowolnego rekordu to O(1). Sektor jest kasowany
+ * przy wejściu w niego - najstarsze wpisy giną po całym sektorze,
+ * a każdy sektor jest kasowany raz na okrążenie.
+ *
+ * hvac_journal_add() tylko wstawia rekord do kolejki (bez blokowania,
+ * także z przerwań); do flasha pisze wątek o niskim priorytecie.
+ */
+
+enum hvac_journal_code {
+    HVAC_EV_BOOT = 1,
+    HVAC_EV_IO_FRAME_LATE,        /* ramka wejść nie zdążyła na cykl */
+    HVAC_EV_CFG_APPLIED,          /* value = maska HVAC_CFG_CH_* */
+    HVAC_EV_SD_MOUNTED,
+    HVAC_EV_SD_REMOVED,
+    HVAC_EV_LOG_FAILED,           /* value = kod błędu */
+    HVAC_EV_COUNT
+};
+
+struct hvac_journal_rec {
+    uint32_t seq;                 /* 0xffffffff = slot skasowany */
+    uint32_t t_s;                 /* czas od startu */
+    uint16_t code;                /* enum hvac_journal_code */
+    uint8_t  channel;
+    uint8_t  crc8;                /* crc8_ccitt pozostałych pól */
+    int32_t  value;
+};
+
+/* odszukanie końca pierścienia i start wątku zapisu */
+int hvac_journal_init(void);
+
+/* z dowolnego kontekstu; przy pełnej kolejce rekord jest gubiony i liczony */
+void hvac_journal_add(uint16_t code, uint8_t channel, int32_t value);
+
+/* numer kolejny następnego rekordu - rekordy zapisane mają seq < head */
+uint32_t hvac_journal_head(void);
+
+/*
+ * Do max rekordów wstecz od before - 1: out[0] najnowszy. Kończy się na
+ * pierwszym brakującym (skasowanym albo przerwanym) rekordzie.
+ */
+int hvac_journal_read(uint32_t before, struct hvac_journal_rec *out, int max);
+
+uint32_t hvac_journal_dropped(void);
+
+const char *hvac_journal_code_name(uint16_t code);
+
+#endif /* HVAC_JOURNAL_H */
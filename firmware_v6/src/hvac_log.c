@@ -0,0 +1,625 @@
+#include <zephyr/kernel.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "hvac_log.h"
+#if defined(CONFIG_HVAC_LOG_BACKEND_LFS)
+#include "hvac_log_lfs.h"
+#else
+#include "hvac_storage.h"
+#endif
+#if defined(CONFIG_HVAC_JOURNAL)
+#include "hvac_journal.h"
+#endif
+
+LOG_MODULE_REGISTER(hvac_log, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define HVAC_LOG_BUF_SIZE  CONFIG_HVAC_LOG_BUF_SIZE
+#define HVAC_LOG_ROTATE_B  ((uint32_t)CONFIG_HVAC_LOG_ROTATE_KB * 1024U)
+#define HVAC_LOG_INDEX_MAX (HVAC_LOG_ROTATE_B / HVAC_LOG_BUF_SIZE + 1)
+#define HVAC_LOG_NUM_VALS  (HVAC_NUM_AI_CHANNELS + HVAC_NUM_AO_CHANNELS + 3)
+
+/* najdłuższy rekord: delta ze wszystkimi polami i nieregularnym czasem */
+#define HVAC_LOG_ENC_MAX   (1 + 3 + 5 + 5 + HVAC_LOG_NUM_VALS * 3)
+
+BUILD_ASSERT(sizeof(struct hvac_log_hdr) == HVAC_LOG_SECTOR, "header must fill one sector");
+BUILD_ASSERT(sizeof(struct hvac_log_rec) == 48, "record layout changed");
+BUILD_ASSERT(HVAC_LOG_BUF_SIZE % HVAC_LOG_SECTOR == 0, "block must be a sector multiple");
+BUILD_ASSERT(HVAC_LOG_NUM_VALS <= 19, "delta mask bit 19 is the timing flag");
+
+/* --- Stan wspólny producent / pisarz (pod hvac_log_lock) --- */
+
+static uint8_t  hvac_log_buf[2][HVAC_LOG_BUF_SIZE] __aligned(32);
+static size_t   hvac_log_len[2];        /* bajty do zapisu w oddanym bloku */
+static uint64_t hvac_log_t0[2];         /* czas pierwszego rekordu bloku */
+static uint8_t  hvac_log_busy;          /* bit n = blok n czeka na zapis */
+static uint8_t  hvac_log_active;
+static size_t   hvac_log_fill;
+static bool     hvac_log_running;
+static bool     hvac_log_stop_req;
+
+static struct hvac_log_stats hvac_log_st;
+static struct k_spinlock     hvac_log_lock;
+
+/* tylko producent */
+static struct hvac_log_rec hvac_log_prev;
+static uint32_t hvac_log_period_ms;
+
+/* --- Stan pisarza --- */
+
+static struct fs_file_t hvac_log_file;
+static bool     hvac_log_file_open;
+static uint8_t  hvac_log_wr_idx;
+static uint32_t hvac_log_file_no;
+static uint32_t hvac_log_boot_no;       /* 0 = jeszcze nie ustalony w tym starcie */
+static uint32_t hvac_log_file_bytes;
+static bool     hvac_log_unsynced;      /* bloki zapisane od ostatniego fs_sync() */
+static int64_t  hvac_log_file_open_ms;
+static uint64_t hvac_log_index[HVAC_LOG_INDEX_MAX];
+static uint32_t hvac_log_index_count;
+
+static K_SEM_DEFINE(hvac_log_sem, 0, 1);
+static K_SEM_DEFINE(hvac_log_done, 0, 1);
+
+/* --- Kodowanie --- */
+
+static uint16_t hvac_log_mv(float v)
+{
+    float mv = v * 1000.0f;
+
+    if (mv < 0.0f)     mv = 0.0f;
+    if (mv > 65535.0f) mv = 65535.0f;
+    return (uint16_t)(mv + 0.5f);
+}
+
+static int16_t hvac_log_i16(float v)
+{
+    if (v < -32768.0f) v = -32768.0f;
+    if (v > 32767.0f)  v = 32767.0f;
+    return (int16_t)v;
+}
+
+static size_t hvac_log_put_varint(uint8_t *p, uint32_t v)
+{
+    size_t n = 0;
+
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static uint32_t hvac_log_zigzag(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+/* pola wartości w kolejności bitów maski */
+static void hvac_log_vals(const struct hvac_log_rec *r, int32_t *v)
+{
+    int k = 0;
+
+    for (int i = 0; i < HVAC_NUM_AI_CHANNELS; i++) {
+        v[k++] = r->ai_mv[i];
+    }
+    for (int i = 0; i < HVAC_NUM_AO_CHANNELS; i++) {
+        v[k++] = r->ao_mv[i];
+    }
+    v[k++] = r->setpoint_dc;
+    v[k++] = r->u_pct_c;
+    v[k++] = r->i_term_c;
+}
+
+static size_t hvac_log_enc_key(uint8_t *p, const struct hvac_log_rec *r)
+{
+    p[0] = HVAC_LOG_TAG_KEY;
+    memcpy(&p[1], r, sizeof(*r));
+    return 1 + sizeof(*r);
+}
+
+static size_t hvac_log_enc_delta(uint8_t *p, const struct hvac_log_rec *prev,
+                                 const struct hvac_log_rec *r)
+{
+    int32_t a[HVAC_LOG_NUM_VALS];
+    int32_t b[HVAC_LOG_NUM_VALS];
+    uint32_t mask = 0;
+    size_t n = 0;
+
+    hvac_log_vals(prev, a);
+    hvac_log_vals(r, b);
+
+    for (int i = 0; i < HVAC_LOG_NUM_VALS; i++) {
+        if (a[i] != b[i]) {
+            mask |= BIT(i);
+        }
+    }
+
+    uint32_t dt = r->t_ms - prev->t_ms;
+    uint32_t dframe = r->frame - prev->frame;
+
+    if (dt != hvac_log_period_ms || dframe != 1) {
+        mask |= HVAC_LOG_F_TIMING;
+    }
+
+    p[n++] = HVAC_LOG_TAG_DELTA;
+    n += hvac_log_put_varint(&p[n], mask);
+
+    if (mask & HVAC_LOG_F_TIMING) {
+        n += hvac_log_put_varint(&p[n], hvac_log_zigzag((int32_t)(dt - hvac_log_period_ms)));
+        n += hvac_log_put_varint(&p[n], dframe - 1);
+    }
+
+    for (int i = 0; i < HVAC_LOG_NUM_VALS; i++) {
+        if (mask & BIT(i)) {
+            n += hvac_log_put_varint(&p[n], hvac_log_zigzag(b[i] - a[i]));
+        }
+    }
+
+    return n;
+}
+
+/* --- Producent (wątek regulacji) --- */
+
+/* oddaje aktywny blok pisarzowi; wołane pod hvac_log_lock */
+static void hvac_log_handoff(size_t len)
+{
+    hvac_log_len[hvac_log_active] = len;
+    hvac_log_busy |= BIT(hvac_log_active);
+    hvac_log_active ^= 1;
+    hvac_log_fill = 0;
+}
+
+void hvac_log_cycle(int32_t setpoint, float u_pct, float i_term)
+{
+    struct hvac_io_image img;
+    struct hvac_log_rec rec;
+    uint8_t enc[HVAC_LOG_ENC_MAX];
+    size_t n;
+    bool wake = false;
+
+    if (!hvac_log_running) {
+        return;
+    }
+
+    hvac_io_snapshot(&img);
+
+    uint64_t t_ms = k_ticks_to_ms_floor64(img.ai_ts_ticks);
+
+    rec.t_ms  = (uint32_t)t_ms;
+    rec.frame = img.frame;
+    for (int i = 0; i < HVAC_NUM_AI_CHANNELS; i++) {
+        rec.ai_mv[i] = hvac_log_mv(img.ai_v[i]);
+    }
+    for (int i = 0; i < HVAC_NUM_AO_CHANNELS; i++) {
+        rec.ao_mv[i] = hvac_log_mv(img.ao_v[i]);
+    }
+    rec.setpoint_dc = hvac_log_i16(setpoint * 10.0f);
+    rec.u_pct_c     = hvac_log_i16(u_pct * 100.0f);
+    rec.i_term_c    = hvac_log_i16(i_term * 100.0f);
+    rec.reserved    = 0;
+
+    k_spinlock_key_t key = k_spin_lock(&hvac_log_lock);
+
+    if (!hvac_log_running) {
+        k_spin_unlock(&hvac_log_lock, key);
+        return;
+    }
+
+    if (hvac_log_fill > 0) {
+        n = hvac_log_enc_delta(enc, &hvac_log_prev, &rec);
+
+        if (hvac_log_fill + n > HVAC_LOG_BUF_SIZE) {
+            /* rekordy nie przechodzą przez granicę bloku - reszta to wypełnienie */
+            memset(&hvac_log_buf[hvac_log_active][hvac_log_fill], HVAC_LOG_TAG_PAD,
+                   HVAC_LOG_BUF_SIZE - hvac_log_fill);
+            hvac_log_handoff(HVAC_LOG_BUF_SIZE);
+            wake = true;
+        }
+    }
+
+    if (hvac_log_fill == 0) {
+        if (hvac_log_busy & BIT(hvac_log_active)) {
+            hvac_log_st.dropped++;
+            k_spin_unlock(&hvac_log_lock, key);
+            if (wake) {
+                k_sem_give(&hvac_log_sem);
+            }
+            return;
+        }
+
+        /* każdy blok zaczyna się klatką kluczową */
+        n = hvac_log_enc_key(enc, &rec);
+        hvac_log_t0[hvac_log_active] = t_ms;
+    }
+
+    memcpy(&hvac_log_buf[hvac_log_active][hvac_log_fill], enc, n);
+    hvac_log_fill += n;
+    hvac_log_prev = rec;
+
+    hvac_log_st.records++;
+    hvac_log_st.bytes += n;
+
+    if (hvac_log_fill == HVAC_LOG_BUF_SIZE) {
+        hvac_log_handoff(HVAC_LOG_BUF_SIZE);
+        wake = true;
+    }
+
+    k_spin_unlock(&hvac_log_lock, key);
+
+    if (wake) {
+        k_sem_give(&hvac_log_sem);
+    }
+}
+
+/* --- Pliki --- */
+
+static bool hvac_log_store_ready(void)
+{
+#if defined(CONFIG_HVAC_LOG_BACKEND_LFS)
+    return hvac_log_lfs_is_ready();
+#else
+    return hvac_storage_is_ready();
+#endif
+}
+
+/* boot_no najnowszego pliku albo 0, gdy nie ma go albo to starsza wersja */
+static uint32_t hvac_log_file_boot(unsigned int file_no)
+{
+    struct fs_file_t f;
+    struct hvac_log_hdr hdr;
+    char path[sizeof(CONFIG_HVAC_LOG_DIR) + 16];
+    ssize_t n;
+
+    snprintf(path, sizeof(path), "%s/hvac%04u.log", CONFIG_HVAC_LOG_DIR, file_no);
+
+    fs_file_t_init(&f);
+    if (fs_open(&f, path, FS_O_READ) < 0) {
+        return 0;
+    }
+    n = fs_read(&f, &hdr, sizeof(hdr));
+    fs_close(&f);
+
+    if (n != sizeof(hdr) || hdr.magic != HVAC_LOG_MAGIC || hdr.version < 3) {
+        return 0;
+    }
+    return hdr.boot_no;
+}
+
+static int hvac_log_next_index(void)
+{
+    struct fs_dir_t dir;
+    struct fs_dirent ent;
+    unsigned int max = 0;
+
+    fs_dir_t_init(&dir);
+    if (fs_opendir(&dir, CONFIG_HVAC_LOG_DIR) == 0) {
+        while (fs_readdir(&dir, &ent) == 0 && ent.name[0] != '\0') {
+            unsigned int n;
+
+            if (sscanf(ent.name, "hvac%u.log", &n) == 1 && n > max) {
+                max = n;
+            }
+        }
+        fs_closedir(&dir);
+    }
+
+    /*
+     * Pierwszy start po restarcie bierze numer o jeden większy niż
+     * najnowszy plik. Kolejne starty zostają przy swoim, chyba że na
+     * nośniku są pliki z późniejszego uruchomienia (inna karta).
+     */
+    uint32_t last = (max > 0) ? hvac_log_file_boot(max) : 0;
+
+    if (hvac_log_boot_no == 0 || last > hvac_log_boot_no) {
+        hvac_log_boot_no = last + 1;
+    }
+
+    return max + 1;
+}
+
+static int hvac_log_open_file(void)
+{
+    struct hvac_log_hdr hdr = {
+        .magic      = HVAC_LOG_MAGIC,
+        .version    = HVAC_LOG_VERSION,
+        .rec_size   = sizeof(struct hvac_log_rec),
+        .period_ms  = hvac_log_period_ms,
+        .boot_no    = hvac_log_boot_no,
+        .num_ai     = HVAC_NUM_AI_CHANNELS,
+        .num_ao     = HVAC_NUM_AO_CHANNELS,
+        .block_size = HVAC_LOG_BUF_SIZE,
+        .file_no    = hvac_log_file_no,
+        .start_ms   = (uint64_t)k_uptime_get(),
+    };
+    char path[sizeof(CONFIG_HVAC_LOG_DIR) + 16];
+    int ret;
+
+    snprintf(path, sizeof(path), "%s/hvac%04u.log", CONFIG_HVAC_LOG_DIR, hvac_log_file_no);
+
+#if defined(CONFIG_HVAC_LOG_BACKEND_LFS)
+    /* cały plik plus zapas na bloki copy-on-write musi się zmieścić */
+    ret = hvac_log_lfs_reclaim(HVAC_LOG_ROTATE_B + CONFIG_HVAC_LOG_LFS_RESERVE_KB * 1024U);
+    if (ret < 0) {
+        return ret;
+    }
+#endif
+
+    fs_file_t_init(&hvac_log_file);
+    ret = fs_open(&hvac_log_file, path, FS_O_CREATE | FS_O_WRITE);
+    if (ret < 0) {
+        LOG_ERR("Cannot create %s: %d", path, ret);
+        return ret;
+    }
+
+    if (fs_truncate(&hvac_log_file, 0) != 0 ||
+        fs_write(&hvac_log_file, &hdr, sizeof(hdr)) != sizeof(hdr)) {
+        fs_close(&hvac_log_file);
+        return -EIO;
+    }
+
+    hvac_log_file_bytes   = sizeof(hdr);
+    hvac_log_file_open_ms = k_uptime_get();
+    hvac_log_index_count  = 0;
+    hvac_log_st.files++;
+
+    LOG_INF("Logging to %s", path);
+    return 0;
+}
+
+/* indeks bloków i stopka na końcu pliku */
+static int hvac_log_close_file(void)
+{
+    size_t len = hvac_log_index_count * sizeof(hvac_log_index[0]);
+    struct hvac_log_footer ftr = {
+        .magic      = HVAC_LOG_FOOTER_MAGIC,
+        .count      = hvac_log_index_count,
+        .crc32      = crc32_ieee((const uint8_t *)hvac_log_index, len),
+        .block_size = HVAC_LOG_BUF_SIZE,
+    };
+    int ret = 0;
+
+    if (fs_write(&hvac_log_file, hvac_log_index, len) != (ssize_t)len ||
+        fs_write(&hvac_log_file, &ftr, sizeof(ftr)) != sizeof(ftr)) {
+        ret = -EIO;
+    }
+
+    int err = fs_close(&hvac_log_file);
+    hvac_log_file_no++;
+
+    return ret ? ret : err;
+}
+
+static bool hvac_log_rotate_due(void)
+{
+    int64_t open_ms = k_uptime_get() - hvac_log_file_open_ms;
+
+    if (hvac_log_file_bytes + HVAC_LOG_BUF_SIZE > HVAC_LOG_ROTATE_B ||
+        hvac_log_index_count == HVAC_LOG_INDEX_MAX) {
+        return true;
+    }
+
+    /* 32-bitowe t_ms rekordów muszą dać się odwinąć względem start_ms */
+    if (open_ms >= HVAC_LOG_SPAN_MAX_MS) {
+        return true;
+    }
+
+    return CONFIG_HVAC_LOG_ROTATE_MIN > 0 &&
+           open_ms >= CONFIG_HVAC_LOG_ROTATE_MIN * 60000LL;
+}
+
+/* --- Pisarz --- */
+
+static void hvac_log_fail(int err)
+{
+    k_spinlock_key_t key = k_spin_lock(&hvac_log_lock);
+    hvac_log_st.err = err;
+    hvac_log_running = false;
+    k_spin_unlock(&hvac_log_lock, key);
+
+#if defined(CONFIG_HVAC_JOURNAL)
+    hvac_journal_add(HVAC_EV_LOG_FAILED, 0, err);
+#endif
+}
+
+static void hvac_log_drain(void)
+{
+    while (hvac_log_file_open) {
+        k_spinlock_key_t key = k_spin_lock(&hvac_log_lock);
+        bool full = hvac_log_busy & BIT(hvac_log_wr_idx);
+        size_t len = hvac_log_len[hvac_log_wr_idx];
+        uint64_t t0 = hvac_log_t0[hvac_log_wr_idx];
+        k_spin_unlock(&hvac_log_lock, key);
+
+        if (!full) {
+            return;
+        }
+
+        uint32_t c0 = k_cycle_get_32();
+        ssize_t n = fs_write(&hvac_log_file, hvac_log_buf[hvac_log_wr_idx], len);
+        uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - c0);
+
+        key = k_spin_lock(&hvac_log_lock);
+        hvac_log_busy &= ~BIT(hvac_log_wr_idx);
+        if (n == (ssize_t)len) {
+            hvac_log_st.blocks++;
+            hvac_log_st.max_write_us = MAX(hvac_log_st.max_write_us, us);
+        }
+        k_spin_unlock(&hvac_log_lock, key);
+
+        hvac_log_wr_idx ^= 1;
+
+        if (n != (ssize_t)len) {
+            /* karta wyjęta albo pełna - dalsze rekordy nie mają sensu */
+            hvac_log_fail((n < 0) ? (int)n : -ENOSPC);
+            continue;
+        }
+
+        hvac_log_index[hvac_log_index_count++] = t0;
+        hvac_log_file_bytes += len;
+        hvac_log_unsynced = true;
+
+        /* zmiana pliku tylko między blokami - każdy blok zaczyna się klatką kluczową */
+        if (len == HVAC_LOG_BUF_SIZE && hvac_log_running && hvac_log_rotate_due()) {
+            int ret = hvac_log_close_file();
+            if (ret == 0) {
+                ret = hvac_log_open_file();
+            }
+            if (ret != 0) {
+                hvac_log_file_open = false;
+                hvac_log_fail(ret);
+            }
+        }
+    }
+}
+
+static void hvac_log_writer(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    int64_t last_sync_ms = k_uptime_get();
+
+    while (1) {
+        (void)k_sem_take(&hvac_log_sem, K_MSEC(CONFIG_HVAC_LOG_SYNC_MS));
+
+        if (hvac_log_file_open) {
+            hvac_log_drain();
+        }
+
+        /*
+         * fs_sync() aktualizuje rozmiar w katalogu FAT albo zatwierdza plik
+         * LittleFS - po zaniku zasilania ginie najwyżej ostatni okres. Bez
+         * nowych bloków nie ma czego zatwierdzać; w LittleFS każdy sync
+         * kopiuje niepełny blok flasha, więc puste synci to czysty narzut.
+         */
+        int64_t now_ms = k_uptime_get();
+        if (hvac_log_file_open && hvac_log_unsynced &&
+            now_ms - last_sync_ms >= CONFIG_HVAC_LOG_SYNC_MS) {
+            if (fs_sync(&hvac_log_file) == 0) {
+                hvac_log_st.syncs++;
+            }
+            hvac_log_unsynced = false;
+            last_sync_ms = now_ms;
+        }
+
+        k_spinlock_key_t key = k_spin_lock(&hvac_log_lock);
+        bool stop = (hvac_log_stop_req || !hvac_log_running) && hvac_log_busy == 0;
+        bool req = hvac_log_stop_req;
+        k_spin_unlock(&hvac_log_lock, key);
+
+        if (!stop) {
+            continue;
+        }
+
+        if (hvac_log_file_open) {
+            int ret = hvac_log_close_file();
+            hvac_log_file_open = false;
+            if (ret != 0 && hvac_log_st.err == 0) {
+                hvac_log_st.err = ret;
+            }
+            if (hvac_log_st.err != 0) {
+                LOG_ERR("Log write failed: %d", hvac_log_st.err);
+            }
+        }
+        if (req) {
+            hvac_log_stop_req = false;
+            k_sem_give(&hvac_log_done);
+        }
+    }
+}
+
+K_THREAD_DEFINE(hvac_log_writer_id, CONFIG_HVAC_LOG_STACK_SIZE,
+                hvac_log_writer, NULL, NULL, NULL,
+                CONFIG_HVAC_LOG_PRIORITY, 0, 0);
+
+/* --- Start / stop --- */
+
+int hvac_log_start(uint32_t period_ms)
+{
+    int ret;
+
+    if (hvac_log_running || hvac_log_file_open) {
+        return -EALREADY;
+    }
+    if (!hvac_log_store_ready()) {
+        return -ENODEV;
+    }
+
+    ret = fs_mkdir(CONFIG_HVAC_LOG_DIR);
+    if (ret != 0 && ret != -EEXIST) {
+        LOG_ERR("Cannot create %s: %d", CONFIG_HVAC_LOG_DIR, ret);
+        return ret;
+    }
+
+    memset(&hvac_log_st, 0, sizeof(hvac_log_st));
+    hvac_log_period_ms = period_ms;
+    hvac_log_file_no   = hvac_log_next_index();
+
+    ret = hvac_log_open_file();
+    if (ret != 0) {
+        return ret;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&hvac_log_lock);
+    hvac_log_busy      = 0;
+    hvac_log_active    = 0;
+    hvac_log_fill      = 0;
+    hvac_log_wr_idx    = 0;
+    hvac_log_stop_req  = false;
+    hvac_log_file_open = true;
+    hvac_log_running   = true;
+    k_spin_unlock(&hvac_log_lock, key);
+
+    return 0;
+}
+
+int hvac_log_stop(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&hvac_log_lock);
+
+    if (!hvac_log_file_open) {
+        k_spin_unlock(&hvac_log_lock, key);
+        return -EALREADY;
+    }
+
+    hvac_log_running = false;
+    /* niepełny blok też idzie na kartę - ostatni blok pliku może być krótszy */
+    if (hvac_log_fill > 0) {
+        hvac_log_handoff(hvac_log_fill);
+    }
+    hvac_log_stop_req = true;
+
+    k_spin_unlock(&hvac_log_lock, key);
+
+    k_sem_give(&hvac_log_sem);
+
+    if (k_sem_take(&hvac_log_done, K_SECONDS(5)) != 0) {
+        LOG_WRN("Log writer did not finish in time");
+        return -ETIMEDOUT;
+    }
+
+    LOG_INF("Log closed: %u records in %u B, %u dropped, %u files, %u syncs, max write %u us",
+            hvac_log_st.records, hvac_log_st.bytes, hvac_log_st.dropped,
+            hvac_log_st.files, hvac_log_st.syncs, hvac_log_st.max_write_us);
+    return hvac_log_st.err;
+}
+
+bool hvac_log_is_running(void)
+{
+    return hvac_log_running;
+}
+
+void hvac_log_get_stats(struct hvac_log_stats *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&hvac_log_lock);
+    *out = hvac_log_st;
+    k_spin_unlock(&hvac_log_lock, key);
+}
@@ -0,0 +1,113 @@
+#ifndef HVAC_LOG_H
+#define HVAC_LOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hvac_io.h"
+
+/*
+ * Rejestrator cykli regulacji na kartę SD albo do flasha QSPI
+ * (CONFIG_HVAC_LOG_BACKEND_LFS, hvac_log_lfs.h).
+ * Wątek regulacji koduje rekord do jednego z dwóch bloków w RAM-ie (bez
+ * blokowania - gdy oba bloki czekają na zapis, rekord jest gubiony
+ * i liczony), a wątek o niskim priorytecie zapisuje pełny blok jednym
+ * fs_write(). Nagłówek zajmuje cały sektor, blok jest wielokrotnością
+ * sektora, więc każdy zapis zaczyna się na granicy sektora.
+ *
+ * Plik v3:
+ *   struct hvac_log_hdr (512 B)
+ *   bloki po block_size B, blok i pod 512 + i * block_size:
+ *     HVAC_LOG_TAG_KEY  + struct hvac_log_rec      - pierwszy rekord bloku
+ *     HVAC_LOG_TAG_DELTA + varint maska + varinty  - kolejne, różnice
+ *                                                    względem poprzedniego
+ *     HVAC_LOG_TAG_PAD ...                         - do końca bloku
+ *   indeks: uint64_t czas pracy (ms) pierwszego rekordu każdego bloku
+ *   struct hvac_log_footer
+ *
+ * Każdy blok da się zdekodować samodzielnie, więc do dowolnej godziny
+ * wystarczy wyszukiwanie w indeksie i odczyt jednego bloku. Plik bez
+ * stopki (zanik zasilania) czyta się blok po bloku od początku.
+ * Pliki są zmieniane po CONFIG_HVAC_LOG_ROTATE_KB albo _ROTATE_MIN.
+ *
+ * Czas: t_ms w rekordach to młodsze 32 bity k_uptime_get(). Plik nigdy
+ * nie obejmuje więcej niż HVAC_LOG_SPAN_MAX_MS, więc dekoder odtwarza
+ * pełny czas względem start_ms z nagłówka albo wpisu indeksu. Sterownik
+ * nie ma zegara czasu rzeczywistego - pliki z różnych uruchomień
+ * porządkuje boot_no (najnowszy plik w katalogu + 1 po restarcie).
+ *
+ * Rekord delta: maska (varint) - bity 0..7 AI, 8..15 AO, 16 setpoint,
+ * 17 u_pct, 18 i_term, 19 nieregularny czas. Dla bitu 19 najpierw
+ * varint zigzag (dt_ms - period_ms) i varint (dframe - 1), potem dla
+ * każdego ustawionego bitu różnica pola jako varint zigzag.
+ */
+
+#define HVAC_LOG_MAGIC        0x474f4c48u     /* "HLOG" */
+#define HVAC_LOG_FOOTER_MAGIC 0x58444948u     /* "HIDX" */
+#define HVAC_LOG_VERSION      3
+#define HVAC_LOG_SECTOR       512
+
+/* połowa zakresu uint32_t ms z zapasem - granica jednoznacznego t_ms */
+#define HVAC_LOG_SPAN_MAX_MS  (20LL * 24 * 3600 * 1000)
+
+#define HVAC_LOG_TAG_PAD      0x00
+#define HVAC_LOG_TAG_KEY      0x01
+#define HVAC_LOG_TAG_DELTA    0x02
+
+#define HVAC_LOG_F_TIMING     (1U << 19)
+
+struct hvac_log_hdr {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t rec_size;            /* sizeof(struct hvac_log_rec) */
+    uint32_t period_ms;           /* okres regulacji */
+    uint32_t boot_no;             /* numer uruchomienia sterownika */
+    uint8_t  num_ai;
+    uint8_t  num_ao;
+    uint16_t reserved0;
+    uint32_t block_size;
+    uint32_t file_no;
+    uint32_t reserved1;
+    uint64_t start_ms;            /* k_uptime_get() przy otwarciu */
+    uint8_t  reserved[HVAC_LOG_SECTOR - 40];
+};
+
+struct hvac_log_rec {
+    uint32_t t_ms;                /* koniec odczytu ramki wejść, mod 2^32 */
+    uint32_t frame;
+    uint16_t ai_mv[HVAC_NUM_AI_CHANNELS];
+    uint16_t ao_mv[HVAC_NUM_AO_CHANNELS];   /* wyjścia obowiązujące podczas pomiaru */
+    int16_t  setpoint_dc;         /* 0.1 C */
+    int16_t  u_pct_c;             /* 0.01 % */
+    int16_t  i_term_c;            /* 0.01 % */
+    uint16_t reserved;
+};
+
+struct hvac_log_footer {
+    uint32_t magic;
+    uint32_t count;               /* wpisy indeksu = liczba bloków */
+    uint32_t crc32;               /* crc32 indeksu */
+    uint32_t block_size;
+};
+
+struct hvac_log_stats {
+    uint32_t records;
+    uint32_t dropped;             /* oba bloki zajęte - karta nie nadąża */
+    uint32_t blocks;
+    uint32_t bytes;               /* zakodowane rekordy, bez wypełnienia */
+    uint32_t files;
+    uint32_t max_write_us;
+    uint32_t syncs;               /* fs_sync() - zatwierdzenia pliku */
+    int      err;
+};
+
+int  hvac_log_start(uint32_t period_ms);
+int  hvac_log_stop(void);
+bool hvac_log_is_running(void);
+
+/* wołane z wątku regulacji raz na cykl; nie blokuje */
+void hvac_log_cycle(int32_t setpoint, float u_pct, float i_term);
+
+void hvac_log_get_stats(struct hvac_log_stats *out);
+
+#endif /* HVAC_LOG_H */
@@ -0,0 +1,262 @@
+#include <zephyr/kernel.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/fs/littlefs.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+#include <errno.h>
+#include <stdio.h>
+
+#include "hvac_log_lfs.h"
+
+LOG_MODULE_REGISTER(hvac_log_lfs, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define HVAC_LOG_LFS_PATH_LEN 48
+#define HVAC_LOG_LFS_NONE     0U
+
+/* partycja musi leżeć we flashu QSPI (węzeł n25q128a1 płytki), nie w wewnętrznym */
+#define HVAC_LOG_LFS_FLASH DT_GPARENT(DT_NODELABEL(hvac_log_partition))
+
+BUILD_ASSERT(DT_NODE_HAS_COMPAT(HVAC_LOG_LFS_FLASH, st_stm32_qspi_nor),
+             "hvac_log_partition must be on the QSPI NOR flash");
+BUILD_ASSERT(DT_REG_SIZE(DT_NODELABEL(hvac_log_partition)) % CONFIG_HVAC_LOG_LFS_BLOCK_SIZE == 0,
+             "log partition must be whole LittleFS blocks");
+BUILD_ASSERT(CONFIG_HVAC_LOG_LFS_BLOCK_SIZE % CONFIG_HVAC_LOG_LFS_CACHE_SIZE == 0,
+             "LittleFS block must be a multiple of the cache");
+
+/*
+ * Cache pliku równy blokowi kasowania: pełne bloki rejestratora idą do
+ * flasha bez kopiowania, a fs_sync() zapisuje najwyżej jeden niepełny blok.
+ * Rozmiar bloku jest ustawiany przed montażem - bez tego LittleFS bierze
+ * stronę z układu stron sterownika flasha, która nie musi być sektorem 4 KB.
+ */
+FS_LITTLEFS_DECLARE_CUSTOM_CONFIG(hvac_log_lfs_cfg, 4,
+                                  CONFIG_HVAC_LOG_LFS_PROG_SIZE,
+                                  CONFIG_HVAC_LOG_LFS_PROG_SIZE,
+                                  CONFIG_HVAC_LOG_LFS_CACHE_SIZE,
+                                  CONFIG_HVAC_LOG_LFS_LOOKAHEAD_SIZE);
+
+static struct fs_mount_t hvac_log_lfs_mnt = {
+    .type        = FS_LITTLEFS,
+    .fs_data     = &hvac_log_lfs_cfg,
+    .storage_dev = (void *)FIXED_PARTITION_ID(hvac_log_partition),
+    .mnt_point   = HVAC_LOG_LFS_MNT,
+};
+
+static bool hvac_log_lfs_ready;
+
+/* katalog i hvac_log_lfs_busy_no; kopiowanie samego pliku idzie bez blokady */
+static K_MUTEX_DEFINE(hvac_log_lfs_lock);
+static unsigned int hvac_log_lfs_busy_no;       /* plik kopiowany na kartę */
+
+#if defined(CONFIG_HVAC_LOG_LFS_OFFLOAD)
+static uint8_t hvac_log_lfs_copy_buf[CONFIG_HVAC_LOG_LFS_CACHE_SIZE];
+#endif
+
+/* --- Pomocnicze --- */
+
+static void hvac_log_lfs_path(char *buf, size_t size, const char *dir, unsigned int n)
+{
+    snprintf(buf, size, "%s/hvac%04u.log", dir, n);
+}
+
+/* najstarszy i najnowszy numer pliku w katalogu logu, pomija skip */
+static int hvac_log_lfs_range(unsigned int skip, unsigned int *oldest, unsigned int *newest)
+{
+    struct fs_dir_t dir;
+    struct fs_dirent ent;
+    int ret;
+
+    *oldest = HVAC_LOG_LFS_NONE;
+    *newest = HVAC_LOG_LFS_NONE;
+
+    fs_dir_t_init(&dir);
+    ret = fs_opendir(&dir, CONFIG_HVAC_LOG_DIR);
+    if (ret < 0) {
+        return ret;
+    }
+
+    while (fs_readdir(&dir, &ent) == 0 && ent.name[0] != '\0') {
+        unsigned int n;
+
+        if (sscanf(ent.name, "hvac%u.log", &n) != 1 || n == skip) {
+            continue;
+        }
+        if (*oldest == HVAC_LOG_LFS_NONE || n < *oldest) {
+            *oldest = n;
+        }
+        if (n > *newest) {
+            *newest = n;
+        }
+    }
+    fs_closedir(&dir);
+
+    return 0;
+}
+
+/* --- API --- */
+
+int hvac_log_lfs_mount(void)
+{
+    int64_t t0 = k_uptime_get();
+    int ret;
+
+    hvac_log_lfs_cfg.cfg.block_size = CONFIG_HVAC_LOG_LFS_BLOCK_SIZE;
+
+    /* pusta albo uszkodzona partycja jest formatowana przez fs_mount() */
+    ret = fs_mount(&hvac_log_lfs_mnt);
+    if (ret != 0) {
+        LOG_ERR("fs_mount(%s) failed: %d", HVAC_LOG_LFS_MNT, ret);
+        return ret;
+    }
+
+    hvac_log_lfs_ready = true;
+    LOG_INF("Log flash mounted on %s in %u ms", HVAC_LOG_LFS_MNT,
+            (uint32_t)(k_uptime_get() - t0));
+    return 0;
+}
+
+bool hvac_log_lfs_is_ready(void)
+{
+    return hvac_log_lfs_ready;
+}
+
+int hvac_log_lfs_reclaim(uint32_t need)
+{
+    struct fs_statvfs st;
+    char path[HVAC_LOG_LFS_PATH_LEN];
+    int ret;
+
+    k_mutex_lock(&hvac_log_lfs_lock, K_FOREVER);
+
+    while (1) {
+        unsigned int oldest;
+        unsigned int newest;
+
+        ret = fs_statvfs(HVAC_LOG_LFS_MNT, &st);
+        if (ret < 0) {
+            break;
+        }
+        if ((uint64_t)st.f_bfree * st.f_frsize >= need) {
+            break;
+        }
+
+        /* najnowszy plik zostaje - od niego liczy się numeracja kolejnych */
+        ret = hvac_log_lfs_range(hvac_log_lfs_busy_no, &oldest, &newest);
+        if (ret < 0 || oldest == newest) {
+            LOG_ERR("Log flash full, nothing left to delete");
+            ret = -ENOSPC;
+            break;
+        }
+
+        hvac_log_lfs_path(path, sizeof(path), CONFIG_HVAC_LOG_DIR, oldest);
+        ret = fs_unlink(path);
+        if (ret < 0) {
+            LOG_ERR("Cannot delete %s: %d", path, ret);
+            break;
+        }
+        LOG_WRN("Deleted %s to free log flash", path);
+    }
+
+    k_mutex_unlock(&hvac_log_lfs_lock);
+    return ret;
+}
+
+#if defined(CONFIG_HVAC_LOG_LFS_OFFLOAD)
+
+static int hvac_log_lfs_copy(const char *src, const char *dst)
+{
+    struct fs_file_t in;
+    struct fs_file_t out;
+    int ret;
+
+    fs_file_t_init(&in);
+    fs_file_t_init(&out);
+
+    ret = fs_open(&in, src, FS_O_READ);
+    if (ret < 0) {
+        return ret;
+    }
+
+    ret = fs_open(&out, dst, FS_O_CREATE | FS_O_WRITE);
+    if (ret < 0) {
+        fs_close(&in);
+        return ret;
+    }
+
+    ret = fs_truncate(&out, 0);
+
+    while (ret == 0) {
+        ssize_t n = fs_read(&in, hvac_log_lfs_copy_buf, sizeof(hvac_log_lfs_copy_buf));
+
+        if (n <= 0) {
+            ret = (int)n;
+            break;
+        }
+        if (fs_write(&out, hvac_log_lfs_copy_buf, n) != n) {
+            ret = -EIO;
+        }
+    }
+
+    int err = fs_close(&out);
+    fs_close(&in);
+
+    return ret ? ret : err;
+}
+
+int hvac_log_lfs_offload(const char *dst_dir)
+{
+    char src[HVAC_LOG_LFS_PATH_LEN];
+    char dst[HVAC_LOG_LFS_PATH_LEN];
+    int moved = 0;
+    int ret;
+
+    if (!hvac_log_lfs_ready) {
+        return -ENODEV;
+    }
+
+    ret = fs_mkdir(dst_dir);
+    if (ret != 0 && ret != -EEXIST) {
+        LOG_ERR("Cannot create %s: %d", dst_dir, ret);
+        return ret;
+    }
+
+    while (1) {
+        unsigned int oldest;
+        unsigned int newest;
+
+        k_mutex_lock(&hvac_log_lfs_lock, K_FOREVER);
+        ret = hvac_log_lfs_range(HVAC_LOG_LFS_NONE, &oldest, &newest);
+        if (ret < 0 || oldest == newest) {
+            k_mutex_unlock(&hvac_log_lfs_lock);
+            break;
+        }
+        hvac_log_lfs_busy_no = oldest;
+        k_mutex_unlock(&hvac_log_lfs_lock);
+
+        hvac_log_lfs_path(src, sizeof(src), CONFIG_HVAC_LOG_DIR, oldest);
+        hvac_log_lfs_path(dst, sizeof(dst), dst_dir, oldest);
+
+        /* przerwane kopiowanie zostawia plik we flashu - następnym razem od nowa */
+        ret = hvac_log_lfs_copy(src, dst);
+
+        k_mutex_lock(&hvac_log_lfs_lock, K_FOREVER);
+        if (ret == 0) {
+            ret = fs_unlink(src);
+        }
+        hvac_log_lfs_busy_no = HVAC_LOG_LFS_NONE;
+        k_mutex_unlock(&hvac_log_lfs_lock);
+
+        if (ret != 0) {
+            LOG_ERR("Offload of %s failed: %d", src, ret);
+            return ret;
+        }
+        moved++;
+    }
+
+    if (moved > 0) {
+        LOG_INF("Moved %d log files to %s", moved, dst_dir);
+    }
+    return (ret < 0) ? ret : moved;
+}
+
+#endif /* CONFIG_HVAC_LOG_LFS_OFFLOAD */
@@ -0,0 +1,32 @@
+#ifndef HVAC_LOG_LFS_H
+#define HVAC_LOG_LFS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Rejestrator na LittleFS w partycji hvac_log_partition (flash QSPI),
+ * zamiast FAT na karcie. LittleFS jest copy-on-write: zanik zasilania
+ * cofa plik do ostatniego fs_sync(), a montaż nie wymaga naprawy.
+ * Flash jest mały, więc przed otwarciem nowego pliku najstarsze są
+ * usuwane, a po włożeniu karty zamknięte pliki są na nią przenoszone.
+ */
+
+#define HVAC_LOG_LFS_MNT "/lfs"
+
+int  hvac_log_lfs_mount(void);
+bool hvac_log_lfs_is_ready(void);
+
+/* usuwa najstarsze pliki logu, aż będzie need bajtów wolnego miejsca */
+int  hvac_log_lfs_reclaim(uint32_t need);
+
+#if defined(CONFIG_HVAC_LOG_LFS_OFFLOAD)
+/*
+ * Kopiuje pliki logu na kartę (dst_dir) i usuwa je z flasha. Najnowszy
+ * plik - ten, do którego pisze rejestrator - zostaje. Zwraca liczbę
+ * przeniesionych plików.
+ */
+int  hvac_log_lfs_offload(const char *dst_dir);
+#endif
+
+#endif /* HVAC_LOG_LFS_H */
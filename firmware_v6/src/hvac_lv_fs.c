@@ -0,0 +1,423 @@
+#include <zephyr/kernel.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include <string.h>
+
+#include <lvgl.h>
+
+#include "hvac_lv_fs.h"
+#include "hvac_storage.h"
+
+LOG_MODULE_REGISTER(hvac_lv_fs, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define HVAC_LV_FS_HANDLES  CONFIG_HVAC_LV_FS_HANDLES
+#define HVAC_LV_FS_RA_SIZE  CONFIG_HVAC_LV_FS_RA_SIZE
+#define HVAC_LV_FS_SECTOR   512
+#define HVAC_LV_FS_PATH_MAX 96
+
+BUILD_ASSERT(HVAC_LV_FS_RA_SIZE % HVAC_LV_FS_SECTOR == 0, "read-ahead must be whole sectors");
+
+/*
+ * pos   - pozycja widziana przez LVGL (może być za końcem pliku)
+ * fpos  - rzeczywista pozycja fs_file_t (fs_seek() tylko gdy się różnią)
+ * size  - rozmiar pliku; FatFs obcina seek za koniec, więc odczyty
+ *         są przycinane tutaj
+ * ra_*  - zawartość bufora: bajty [ra_off, ra_off + ra_len) pliku
+ */
+struct hvac_lv_file {
+    struct fs_file_t f;
+    bool     used;
+    bool     stale;               /* karta wyjęta - plik zamknięty, czeka na close_cb */
+    uint32_t pos;
+    uint32_t fpos;
+    uint32_t size;
+    uint32_t ra_off;
+    uint32_t ra_len;
+    uint8_t  ra[HVAC_LV_FS_RA_SIZE] __aligned(32);
+};
+
+/*
+ * LVGL woła sterownik tylko ze swojego wątku, ale wyjęcie karty zamyka
+ * uchwyty z wątku karty - blokada obejmuje każde wywołanie, więc
+ * fs_unmount() nie trafi w trwający odczyt.
+ */
+static struct hvac_lv_file hvac_lv_files[HVAC_LV_FS_HANDLES];
+static struct hvac_lv_fs_stats hvac_lv_fs_st;
+static lv_fs_drv_t hvac_lv_fs_drv;
+static K_MUTEX_DEFINE(hvac_lv_fs_lock);
+
+/* --- Pomocnicze --- */
+
+static int hvac_lv_fs_sync_pos(struct hvac_lv_file *h, uint32_t pos)
+{
+    if (h->fpos != pos) {
+        int ret = fs_seek(&h->f, pos, FS_SEEK_SET);
+        if (ret < 0) {
+            return ret;
+        }
+        h->fpos = pos;
+    }
+    return 0;
+}
+
+/* wczytuje sektory zawierające pos; 0 bajtów = koniec pliku */
+static ssize_t hvac_lv_fs_fill(struct hvac_lv_file *h, uint32_t pos)
+{
+    uint32_t off = ROUND_DOWN(pos, HVAC_LV_FS_SECTOR);
+    int ret;
+
+    h->ra_len = 0;
+
+    ret = hvac_lv_fs_sync_pos(h, off);
+    if (ret < 0) {
+        return ret;
+    }
+
+    ssize_t n = fs_read(&h->f, h->ra, HVAC_LV_FS_RA_SIZE);
+    if (n < 0) {
+        return n;
+    }
+
+    h->ra_off = off;
+    h->ra_len = n;
+    h->fpos   = off + n;
+    hvac_lv_fs_st.fills++;
+
+    return (pos < off + n) ? (ssize_t)(off + n - pos) : 0;
+}
+
+static lv_fs_res_t hvac_lv_fs_res(int err)
+{
+    switch (err) {
+    case -ENOENT: return LV_FS_RES_NOT_EX;
+    case -ENOSPC: return LV_FS_RES_FULL;
+    case -EACCES: return LV_FS_RES_DENIED;
+    case -EBUSY:  return LV_FS_RES_BUSY;
+    case -EIO:    return LV_FS_RES_HW_ERR;
+    default:      return LV_FS_RES_FS_ERR;
+    }
+}
+
+/* --- Wywołania LVGL --- */
+
+/* is_ready() sprawdzane pod blokadą - wyjęcie karty czeka na koniec otwierania */
+static struct hvac_lv_file *hvac_lv_fs_open_locked(const char *full, lv_fs_mode_t mode)
+{
+    struct hvac_lv_file *h = NULL;
+    fs_mode_t flags = 0;
+
+    if (!hvac_storage_is_ready()) {
+        hvac_lv_fs_st.open_fail++;
+        return NULL;
+    }
+
+    for (int i = 0; i < HVAC_LV_FS_HANDLES; i++) {
+        if (!hvac_lv_files[i].used) {
+            h = &hvac_lv_files[i];
+            break;
+        }
+    }
+    if (h == NULL) {
+        LOG_WRN("No free LVGL file handle for %s", full);
+        hvac_lv_fs_st.open_fail++;
+        return NULL;
+    }
+
+    if (mode & LV_FS_MODE_RD) {
+        flags |= FS_O_READ;
+    }
+    if (mode & LV_FS_MODE_WR) {
+        flags |= FS_O_WRITE | FS_O_CREATE;
+    }
+
+    fs_file_t_init(&h->f);
+    int ret = fs_open(&h->f, full, flags);
+    if (ret < 0) {
+        LOG_DBG("Cannot open %s: %d", full, ret);
+        hvac_lv_fs_st.open_fail++;
+        return NULL;
+    }
+
+    /* rozmiar z FatFs bez dostępu do karty (obj.objsize) */
+    off_t size = (fs_seek(&h->f, 0, FS_SEEK_END) == 0) ? fs_tell(&h->f) : -EIO;
+    if (size < 0 || fs_seek(&h->f, 0, FS_SEEK_SET) != 0) {
+        fs_close(&h->f);
+        hvac_lv_fs_st.open_fail++;
+        return NULL;
+    }
+
+    h->used   = true;
+    h->stale  = false;
+    h->size   = size;
+    h->pos    = 0;
+    h->fpos   = 0;
+    h->ra_off = 0;
+    h->ra_len = 0;
+    hvac_lv_fs_st.opens++;
+
+    return h;
+}
+
+static void *hvac_lv_fs_open(lv_fs_drv_t *drv, const char *path, lv_fs_mode_t mode)
+{
+    char full[HVAC_LV_FS_PATH_MAX];
+    size_t mnt_len = sizeof(HVAC_STORAGE_MNT) - 1;
+    struct hvac_lv_file *h;
+
+    ARG_UNUSED(drv);
+
+    /* "/SD:" + "/" + ścieżka LVGL (z ukośnikiem albo bez) */
+    if (path[0] == '/') {
+        path++;
+    }
+    size_t len = strlen(path);
+    if (mnt_len + 1 + len + 1 > sizeof(full)) {
+        LOG_ERR("Path too long: %s", path);
+        hvac_lv_fs_st.open_fail++;
+        return NULL;
+    }
+    memcpy(full, HVAC_STORAGE_MNT, mnt_len);
+    full[mnt_len] = '/';
+    memcpy(&full[mnt_len + 1], path, len + 1);
+
+    k_mutex_lock(&hvac_lv_fs_lock, K_FOREVER);
+    h = hvac_lv_fs_open_locked(full, mode);
+    k_mutex_unlock(&hvac_lv_fs_lock);
+
+    return h;
+}
+
+static lv_fs_res_t hvac_lv_fs_close(lv_fs_drv_t *drv, void *file_p)
+{
+    struct hvac_lv_file *h = file_p;
+    int ret = 0;
+
+    ARG_UNUSED(drv);
+
+    k_mutex_lock(&hvac_lv_fs_lock, K_FOREVER);
+    if (!h->stale) {
+        ret = fs_close(&h->f);
+    }
+    h->used = false;
+    k_mutex_unlock(&hvac_lv_fs_lock);
+
+    return (ret < 0) ? hvac_lv_fs_res(ret) : LV_FS_RES_OK;
+}
+
+static lv_fs_res_t hvac_lv_fs_read_locked(struct hvac_lv_file *h, uint8_t *dst,
+                                          uint32_t btr, uint32_t *br)
+{
+    uint32_t done = 0;
+    bool card = false;
+
+    hvac_lv_fs_st.reads++;
+
+    btr = (h->pos < h->size) ? MIN(btr, h->size - h->pos) : 0;
+
+    while (done < btr) {
+        uint32_t want = btr - done;
+
+        /* trafienie w bufor */
+        if (h->pos >= h->ra_off && h->pos < h->ra_off + h->ra_len) {
+            uint32_t n = MIN(want, h->ra_off + h->ra_len - h->pos);
+
+            memcpy(&dst[done], &h->ra[h->pos - h->ra_off], n);
+            done   += n;
+            h->pos += n;
+            continue;
+        }
+
+        card = true;
+
+        /* duży odczyt - bez kopiowania przez bufor */
+        if (want >= HVAC_LV_FS_RA_SIZE) {
+            int ret = hvac_lv_fs_sync_pos(h, h->pos);
+            if (ret < 0) {
+                *br = done;
+                return hvac_lv_fs_res(ret);
+            }
+
+            ssize_t n = fs_read(&h->f, &dst[done], want);
+            if (n < 0) {
+                *br = done;
+                return hvac_lv_fs_res((int)n);
+            }
+
+            hvac_lv_fs_st.direct++;
+            done    += n;
+            h->pos  += n;
+            h->fpos  = h->pos;
+            if ((uint32_t)n < want) {
+                break;              /* koniec pliku */
+            }
+            continue;
+        }
+
+        ssize_t avail = hvac_lv_fs_fill(h, h->pos);
+        if (avail < 0) {
+            *br = done;
+            return hvac_lv_fs_res((int)avail);
+        }
+        if (avail == 0) {
+            break;                  /* koniec pliku */
+        }
+    }
+
+    if (!card) {
+        hvac_lv_fs_st.hits++;
+    }
+
+    *br = done;
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t hvac_lv_fs_read(lv_fs_drv_t *drv, void *file_p, void *buf,
+                                   uint32_t btr, uint32_t *br)
+{
+    struct hvac_lv_file *h = file_p;
+    lv_fs_res_t res;
+
+    ARG_UNUSED(drv);
+
+    k_mutex_lock(&hvac_lv_fs_lock, K_FOREVER);
+    if (h->stale) {
+        *br = 0;
+        res = LV_FS_RES_HW_ERR;
+    } else {
+        res = hvac_lv_fs_read_locked(h, buf, btr, br);
+    }
+    k_mutex_unlock(&hvac_lv_fs_lock);
+
+    return res;
+}
+
+static lv_fs_res_t hvac_lv_fs_write(lv_fs_drv_t *drv, void *file_p, const void *buf,
+                                    uint32_t btw, uint32_t *bw)
+{
+    struct hvac_lv_file *h = file_p;
+    lv_fs_res_t res = LV_FS_RES_OK;
+    ssize_t n = 0;
+
+    ARG_UNUSED(drv);
+
+    k_mutex_lock(&hvac_lv_fs_lock, K_FOREVER);
+
+    if (h->stale) {
+        res = LV_FS_RES_HW_ERR;
+        goto out;
+    }
+
+    /* zapis unieważnia bufor - prościej niż łatać jego zawartość */
+    h->ra_len = 0;
+
+    int ret = hvac_lv_fs_sync_pos(h, h->pos);
+    if (ret < 0) {
+        res = hvac_lv_fs_res(ret);
+        goto out;
+    }
+
+    n = fs_write(&h->f, buf, btw);
+    if (n < 0) {
+        res = hvac_lv_fs_res((int)n);
+        n = 0;
+        goto out;
+    }
+
+    h->pos  += n;
+    h->fpos  = h->pos;
+    h->size  = MAX(h->size, h->pos);
+
+out:
+    k_mutex_unlock(&hvac_lv_fs_lock);
+    *bw = n;
+    return res;
+}
+
+/* seek tylko przesuwa pos - bufor zostaje ważny, jeśli nowa pozycja w nim leży */
+static lv_fs_res_t hvac_lv_fs_seek(lv_fs_drv_t *drv, void *file_p, uint32_t pos,
+                                   lv_fs_whence_t whence)
+{
+    struct hvac_lv_file *h = file_p;
+
+    ARG_UNUSED(drv);
+
+    switch (whence) {
+    case LV_FS_SEEK_SET:
+        h->pos = pos;
+        break;
+    case LV_FS_SEEK_CUR:
+        h->pos += (int32_t)pos;
+        break;
+    case LV_FS_SEEK_END:
+        h->pos = h->size + (int32_t)pos;
+        break;
+    default:
+        return LV_FS_RES_INV_PARAM;
+    }
+
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t hvac_lv_fs_tell(lv_fs_drv_t *drv, void *file_p, uint32_t *pos_p)
+{
+    struct hvac_lv_file *h = file_p;
+
+    ARG_UNUSED(drv);
+
+    *pos_p = h->pos;
+    return LV_FS_RES_OK;
+}
+
+static bool hvac_lv_fs_ready(lv_fs_drv_t *drv)
+{
+    ARG_UNUSED(drv);
+
+    return hvac_storage_is_ready();
+}
+
+/* wątek karty, przed fs_unmount() - otwarte uchwyty LVGL zostają, ale bez pliku */
+static void hvac_lv_fs_on_storage(enum hvac_storage_event ev)
+{
+    if (ev != HVAC_STORAGE_EV_REMOVED) {
+        return;
+    }
+
+    k_mutex_lock(&hvac_lv_fs_lock, K_FOREVER);
+    for (int i = 0; i < HVAC_LV_FS_HANDLES; i++) {
+        struct hvac_lv_file *h = &hvac_lv_files[i];
+
+        if (h->used && !h->stale) {
+            (void)fs_close(&h->f);
+            h->stale  = true;
+            h->ra_len = 0;
+        }
+    }
+    k_mutex_unlock(&hvac_lv_fs_lock);
+}
+
+/* --- API --- */
+
+void hvac_lv_fs_init(void)
+{
+    lv_fs_drv_init(&hvac_lv_fs_drv);
+
+    hvac_lv_fs_drv.letter   = HVAC_LV_FS_LETTER;
+    hvac_lv_fs_drv.ready_cb = hvac_lv_fs_ready;
+    hvac_lv_fs_drv.open_cb  = hvac_lv_fs_open;
+    hvac_lv_fs_drv.close_cb = hvac_lv_fs_close;
+    hvac_lv_fs_drv.read_cb  = hvac_lv_fs_read;
+    hvac_lv_fs_drv.write_cb = hvac_lv_fs_write;
+    hvac_lv_fs_drv.seek_cb  = hvac_lv_fs_seek;
+    hvac_lv_fs_drv.tell_cb  = hvac_lv_fs_tell;
+
+    lv_fs_drv_register(&hvac_lv_fs_drv);
+
+    (void)hvac_storage_subscribe(hvac_lv_fs_on_storage);
+}
+
+void hvac_lv_fs_get_stats(struct hvac_lv_fs_stats *out)
+{
+    *out = hvac_lv_fs_st;
+}
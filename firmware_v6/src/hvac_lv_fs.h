@@ -0,0 +1,32 @@
+#ifndef HVAC_LV_FS_H
+#define HVAC_LV_FS_H
+
+#include <stdint.h>
+
+/*
+ * Sterownik lv_fs dla karty SD: "S:/img/x.bin" -> HVAC_STORAGE_MNT "/img/x.bin".
+ * Uchwyty pochodzą ze statycznej puli (bez sterty), każdy ma własny
+ * bufor odczytu z wyprzedzeniem - małe odczyty LVGL (nagłówki obrazów,
+ * glify fontów) są obsługiwane z RAM-u, karta dostaje odczyty całych
+ * sektorów. Duże odczyty idą prosto do bufora wywołującego.
+ * Wyjęcie karty zamyka otwarte pliki przed fs_unmount(); ich uchwyty
+ * zwracają błąd aż do lv_fs_close().
+ */
+
+#define HVAC_LV_FS_LETTER 'S'
+
+struct hvac_lv_fs_stats {
+    uint32_t opens;
+    uint32_t open_fail;           /* brak karty, pliku albo wolnego uchwytu */
+    uint32_t reads;               /* wywołania read_cb */
+    uint32_t hits;                /* read_cb obsłużone w całości z bufora */
+    uint32_t fills;               /* odczyty karty do bufora */
+    uint32_t direct;              /* odczyty karty prosto do bufora LVGL */
+};
+
+/* rejestracja w LVGL, przed hvac_storage_start(); pliki dostępne, gdy karta jest zamontowana */
+void hvac_lv_fs_init(void);
+
+void hvac_lv_fs_get_stats(struct hvac_lv_fs_stats *out);
+
+#endif /* HVAC_LV_FS_H */
@@ -0,0 +1,416 @@
+#include <zephyr/kernel.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include <string.h>
+
+#include "hvac_io.h"
+#include "hvac_mb_master.h"
+#include "hvac_rs485.h"
+
+LOG_MODULE_REGISTER(hvac_mb_master, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define HVAC_MBM_NODE DT_NODELABEL(hvac_mb_points)
+
+#define HVAC_MBM_FC_READ_HOLDING 0x03
+#define HVAC_MBM_FC_READ_INPUT   0x04
+#define HVAC_MBM_READ_MAX        125
+
+/* kolejność jak w enum data-type bindingu */
+enum hvac_mbm_type {
+    HVAC_MBM_UINT16,
+    HVAC_MBM_INT16,
+    HVAC_MBM_UINT32,
+    HVAC_MBM_INT32,
+    HVAC_MBM_FLOAT32,
+};
+
+struct hvac_mbm_point {
+    uint8_t  unit;
+    uint8_t  fc;
+    uint8_t  type;
+    bool     word_swap;
+    uint16_t addr;
+    int32_t  scale_milli;
+    uint32_t poll_ms;
+};
+
+#define HVAC_MBM_POINT(n) {                                                   \
+        .unit        = DT_PROP(n, unit),                                      \
+        .fc          = DT_PROP(n, input_register) ? HVAC_MBM_FC_READ_INPUT    \
+                                                  : HVAC_MBM_FC_READ_HOLDING, \
+        .type        = DT_ENUM_IDX(n, data_type),                             \
+        .word_swap   = DT_PROP(n, word_swap),                                 \
+        .addr        = DT_PROP(n, address),                                   \
+        .scale_milli = DT_PROP(n, scale_milli),                               \
+        .poll_ms     = DT_PROP(n, poll_ms),                                   \
+    },
+
+static const struct hvac_mbm_point hvac_mbm_points[] = {
+    DT_FOREACH_CHILD(HVAC_MBM_NODE, HVAC_MBM_POINT)
+};
+
+#define HVAC_MBM_NUM_POINTS ARRAY_SIZE(hvac_mbm_points)
+
+BUILD_ASSERT(HVAC_MBM_NUM_POINTS <= HVAC_NUM_EXT_CHANNELS,
+             "more hvac_mb_points children than CONFIG_HVAC_IO_EXT_CHANNELS");
+
+/* stan urządzenia - po adresie, tablica wypełniana przy starcie */
+struct hvac_mbm_unit {
+    uint8_t  addr;
+    uint8_t  fails;               /* kolejne nieudane zapytania */
+    uint32_t backoff_ms;          /* 0 = urządzenie żyje */
+    int64_t  retry_ms;            /* w back-off: następna próba */
+};
+
+static struct hvac_mbm_unit hvac_mbm_units[HVAC_MBM_NUM_POINTS];
+static size_t hvac_mbm_num_units;
+static uint8_t hvac_mbm_unit_of[HVAC_MBM_NUM_POINTS];
+static int64_t hvac_mbm_due[HVAC_MBM_NUM_POINTS];
+/* punkty z bloku, na który przyszedł wyjątek - odtąd czytane osobno */
+static uint32_t hvac_mbm_solo;
+
+static struct hvac_mb_master_stats hvac_mbm_st;
+
+/* jedno zapytanie: blok rejestrów i punkty, które z niego wynikają */
+struct hvac_mbm_batch {
+    uint8_t  unit;
+    uint8_t  fc;
+    uint16_t start;
+    uint16_t count;
+    uint32_t points;              /* bit n = hvac_mbm_points[n] */
+};
+
+/* --- Harmonogram --- */
+
+static uint16_t hvac_mbm_words(const struct hvac_mbm_point *p)
+{
+    return (p->type >= HVAC_MBM_UINT32) ? 2 : 1;
+}
+
+static bool hvac_mbm_unit_ready(const struct hvac_mbm_unit *u, int64_t now)
+{
+    return u->backoff_ms == 0 || u->retry_ms <= now;
+}
+
+/* najwcześniejszy termin; punkt o terminie <= now albo -1 */
+static int hvac_mbm_pick(int64_t now, int64_t *wake)
+{
+    int best = -1;
+
+    *wake = INT64_MAX;
+
+    for (size_t i = 0; i < HVAC_MBM_NUM_POINTS; i++) {
+        const struct hvac_mbm_unit *u = &hvac_mbm_units[hvac_mbm_unit_of[i]];
+        int64_t t = (u->backoff_ms != 0) ? MAX(hvac_mbm_due[i], u->retry_ms) : hvac_mbm_due[i];
+
+        if (t < *wake) {
+            *wake = t;
+            best = i;
+        }
+    }
+
+    return (best >= 0 && *wake <= now) ? best : -1;
+}
+
+/*
+ * Dokłada punkty tego samego urządzenia i funkcji, którym do terminu
+ * zostało mniej niż pół okresu - odczytane teraz nic nie tracą, a
+ * oszczędzają osobne zapytanie. Do skutku, bo każdy dołożony punkt
+ * może zbliżyć blok do kolejnego.
+ */
+static void hvac_mbm_coalesce(struct hvac_mbm_batch *b, int64_t now)
+{
+    bool grown;
+
+    do {
+        grown = false;
+
+        for (size_t i = 0; i < HVAC_MBM_NUM_POINTS; i++) {
+            const struct hvac_mbm_point *p = &hvac_mbm_points[i];
+
+            if ((b->points & BIT(i)) || (hvac_mbm_solo & BIT(i)) ||
+                p->unit != b->unit || p->fc != b->fc ||
+                hvac_mbm_due[i] > now + p->poll_ms / 2) {
+                continue;
+            }
+
+            uint32_t end   = (uint32_t)b->start + b->count;
+            uint32_t p_end = (uint32_t)p->addr + hvac_mbm_words(p);
+            uint32_t lo    = MIN(b->start, p->addr);
+            uint32_t hi    = MAX(end, p_end);
+
+            /* odstęp między blokiem a punktem */
+            uint32_t gap = (p->addr >= end) ? p->addr - end :
+                           (p_end <= b->start) ? b->start - p_end : 0;
+
+            if (gap > CONFIG_HVAC_MB_MASTER_MAX_GAP || hi - lo > HVAC_MBM_READ_MAX) {
+                continue;
+            }
+
+            b->start   = lo;
+            b->count   = hi - lo;
+            b->points |= BIT(i);
+            grown = true;
+        }
+    } while (grown);
+}
+
+/* --- Ramki --- */
+
+/* długość odpowiedzi wynikająca z nagłówka; 0 = jeszcze nie wiadomo */
+static size_t hvac_mbm_expected_len(const uint8_t *p, size_t len)
+{
+    if (len < 2) {
+        return 0;
+    }
+    if (p[1] & 0x80) {
+        return 5;
+    }
+    return (len < 3) ? 0 : 5U + p[2];
+}
+
+static float hvac_mbm_decode(const struct hvac_mbm_point *p, const uint8_t *regs)
+{
+    uint16_t w0 = sys_get_be16(&regs[0]);
+    uint32_t u32;
+
+    switch (p->type) {
+    case HVAC_MBM_UINT16:
+        return (float)w0;
+    case HVAC_MBM_INT16:
+        return (float)(int16_t)w0;
+    default:
+        break;
+    }
+
+    uint16_t w1 = sys_get_be16(&regs[2]);
+    u32 = p->word_swap ? ((uint32_t)w1 << 16 | w0) : ((uint32_t)w0 << 16 | w1);
+
+    switch (p->type) {
+    case HVAC_MBM_UINT32:
+        return (float)u32;
+    case HVAC_MBM_INT32:
+        return (float)(int32_t)u32;
+    default: {
+        float f;
+
+        memcpy(&f, &u32, sizeof(f));
+        return f;
+    }
+    }
+}
+
+static void hvac_mbm_publish(const struct hvac_mbm_batch *b, const uint8_t *regs, bool valid)
+{
+    for (size_t i = 0; i < HVAC_MBM_NUM_POINTS; i++) {
+        if (!(b->points & BIT(i))) {
+            continue;
+        }
+
+        const struct hvac_mbm_point *p = &hvac_mbm_points[i];
+        float v = 0.0f;
+
+        if (valid) {
+            v = hvac_mbm_decode(p, &regs[(p->addr - b->start) * 2]) *
+                (float)p->scale_milli / 1000.0f;
+        }
+        hvac_io_ext_set(i, v, valid);
+    }
+}
+
+/* 0, -ETIMEDOUT, -EIO (CRC / niezgodna ramka) albo -EPROTO (wyjątek) */
+static int hvac_mbm_transact(const struct hvac_mbm_batch *b, const uint8_t **regs)
+{
+    const uint8_t *rsp;
+    size_t len;
+
+    uint8_t *req = hvac_rs485_tx_buf(K_MSEC(CONFIG_HVAC_MB_MASTER_TIMEOUT_MS));
+    if (req == NULL) {
+        return -ETIMEDOUT;
+    }
+
+    req[0] = b->unit;
+    req[1] = b->fc;
+    sys_put_be16(b->start, &req[2]);
+    sys_put_be16(b->count, &req[4]);
+
+    /* resztki po poprzednim urządzeniu nie mogą udawać odpowiedzi */
+    hvac_rs485_flush();
+    hvac_mbm_st.requests++;
+
+    int ret = hvac_rs485_send(6);
+    if (ret != 0) {
+        return ret;
+    }
+
+    ret = hvac_rs485_recv(&rsp, &len, K_MSEC(CONFIG_HVAC_MB_MASTER_TIMEOUT_MS));
+    if (ret != 0) {
+        hvac_mbm_st.timeouts++;
+        return -ETIMEDOUT;
+    }
+
+    if (!hvac_rs485_crc_ok(rsp, len) || rsp[0] != b->unit || (rsp[1] & 0x7f) != b->fc) {
+        ret = -EIO;
+    } else if (rsp[1] & 0x80) {
+        ret = -EPROTO;
+    } else if (rsp[2] != 2 * b->count || len != 5U + rsp[2]) {
+        ret = -EIO;
+    }
+
+    if (ret == -EIO) {
+        hvac_mbm_st.crc_err++;
+    } else if (ret == -EPROTO) {
+        hvac_mbm_st.exceptions++;
+    }
+
+    /* bufor odbiorczy zostaje u wołającego do hvac_rs485_release() */
+    *regs = &rsp[3];
+    return ret;
+}
+
+static void hvac_mbm_unit_failed(struct hvac_mbm_unit *u, int64_t now)
+{
+    /* nasycenie - po przepełnieniu urządzenie w back-off dostałoby znów RETRIES prób */
+    if (u->fails < UINT8_MAX) {
+        u->fails++;
+    }
+    if (u->fails < CONFIG_HVAC_MB_MASTER_RETRIES) {
+        return;                 /* ponowienie w następnym przebiegu */
+    }
+
+    if (u->backoff_ms == 0) {
+        hvac_mbm_st.dead_units++;
+        LOG_WRN("Modbus unit %u not responding", u->addr);
+        u->backoff_ms = CONFIG_HVAC_MB_MASTER_BACKOFF_MIN_MS;
+    } else {
+        u->backoff_ms = MIN(u->backoff_ms * 2, CONFIG_HVAC_MB_MASTER_BACKOFF_MAX_MS);
+    }
+    u->retry_ms = now + u->backoff_ms;
+}
+
+static void hvac_mbm_unit_ok(struct hvac_mbm_unit *u)
+{
+    if (u->backoff_ms != 0) {
+        hvac_mbm_st.dead_units--;
+        LOG_INF("Modbus unit %u back", u->addr);
+    }
+    u->fails = 0;
+    u->backoff_ms = 0;
+}
+
+/* --- Wątek --- */
+
+static void hvac_mbm_thread(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    while (1) {
+        int64_t now = k_uptime_get();
+        int64_t wake;
+        int first = hvac_mbm_pick(now, &wake);
+
+        if (first < 0) {
+            k_sleep(K_MSEC(wake - now));
+            continue;
+        }
+
+        const struct hvac_mbm_point *fp = &hvac_mbm_points[first];
+        struct hvac_mbm_unit *u = &hvac_mbm_units[hvac_mbm_unit_of[first]];
+        struct hvac_mbm_batch b = {
+            .unit   = fp->unit,
+            .fc     = fp->fc,
+            .start  = fp->addr,
+            .count  = hvac_mbm_words(fp),
+            .points = BIT(first),
+        };
+
+        /* urządzenie w back-off: jedna próba tylko z punktem startowym */
+        if (u->backoff_ms == 0 && !(hvac_mbm_solo & BIT(first))) {
+            hvac_mbm_coalesce(&b, now);
+        }
+
+        const uint8_t *regs;
+        int ret = hvac_mbm_transact(&b, &regs);
+
+        now = k_uptime_get();
+
+        if (ret == 0 || ret == -EPROTO) {
+            /* wyjątek = urządzenie żyje, ale któryś punkt jest źle opisany */
+            hvac_mbm_publish(&b, regs, ret == 0);
+            if (ret == -EPROTO && b.points != BIT(first)) {
+                hvac_mbm_solo |= b.points;
+            }
+            hvac_mbm_unit_ok(u);
+
+            for (size_t i = 0; i < HVAC_MBM_NUM_POINTS; i++) {
+                if (b.points & BIT(i)) {
+                    /* stała faza, ale bez nadrabiania zaległych odczytów */
+                    hvac_mbm_due[i] = MAX(hvac_mbm_due[i] + hvac_mbm_points[i].poll_ms, now);
+                }
+            }
+            hvac_mbm_st.points_read += (ret == 0) ? __builtin_popcount(b.points) : 0;
+        } else {
+            hvac_mbm_unit_failed(u, now);
+            if (u->backoff_ms != 0) {
+                for (size_t i = 0; i < HVAC_MBM_NUM_POINTS; i++) {
+                    if (hvac_mbm_points[i].unit == u->addr) {
+                        hvac_io_ext_set(i, 0.0f, false);
+                    }
+                }
+            }
+        }
+
+        hvac_rs485_release();
+
+        /* cisza między ramkami, zanim padnie kolejne zapytanie */
+        k_sleep(K_USEC(hvac_rs485_t35_us()));
+    }
+}
+
+K_THREAD_DEFINE(hvac_mbm_thread_id, CONFIG_HVAC_MB_MASTER_STACK_SIZE,
+                hvac_mbm_thread, NULL, NULL, NULL,
+                CONFIG_HVAC_MB_MASTER_PRIORITY, 0, SYS_FOREVER_MS);  /* startuje hvac_mb_master_start() */
+
+/* --- API --- */
+
+int hvac_mb_master_start(void)
+{
+    int64_t now = k_uptime_get();
+
+    for (size_t i = 0; i < HVAC_MBM_NUM_POINTS; i++) {
+        size_t u;
+
+        for (u = 0; u < hvac_mbm_num_units; u++) {
+            if (hvac_mbm_units[u].addr == hvac_mbm_points[i].unit) {
+                break;
+            }
+        }
+        if (u == hvac_mbm_num_units) {
+            hvac_mbm_units[hvac_mbm_num_units++].addr = hvac_mbm_points[i].unit;
+        }
+
+        hvac_mbm_unit_of[i] = u;
+        hvac_mbm_due[i] = now;
+    }
+
+    int ret = hvac_rs485_init(hvac_mbm_expected_len);
+    if (ret != 0) {
+        return ret;
+    }
+
+    k_thread_start(hvac_mbm_thread_id);
+
+    LOG_INF("Modbus master: %u points on %u units", (unsigned)HVAC_MBM_NUM_POINTS,
+            (unsigned)hvac_mbm_num_units);
+    return 0;
+}
+
+void hvac_mb_master_get_stats(struct hvac_mb_master_stats *out)
+{
+    *out = hvac_mbm_st;
+}
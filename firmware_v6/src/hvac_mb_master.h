@@ -0,0 +1,37 @@
+#ifndef HVAC_MB_MASTER_H
+#define HVAC_MB_MASTER_H
+
+#include <stdint.h>
+
+/*
+ * Modbus RTU master na łączu RS485 (hvac_rs485.h): odpytuje rejestry
+ * z węzła hvac_mb_points (binding hvac,modbus-points) i wpisuje wyniki
+ * do obrazu procesu jako wejścia zewnętrzne (hvac_io_ext_set). Pętla
+ * regulacji czyta je jak lokalne AI - magistrala nigdy jej nie blokuje.
+ *
+ * Harmonogram:
+ *   - każdy punkt ma własny okres (poll-ms),
+ *   - punkty tego samego urządzenia i funkcji, które i tak wkrótce
+ *     byłyby odpytane, są łączone w jeden odczyt ciągłego bloku
+ *     (dziury do CONFIG_HVAC_MB_MASTER_MAX_GAP rejestrów są czytane
+ *     i pomijane),
+ *   - urządzenie, które nie odpowiedziało CONFIG_HVAC_MB_MASTER_RETRIES
+ *     razy z rzędu, jest odpytywane coraz rzadziej (podwajany odstęp do
+ *     CONFIG_HVAC_MB_MASTER_BACKOFF_MAX_MS), a jego punkty tracą bit
+ *     w ext_valid - reszta magistrali nie czeka na jego timeouty.
+ */
+
+struct hvac_mb_master_stats {
+    uint32_t requests;
+    uint32_t points_read;         /* punkty obsłużone; points_read/requests = zysk z łączenia */
+    uint32_t timeouts;
+    uint32_t crc_err;             /* także odpowiedzi niezgodne z zapytaniem */
+    uint32_t exceptions;
+    uint32_t dead_units;          /* urządzenia obecnie w back-off */
+};
+
+int  hvac_mb_master_start(void);
+
+void hvac_mb_master_get_stats(struct hvac_mb_master_stats *out);
+
+#endif /* HVAC_MB_MASTER_H */
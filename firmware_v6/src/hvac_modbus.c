@@ -0,0 +1,394 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <errno.h>
+#include <string.h>
+
+#include "hvac_cfg_upload.h"
+#include "hvac_io.h"
+#include "hvac_modbus.h"
+#include "hvac_rs485.h"
+
+LOG_MODULE_REGISTER(hvac_modbus, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define HVAC_MB_FC_READ_HOLDING   0x03
+#define HVAC_MB_FC_READ_INPUT     0x04
+#define HVAC_MB_FC_WRITE_SINGLE   0x06
+#define HVAC_MB_FC_WRITE_MULTIPLE 0x10
+#define HVAC_MB_FC_WRITE_FILE     0x15
+
+#define HVAC_MB_EX_FUNCTION  0x01
+#define HVAC_MB_EX_ADDRESS   0x02
+#define HVAC_MB_EX_VALUE     0x03
+#define HVAC_MB_EX_BUSY      0x06
+
+#define HVAC_MB_FILE_REF_TYPE 6
+
+static const struct hvac_modbus_ops *hvac_mb_ops;
+static struct hvac_modbus_stats hvac_mb_st;
+
+/*
+ * Rejestry holding gotowe do wysłania i konfiguracja, z której powstały
+ * (baza dla zapisów). Pisze UI (hvac_modbus_cfg_changed) i wątek Modbus.
+ */
+static struct k_spinlock hvac_mb_hr_lock;
+static struct hvac_config hvac_mb_cfg;
+static uint8_t hvac_mb_hr[HVAC_MB_HR_COUNT * 2];
+
+/* słowa dokumentu odebrane w sesji wgrywania - numer następnego rekordu */
+static uint32_t hvac_mb_upload_words;
+/* długość ostatniego rekordu - jego powtórzenie jest tylko potwierdzane */
+static uint32_t hvac_mb_upload_last;
+
+/* --- Protokół --- */
+
+/* długość żądania wynikająca z nagłówka; 0 = jeszcze nie wiadomo */
+static size_t hvac_mb_expected_len(const uint8_t *p, size_t len)
+{
+    if (len < 2) {
+        return 0;
+    }
+
+    switch (p[1]) {
+    case HVAC_MB_FC_READ_HOLDING:
+    case HVAC_MB_FC_READ_INPUT:
+    case HVAC_MB_FC_WRITE_SINGLE:
+        return 8;
+    case HVAC_MB_FC_WRITE_MULTIPLE:
+        return (len < 7) ? 0 : 9U + p[6];
+    case HVAC_MB_FC_WRITE_FILE:
+        return (len < 3) ? 0 : 5U + p[2];
+    default:
+        return 0;               /* nieznana funkcja - koniec po t3.5 */
+    }
+}
+
+static int16_t hvac_mb_sat16(int32_t v)
+{
+    return (int16_t)CLAMP(v, INT16_MIN, INT16_MAX);
+}
+
+/* pod hvac_mb_hr_lock */
+static void hvac_mb_hr_encode(const struct hvac_config *cfg)
+{
+    hvac_mb_cfg = *cfg;
+
+    for (int i = 0; i < HVAC_MB_HR_COUNT; i++) {
+        int32_t v = *hvac_cfg_field(&hvac_mb_cfg, i);
+
+        sys_put_be16((uint16_t)hvac_mb_sat16(v), &hvac_mb_hr[i * 2]);
+    }
+}
+
+static size_t hvac_mb_exception(uint8_t *rsp, uint8_t fc, uint8_t code)
+{
+    hvac_mb_st.exceptions++;
+    rsp[1] = fc | 0x80;
+    rsp[2] = code;
+    return 3;
+}
+
+static size_t hvac_mb_read_regs(const uint8_t *req, uint8_t *rsp, uint8_t fc)
+{
+    uint16_t start = sys_get_be16(&req[2]);
+    uint16_t count = sys_get_be16(&req[4]);
+
+    if (count < 1 || count > 125) {
+        return hvac_mb_exception(rsp, fc, HVAC_MB_EX_VALUE);
+    }
+
+    /* blok prosto z obrazu w formacie ramki */
+    if (fc == HVAC_MB_FC_READ_INPUT) {
+        if (hvac_io_regs_read(start, count, &rsp[3]) != 0) {
+            return hvac_mb_exception(rsp, fc, HVAC_MB_EX_ADDRESS);
+        }
+    } else {
+        if ((uint32_t)start + count > HVAC_MB_HR_COUNT) {
+            return hvac_mb_exception(rsp, fc, HVAC_MB_EX_ADDRESS);
+        }
+
+        k_spinlock_key_t key = k_spin_lock(&hvac_mb_hr_lock);
+        memcpy(&rsp[3], &hvac_mb_hr[start * 2], count * 2);
+        k_spin_unlock(&hvac_mb_hr_lock, key);
+    }
+
+    rsp[2] = (uint8_t)(2 * count);
+    return 3 + 2 * count;
+}
+
+static size_t hvac_mb_write_regs(const uint8_t *req, size_t len, uint8_t *rsp, uint8_t fc)
+{
+    uint16_t start = sys_get_be16(&req[2]);
+    uint16_t count = 1;
+    const uint8_t *vals = &req[4];
+    struct hvac_config cfg;
+
+    if (fc == HVAC_MB_FC_WRITE_MULTIPLE) {
+        count = sys_get_be16(&req[4]);
+        vals  = &req[7];
+        if (count < 1 || count > 123 || req[6] != 2 * count || len != 9U + req[6]) {
+            return hvac_mb_exception(rsp, fc, HVAC_MB_EX_VALUE);
+        }
+    }
+
+    if ((uint32_t)start + count > HVAC_MB_HR_COUNT) {
+        return hvac_mb_exception(rsp, fc, HVAC_MB_EX_ADDRESS);
+    }
+
+    /* zmiany na kopii - do UI trafia wszystko albo nic */
+    k_spinlock_key_t key = k_spin_lock(&hvac_mb_hr_lock);
+    cfg = hvac_mb_cfg;
+    k_spin_unlock(&hvac_mb_hr_lock, key);
+
+    for (uint16_t i = 0; i < count; i++) {
+        *hvac_cfg_field(&cfg, start + i) = (int16_t)sys_get_be16(&vals[2 * i]);
+    }
+
+    if (!hvac_cfg_validate(&cfg)) {
+        return hvac_mb_exception(rsp, fc, HVAC_MB_EX_VALUE);
+    }
+
+    /* odczyt zaraz po zapisie widzi nowe wartości, zanim UI je przejmie */
+    key = k_spin_lock(&hvac_mb_hr_lock);
+    hvac_mb_hr_encode(&cfg);
+    k_spin_unlock(&hvac_mb_hr_lock, key);
+
+    hvac_mb_ops->set_cfg(&cfg);
+
+    /* odpowiedź: echo adresu i wartości (06) albo adresu i liczby (16) */
+    memcpy(&rsp[2], &req[2], 4);
+    return 6;
+}
+
+/*
+ * Master powtarza zapis, gdy odpowiedź zginęła na linii - ten sam rekord
+ * drugi raz nie trafia do parsera, dostaje tylko echo. Rekord 0 zawsze
+ * zaczyna sesję od nowa, co dla powtórzenia daje ten sam wynik.
+ */
+static bool hvac_mb_upload_retry(uint32_t words, uint32_t last, uint16_t rec, uint16_t n)
+{
+    return rec != 0 && last != 0 && rec + last == words && n == last;
+}
+
+/*
+ * FC 21: podżądania (typ 6, plik, rekord, długość w słowach, dane).
+ * Najpierw sprawdzane są wszystkie nagłówki - ramka z błędnym adresem
+ * nie rusza sesji. Błąd parsera w trakcie kończy się wyjątkiem, a master
+ * zaczyna od rekordu 0.
+ */
+static size_t hvac_mb_write_file(const uint8_t *req, size_t len, uint8_t *rsp)
+{
+    const uint8_t fc = HVAC_MB_FC_WRITE_FILE;
+    const uint8_t *end = &req[3 + req[2]];
+    const uint8_t *q;
+    uint32_t words = hvac_mb_upload_words;
+    uint32_t last = hvac_mb_upload_last;
+    struct hvac_config cfg;
+    int ret;
+
+    if (req[2] < 9 || req[2] > 0xf5 || len != 5U + req[2]) {
+        return hvac_mb_exception(rsp, fc, HVAC_MB_EX_VALUE);
+    }
+
+    for (q = &req[3]; q < end; ) {
+        if (end - q < 7) {
+            return hvac_mb_exception(rsp, fc, HVAC_MB_EX_VALUE);
+        }
+
+        uint16_t file = sys_get_be16(&q[1]);
+        uint16_t rec  = sys_get_be16(&q[3]);
+        uint16_t n    = sys_get_be16(&q[5]);
+
+        if (q[0] != HVAC_MB_FILE_REF_TYPE || n < 1 || end - q - 7 < 2 * n) {
+            return hvac_mb_exception(rsp, fc, HVAC_MB_EX_VALUE);
+        }
+
+        if (file == HVAC_MB_FILE_CFG) {
+            /* rekordy po kolei, od zera (nowa sesja) albo powtórzenie ostatniego */
+            if (hvac_mb_upload_retry(words, last, rec, n)) {
+                /* bez zmian */
+            } else if (rec != 0 && rec != words) {
+                return hvac_mb_exception(rsp, fc, HVAC_MB_EX_ADDRESS);
+            } else {
+                words = rec + n;
+                last  = n;
+            }
+        } else if (file == HVAC_MB_FILE_CFG_CTL) {
+            if (rec != 0 || n != 1) {
+                return hvac_mb_exception(rsp, fc, HVAC_MB_EX_ADDRESS);
+            }
+            if (sys_get_be16(&q[7]) > 1) {
+                return hvac_mb_exception(rsp, fc, HVAC_MB_EX_VALUE);
+            }
+            words = 0;
+            last  = 0;
+        } else {
+            return hvac_mb_exception(rsp, fc, HVAC_MB_EX_ADDRESS);
+        }
+
+        q += 7 + 2 * n;
+    }
+
+    for (q = &req[3]; q < end; ) {
+        uint16_t file = sys_get_be16(&q[1]);
+        uint16_t rec  = sys_get_be16(&q[3]);
+        uint16_t n    = sys_get_be16(&q[5]);
+
+        if (file == HVAC_MB_FILE_CFG) {
+            if (hvac_mb_upload_retry(hvac_mb_upload_words, hvac_mb_upload_last, rec, n)) {
+                q += 7 + 2 * n;
+                continue;
+            }
+            if (rec == 0) {
+                k_spinlock_key_t key = k_spin_lock(&hvac_mb_hr_lock);
+                cfg = hvac_mb_cfg;
+                k_spin_unlock(&hvac_mb_hr_lock, key);
+
+                if (hvac_cfg_upload_begin(&hvac_mb_upload_words, &cfg) != 0) {
+                    return hvac_mb_exception(rsp, fc, HVAC_MB_EX_BUSY);
+                }
+            }
+            ret = hvac_cfg_upload_feed(&hvac_mb_upload_words, (const char *)&q[7], 2 * n);
+            if (ret < 0) {
+                /* sesja stracona - następny może być tylko rekord 0 */
+                hvac_mb_upload_words = 0;
+                hvac_mb_upload_last  = 0;
+                return hvac_mb_exception(rsp, fc, HVAC_MB_EX_VALUE);
+            }
+            hvac_mb_upload_words = rec + n;
+            hvac_mb_upload_last  = n;
+        } else if (sys_get_be16(&q[7]) == 1) {
+            hvac_mb_upload_words = 0;
+            hvac_mb_upload_last  = 0;
+            ret = hvac_cfg_upload_commit(&hvac_mb_upload_words, &cfg);
+            if (ret < 0) {
+                return hvac_mb_exception(rsp, fc, HVAC_MB_EX_VALUE);
+            }
+
+            k_spinlock_key_t key = k_spin_lock(&hvac_mb_hr_lock);
+            hvac_mb_hr_encode(&cfg);
+            k_spin_unlock(&hvac_mb_hr_lock, key);
+
+            hvac_mb_ops->set_cfg(&cfg);
+        } else {
+            hvac_mb_upload_words = 0;
+            hvac_mb_upload_last  = 0;
+            hvac_cfg_upload_abort(&hvac_mb_upload_words);
+        }
+
+        q += 7 + 2 * n;
+    }
+
+    /* odpowiedź: echo żądania */
+    memcpy(&rsp[2], &req[2], 1 + req[2]);
+    return 3 + req[2];
+}
+
+/* długość odpowiedzi bez CRC; 0 = bez odpowiedzi (obcy adres, broadcast, błąd CRC) */
+static size_t hvac_mb_process(const uint8_t *req, size_t len, uint8_t *rsp)
+{
+    size_t n;
+
+    if (!hvac_rs485_crc_ok(req, len)) {
+        hvac_mb_st.crc_err++;
+        return 0;
+    }
+
+    uint8_t addr = req[0];
+    uint8_t fc   = req[1];
+
+    if (addr != CONFIG_HVAC_MODBUS_ADDRESS && addr != 0) {
+        return 0;
+    }
+    hvac_mb_st.frames++;
+
+    rsp[0] = CONFIG_HVAC_MODBUS_ADDRESS;
+    rsp[1] = fc;
+
+    switch (fc) {
+    case HVAC_MB_FC_READ_HOLDING:
+    case HVAC_MB_FC_READ_INPUT:
+        n = (len == 8) ? hvac_mb_read_regs(req, rsp, fc)
+                       : hvac_mb_exception(rsp, fc, HVAC_MB_EX_VALUE);
+        break;
+    case HVAC_MB_FC_WRITE_SINGLE:
+        n = (len == 8) ? hvac_mb_write_regs(req, len, rsp, fc)
+                       : hvac_mb_exception(rsp, fc, HVAC_MB_EX_VALUE);
+        break;
+    case HVAC_MB_FC_WRITE_MULTIPLE:
+        n = (len >= 9) ? hvac_mb_write_regs(req, len, rsp, fc)
+                       : hvac_mb_exception(rsp, fc, HVAC_MB_EX_VALUE);
+        break;
+    case HVAC_MB_FC_WRITE_FILE:
+        n = (len >= 14) ? hvac_mb_write_file(req, len, rsp)
+                        : hvac_mb_exception(rsp, fc, HVAC_MB_EX_VALUE);
+        break;
+    default:
+        n = hvac_mb_exception(rsp, fc, HVAC_MB_EX_FUNCTION);
+        break;
+    }
+
+    /* broadcast: zapis wykonany, odpowiedzi brak */
+    if (addr == 0) {
+        return 0;
+    }
+
+    return n;
+}
+
+/* --- Wątek --- */
+
+static void hvac_mb_thread(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    while (1) {
+        const uint8_t *req;
+        size_t len;
+
+        (void)hvac_rs485_recv(&req, &len, K_FOREVER);
+
+        /* poprzednia odpowiedź dawno wyszła - master czekał na nią */
+        uint8_t *rsp = hvac_rs485_tx_buf(K_FOREVER);
+        size_t n = hvac_mb_process(req, len, rsp);
+
+        hvac_rs485_release();
+        (void)hvac_rs485_send(n);
+    }
+}
+
+K_THREAD_DEFINE(hvac_mb_thread_id, CONFIG_HVAC_MODBUS_STACK_SIZE,
+                hvac_mb_thread, NULL, NULL, NULL,
+                CONFIG_HVAC_MODBUS_PRIORITY, 0, SYS_FOREVER_MS);  /* startuje hvac_modbus_start() */
+
+/* --- API --- */
+
+int hvac_modbus_start(const struct hvac_modbus_ops *ops)
+{
+    hvac_mb_ops = ops;
+
+    int ret = hvac_rs485_init(hvac_mb_expected_len);
+    if (ret != 0) {
+        return ret;
+    }
+
+    k_thread_start(hvac_mb_thread_id);
+
+    LOG_INF("Modbus RTU slave %d", CONFIG_HVAC_MODBUS_ADDRESS);
+    return 0;
+}
+
+void hvac_modbus_cfg_changed(const struct hvac_config *cfg)
+{
+    k_spinlock_key_t key = k_spin_lock(&hvac_mb_hr_lock);
+    hvac_mb_hr_encode(cfg);
+    k_spin_unlock(&hvac_mb_hr_lock, key);
+}
+
+void hvac_modbus_get_stats(struct hvac_modbus_stats *out)
+{
+    *out = hvac_mb_st;
+    out->overruns = hvac_rs485_overruns();
+}
@@ -0,0 +1,73 @@
+#ifndef HVAC_MODBUS_H
+#define HVAC_MODBUS_H
+
+#include <stdint.h>
+
+#include "hvac_config.h"
+#include "hvac_io.h"
+
+/*
+ * Modbus RTU slave na RS485 (hvac_rs485.h). Gdy długość zapytania
+ * wynika z kodu funkcji i CRC się zgadza, odpowiedź rusza bez czekania
+ * na pełne t3.5.
+ *
+ * Rejestry wejściowe (FC 04) to obraz procesu w postaci słów
+ * (HVAC_IO_REG_*, hvac_io.h): AI i AO [mV], licznik ramek wejść.
+ *
+ * Rejestry holding (FC 03, 06, 16), int16: pola liczbowe konfiguracji
+ * w kolejności HVAC_CFG_INT_FIELDS (hvac_config.h) - adres rejestru to
+ * HVAC_CFG_F_*:
+ *   0       setpoint [C]
+ *   1..8    pasma sekwencji from/to [%]: cooling, heating,
+ *           heat_recovery, deadband
+ *   9..11   kp, ki, kd
+ *   12..20  przypisanie kanałów io (-1 = brak)
+ *
+ * Oba obszary są trzymane gotowe do wysłania (big-endian), więc odczyt
+ * bloku to jeden memcpy do bufora odpowiedzi. Zapis (także wielu
+ * rejestrów) przechodzi hvac_cfg_validate() na kopii i jest atomowy:
+ * cała ramka albo nic.
+ *
+ * Cały config JSON (FC 21, Write File Record, hvac_cfg_upload.h):
+ *   plik 1  dokument; rekord = offset w słowach, rekordy po kolei,
+ *           rekord 0 zaczyna sesję od nowa; nieparzysta długość
+ *           dopełniona spacją
+ *   plik 2  rekord 0, jedno słowo: 1 = walidacja i zastosowanie,
+ *           0 = porzucenie
+ * Dokument nie jest buforowany - rekordy idą prosto do parsera.
+ * Odrzucony config (JSON, zakres) daje wyjątek 03 przy zatwierdzeniu,
+ * trwające wgrywanie z innego kanału - wyjątek 06.
+ */
+
+#define HVAC_MB_FILE_CFG     1
+#define HVAC_MB_FILE_CFG_CTL 2
+
+#define HVAC_MB_IR_COUNT     HVAC_IO_REG_COUNT
+#define HVAC_MB_HR_COUNT     HVAC_CFG_NUM_INT_FIELDS
+
+/*
+ * Konfiguracja należy do wątku UI: set_cfg() przekazuje zapis z Modbus
+ * do zastosowania. Wołane z wątku Modbus, nie może blokować.
+ */
+struct hvac_modbus_ops {
+    void (*set_cfg)(const struct hvac_config *cfg);
+};
+
+struct hvac_modbus_stats {
+    uint32_t frames;              /* poprawne ramki do tego urządzenia */
+    uint32_t crc_err;             /* także ramki urwane */
+    uint32_t exceptions;
+    uint32_t overruns;            /* bajty odebrane w trakcie obsługi ramki */
+};
+
+int  hvac_modbus_start(const struct hvac_modbus_ops *ops);
+
+/*
+ * Nowa konfiguracja opublikowana dla pętli regulacji - odświeża rejestry
+ * holding. Woła hvac_cfg_publish(), także przed hvac_modbus_start().
+ */
+void hvac_modbus_cfg_changed(const struct hvac_config *cfg);
+
+void hvac_modbus_get_stats(struct hvac_modbus_stats *out);
+
+#endif /* HVAC_MODBUS_H */
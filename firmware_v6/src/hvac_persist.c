@@ -0,0 +1,194 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include <string.h>
+
+#include "hvac_persist.h"
+
+LOG_MODULE_REGISTER(hvac_persist, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define HVAC_PERSIST_SUBTREE "hvac"
+
+struct hvac_persist_vals {
+    int32_t             setpoint;
+    struct hvac_seq_cfg seq;
+};
+
+static struct hvac_persist_vals hvac_persist_pending;
+static struct hvac_persist_vals hvac_persist_saved;
+static bool                     hvac_persist_has_setpoint;
+static bool                     hvac_persist_has_seq;
+static int64_t                  hvac_persist_since_ms = -1;  /* pierwsza niezapisana zmiana */
+static struct k_spinlock        hvac_persist_lock;
+
+static struct k_work_q            hvac_persist_wq;
+static struct k_work_delayable    hvac_persist_work;
+static K_THREAD_STACK_DEFINE(hvac_persist_stack, CONFIG_HVAC_PERSIST_STACK_SIZE);
+
+/* --- Odczyt --- */
+
+static bool hvac_persist_band_ok(const struct hvac_seq_band *b)
+{
+    return b->from_percent >= -100 && b->to_percent <= 100 &&
+           b->from_percent <= b->to_percent;
+}
+
+static int hvac_persist_set(const char *name, size_t len,
+                            settings_read_cb read_cb, void *cb_arg)
+{
+    const char *next;
+    int rc;
+
+    if (settings_name_steq(name, "setpoint", &next) && !next) {
+        int32_t v;
+
+        if (len != sizeof(v)) {
+            return -EINVAL;
+        }
+        rc = read_cb(cb_arg, &v, sizeof(v));
+        if (rc < 0) {
+            return rc;
+        }
+
+        /* zapis sprzed zawężenia zakresu albo uszkodzony rekord */
+        if (v < CONFIG_HVAC_SETPOINT_MIN || v > CONFIG_HVAC_SETPOINT_MAX) {
+            LOG_WRN("Stored setpoint %d out of range, ignored", (int)v);
+            return -EINVAL;
+        }
+
+        hvac_persist_saved.setpoint = v;
+        hvac_persist_has_setpoint = true;
+        return 0;
+    }
+
+    if (settings_name_steq(name, "seq", &next) && !next) {
+        struct hvac_seq_cfg seq;
+
+        if (len != sizeof(seq)) {
+            return -EINVAL;
+        }
+        rc = read_cb(cb_arg, &seq, sizeof(seq));
+        if (rc < 0) {
+            return rc;
+        }
+
+        if (!hvac_persist_band_ok(&seq.cooling) || !hvac_persist_band_ok(&seq.heating) ||
+            !hvac_persist_band_ok(&seq.heat_recovery) || !hvac_persist_band_ok(&seq.deadband)) {
+            LOG_WRN("Stored sequence bands invalid, ignored");
+            return 0;
+        }
+
+        hvac_persist_saved.seq = seq;
+        hvac_persist_has_seq = true;
+        return 0;
+    }
+
+    return -ENOENT;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(hvac, HVAC_PERSIST_SUBTREE, NULL,
+                               hvac_persist_set, NULL, NULL);
+
+int hvac_persist_load(struct hvac_config *cfg)
+{
+    int ret = settings_load_subtree(HVAC_PERSIST_SUBTREE);
+    if (ret < 0) {
+        LOG_ERR("Settings load failed: %d", ret);
+        return ret;
+    }
+
+    if (hvac_persist_has_setpoint) {
+        cfg->setpoint = hvac_persist_saved.setpoint;
+    } else {
+        hvac_persist_saved.setpoint = cfg->setpoint;
+    }
+
+    if (hvac_persist_has_seq) {
+        cfg->seq = hvac_persist_saved.seq;
+    } else {
+        hvac_persist_saved.seq = cfg->seq;
+    }
+
+    LOG_INF("Persisted setpoint %s, bands %s",
+            hvac_persist_has_setpoint ? "restored" : "default",
+            hvac_persist_has_seq ? "restored" : "default");
+    return 0;
+}
+
+/* --- Odroczony zapis --- */
+
+static void hvac_persist_work_fn(struct k_work *work)
+{
+    struct hvac_persist_vals v;
+    int ret;
+
+    ARG_UNUSED(work);
+
+    k_spinlock_key_t key = k_spin_lock(&hvac_persist_lock);
+    v = hvac_persist_pending;
+    hvac_persist_since_ms = -1;
+    k_spin_unlock(&hvac_persist_lock, key);
+
+    /* zapisujemy tylko to, co faktycznie różni się od flasha */
+    if (v.setpoint != hvac_persist_saved.setpoint) {
+        ret = settings_save_one(HVAC_PERSIST_SUBTREE "/setpoint",
+                                &v.setpoint, sizeof(v.setpoint));
+        if (ret == 0) {
+            hvac_persist_saved.setpoint = v.setpoint;
+        } else {
+            LOG_ERR("Setpoint save failed: %d", ret);
+        }
+    }
+
+    if (memcmp(&v.seq, &hvac_persist_saved.seq, sizeof(v.seq)) != 0) {
+        ret = settings_save_one(HVAC_PERSIST_SUBTREE "/seq", &v.seq, sizeof(v.seq));
+        if (ret == 0) {
+            hvac_persist_saved.seq = v.seq;
+        } else {
+            LOG_ERR("Sequence bands save failed: %d", ret);
+        }
+    }
+}
+
+void hvac_persist_request(const struct hvac_config *cfg)
+{
+    int64_t now_ms = k_uptime_get();
+    int64_t delay_ms = CONFIG_HVAC_PERSIST_DELAY_MS;
+
+    k_spinlock_key_t key = k_spin_lock(&hvac_persist_lock);
+
+    hvac_persist_pending.setpoint = cfg->setpoint;
+    hvac_persist_pending.seq      = cfg->seq;
+
+    /* ciągłe klikanie nie może odkładać zapisu w nieskończoność */
+    if (hvac_persist_since_ms < 0) {
+        hvac_persist_since_ms = now_ms;
+    }
+    int64_t left_ms = hvac_persist_since_ms + CONFIG_HVAC_PERSIST_MAX_DELAY_MS - now_ms;
+    delay_ms = CLAMP(left_ms, 0, delay_ms);
+
+    k_spin_unlock(&hvac_persist_lock, key);
+
+    k_work_reschedule_for_queue(&hvac_persist_wq, &hvac_persist_work, K_MSEC(delay_ms));
+}
+
+int hvac_persist_init(void)
+{
+    int ret = settings_subsys_init();
+    if (ret < 0) {
+        LOG_ERR("Settings init failed: %d", ret);
+        return ret;
+    }
+
+    k_work_init_delayable(&hvac_persist_work, hvac_persist_work_fn);
+
+    /* kasowanie sektora flasha trwa długo - osobna kolejka o niskim priorytecie */
+    k_work_queue_start(&hvac_persist_wq, hvac_persist_stack,
+                       K_THREAD_STACK_SIZEOF(hvac_persist_stack),
+                       CONFIG_HVAC_PERSIST_PRIORITY, NULL);
+    k_thread_name_set(&hvac_persist_wq.thread, "hvac_persist");
+
+    return 0;
+}
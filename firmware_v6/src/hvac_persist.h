@@ -0,0 +1,17 @@
+#ifndef HVAC_PERSIST_H
+#define HVAC_PERSIST_H
+
+#include "hvac_config.h"
+
+/*
+ * Trwałe nastawy (Zephyr settings, backend NVS): setpoint i pasma sekwencji.
+ * Zapis jest odroczony - kolejne zmiany przesuwają go, aż nastawy się
+ * ustabilizują, więc seria kliknięć kończy się jednym zapisem do flasha.
+ */
+
+int  hvac_persist_init(void);
+/* nadpisuje setpoint/seq w cfg wartościami z flasha (o ile są zapisane) */
+int  hvac_persist_load(struct hvac_config *cfg);
+void hvac_persist_request(const struct hvac_config *cfg);
+
+#endif /* HVAC_PERSIST_H */
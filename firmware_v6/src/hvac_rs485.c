@@ -0,0 +1,230 @@
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/linker/section_tags.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <errno.h>
+#include <string.h>
+
+#include "hvac_rs485.h"
+
+LOG_MODULE_REGISTER(hvac_rs485, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define HVAC_RS485_UART_NODE DT_CHOSEN(hvac_modbus_uart)
+#define HVAC_RS485_BAUD      DT_PROP(HVAC_RS485_UART_NODE, current_speed)
+
+/* 11 bitów na znak (start, 8 danych, parzystość albo drugi stop, stop) */
+#define HVAC_RS485_CHAR_US   (11U * 1000000U / HVAC_RS485_BAUD)
+/* powyżej 19200 bd t3.5 ma stałe 1750 us */
+#define HVAC_RS485_T35_US    ((HVAC_RS485_BAUD > 19200) ? 1750U : (7U * HVAC_RS485_CHAR_US / 2U))
+
+#define HVAC_RS485_DMA_SIZE  64
+
+static const struct device *const hvac_rs485_uart = DEVICE_DT_GET(HVAC_RS485_UART_NODE);
+static const struct gpio_dt_spec hvac_rs485_de =
+    GPIO_DT_SPEC_GET(DT_NODELABEL(hvac_rs485), de_gpios);
+
+static hvac_rs485_len_fn hvac_rs485_expected_len;
+
+/* bufory DMA poza cache - sterownik STM32 wymaga tego przy włączonym D-cache */
+static uint8_t hvac_rs485_dma[2][HVAC_RS485_DMA_SIZE] __nocache __aligned(32);
+static uint8_t hvac_rs485_tx[HVAC_RS485_ADU_MAX] __nocache __aligned(32);
+static uint8_t hvac_rs485_dma_next;
+
+/* ramka składana w przerwaniu; hvac_rs485_busy = ramka u wątku, nie ruszać */
+static uint8_t  hvac_rs485_rx[HVAC_RS485_ADU_MAX];
+static size_t   hvac_rs485_rx_len;
+static bool     hvac_rs485_busy;
+static uint32_t hvac_rs485_overrun_cnt;
+
+static K_SEM_DEFINE(hvac_rs485_rx_sem, 0, 1);
+static K_SEM_DEFINE(hvac_rs485_tx_sem, 1, 1);
+static struct k_timer hvac_rs485_t35;
+
+/* --- CRC --- */
+
+uint16_t hvac_rs485_crc(const uint8_t *p, size_t len)
+{
+    return crc16_reflect(0xa001, 0xffff, p, len);
+}
+
+bool hvac_rs485_crc_ok(const uint8_t *p, size_t len)
+{
+    return len >= 4 && hvac_rs485_crc(p, len - 2) == sys_get_le16(&p[len - 2]);
+}
+
+/* --- UART (przerwania) --- */
+
+static void hvac_rs485_frame_done(void)
+{
+    hvac_rs485_busy = true;
+    k_sem_give(&hvac_rs485_rx_sem);
+}
+
+static void hvac_rs485_t35_expired(struct k_timer *t)
+{
+    ARG_UNUSED(t);
+
+    unsigned int key = irq_lock();
+    if (!hvac_rs485_busy && hvac_rs485_rx_len > 0) {
+        hvac_rs485_frame_done();
+    }
+    irq_unlock(key);
+}
+
+static void hvac_rs485_rx_bytes(const uint8_t *p, size_t len)
+{
+    if (hvac_rs485_busy) {
+        hvac_rs485_overrun_cnt += len;
+        return;
+    }
+
+    /* za długa ramka: nadmiar przepada, CRC i tak się nie zgodzi */
+    size_t n = MIN(len, sizeof(hvac_rs485_rx) - hvac_rs485_rx_len);
+    memcpy(&hvac_rs485_rx[hvac_rs485_rx_len], p, n);
+    hvac_rs485_rx_len += n;
+
+    size_t want = hvac_rs485_expected_len(hvac_rs485_rx, hvac_rs485_rx_len);
+
+    if (want != 0 && hvac_rs485_rx_len == want && hvac_rs485_crc_ok(hvac_rs485_rx, want)) {
+        k_timer_stop(&hvac_rs485_t35);
+        hvac_rs485_frame_done();
+        return;
+    }
+
+    k_timer_start(&hvac_rs485_t35, K_USEC(HVAC_RS485_T35_US), K_NO_WAIT);
+}
+
+static void hvac_rs485_uart_cb(const struct device *dev, struct uart_event *evt, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    switch (evt->type) {
+    case UART_RX_RDY:
+        hvac_rs485_rx_bytes(&evt->data.rx.buf[evt->data.rx.offset], evt->data.rx.len);
+        break;
+    case UART_RX_BUF_REQUEST:
+        (void)uart_rx_buf_rsp(dev, hvac_rs485_dma[hvac_rs485_dma_next], HVAC_RS485_DMA_SIZE);
+        hvac_rs485_dma_next ^= 1;
+        break;
+    case UART_RX_DISABLED:
+        /* błąd linii zatrzymuje odbiór - od razu od nowa */
+        hvac_rs485_dma_next = 1;
+        (void)uart_rx_enable(dev, hvac_rs485_dma[0], HVAC_RS485_DMA_SIZE, HVAC_RS485_CHAR_US);
+        break;
+    case UART_TX_DONE:
+    case UART_TX_ABORTED:
+        /* przerwanie TC - ostatni bit stopu już wyszedł */
+        gpio_pin_set_dt(&hvac_rs485_de, 0);
+        k_sem_give(&hvac_rs485_tx_sem);
+        break;
+    default:
+        break;
+    }
+}
+
+/* --- API --- */
+
+int hvac_rs485_init(hvac_rs485_len_fn expected_len)
+{
+    int ret;
+
+    if (!device_is_ready(hvac_rs485_uart) || !gpio_is_ready_dt(&hvac_rs485_de)) {
+        LOG_ERR("RS485 UART or DE pin not ready");
+        return -ENODEV;
+    }
+
+    ret = gpio_pin_configure_dt(&hvac_rs485_de, GPIO_OUTPUT_INACTIVE);
+    if (ret != 0) {
+        return ret;
+    }
+
+    hvac_rs485_expected_len = expected_len;
+    k_timer_init(&hvac_rs485_t35, hvac_rs485_t35_expired, NULL);
+
+    ret = uart_callback_set(hvac_rs485_uart, hvac_rs485_uart_cb, NULL);
+    if (ret != 0) {
+        LOG_ERR("UART async API not available: %d", ret);
+        return ret;
+    }
+
+    /* timeout odbioru = jeden znak ciszy; STM32 kończy też na przerwaniu IDLE */
+    hvac_rs485_dma_next = 1;
+    ret = uart_rx_enable(hvac_rs485_uart, hvac_rs485_dma[0], HVAC_RS485_DMA_SIZE,
+                         HVAC_RS485_CHAR_US);
+    if (ret != 0) {
+        LOG_ERR("UART RX enable failed: %d", ret);
+        return ret;
+    }
+
+    LOG_INF("RS485 at %d bd, t3.5 %u us", HVAC_RS485_BAUD, HVAC_RS485_T35_US);
+    return 0;
+}
+
+int hvac_rs485_recv(const uint8_t **frame, size_t *len, k_timeout_t timeout)
+{
+    int ret = k_sem_take(&hvac_rs485_rx_sem, timeout);
+    if (ret != 0) {
+        return ret;
+    }
+
+    *frame = hvac_rs485_rx;
+    *len   = hvac_rs485_rx_len;
+    return 0;
+}
+
+void hvac_rs485_release(void)
+{
+    unsigned int key = irq_lock();
+    hvac_rs485_rx_len = 0;
+    hvac_rs485_busy = false;
+    irq_unlock(key);
+}
+
+void hvac_rs485_flush(void)
+{
+    unsigned int key = irq_lock();
+    k_timer_stop(&hvac_rs485_t35);
+    k_sem_reset(&hvac_rs485_rx_sem);
+    hvac_rs485_rx_len = 0;
+    hvac_rs485_busy = false;
+    irq_unlock(key);
+}
+
+uint8_t *hvac_rs485_tx_buf(k_timeout_t timeout)
+{
+    return (k_sem_take(&hvac_rs485_tx_sem, timeout) == 0) ? hvac_rs485_tx : NULL;
+}
+
+int hvac_rs485_send(size_t len)
+{
+    if (len == 0 || len + 2 > sizeof(hvac_rs485_tx)) {
+        k_sem_give(&hvac_rs485_tx_sem);
+        return (len == 0) ? 0 : -EINVAL;
+    }
+
+    sys_put_le16(hvac_rs485_crc(hvac_rs485_tx, len), &hvac_rs485_tx[len]);
+
+    gpio_pin_set_dt(&hvac_rs485_de, 1);
+
+    int ret = uart_tx(hvac_rs485_uart, hvac_rs485_tx, len + 2, SYS_FOREVER_US);
+    if (ret != 0) {
+        gpio_pin_set_dt(&hvac_rs485_de, 0);
+        k_sem_give(&hvac_rs485_tx_sem);
+    }
+    return ret;
+}
+
+uint32_t hvac_rs485_t35_us(void)
+{
+    return HVAC_RS485_T35_US;
+}
+
+uint32_t hvac_rs485_overruns(void)
+{
+    return hvac_rs485_overrun_cnt;
+}
@@ -0,0 +1,55 @@
+#ifndef HVAC_RS485_H
+#define HVAC_RS485_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+
+/*
+ * Łącze RS485 dla Modbus RTU (slave albo master - jeden nadajnik na
+ * płytce): UART z chosen "hvac,modbus-uart", DE z węzła hvac_rs485
+ * (hvac,rs485, de-gpios).
+ *
+ * Odbiór przez DMA, ramkę kończy cisza t3.5 albo - gdy długość wynika
+ * z nagłówka (expected_len) i CRC się zgadza - ostatni bajt. DE jest
+ * zdejmowane w przerwaniu końca nadawania (TC).
+ */
+
+#define HVAC_RS485_ADU_MAX 256
+
+/* długość ramki wynikająca z nagłówka; 0 = jeszcze nie wiadomo */
+typedef size_t (*hvac_rs485_len_fn)(const uint8_t *p, size_t len);
+
+int  hvac_rs485_init(hvac_rs485_len_fn expected_len);
+
+/*
+ * Czeka na ramkę. CRC nie jest sprawdzane (ramka urwana też przychodzi),
+ * bufor jest ważny do hvac_rs485_release() - do tego czasu kolejne
+ * bajty są liczone jako przepełnienia.
+ */
+int  hvac_rs485_recv(const uint8_t **frame, size_t *len, k_timeout_t timeout);
+void hvac_rs485_release(void);
+
+/* odrzuca odebrane dotąd bajty (master przed zapytaniem) */
+void hvac_rs485_flush(void);
+
+/*
+ * Bufor nadawczy; czeka, aż poprzednia ramka wyjdzie (NULL po timeout).
+ * hvac_rs485_send() dopisuje CRC za len bajtami i nadaje; len == 0
+ * zwalnia bufor bez nadawania.
+ */
+uint8_t *hvac_rs485_tx_buf(k_timeout_t timeout);
+int  hvac_rs485_send(size_t len);
+
+uint16_t hvac_rs485_crc(const uint8_t *p, size_t len);
+bool     hvac_rs485_crc_ok(const uint8_t *p, size_t len);
+
+/* cisza między ramkami [us] */
+uint32_t hvac_rs485_t35_us(void);
+
+/* bajty odrzucone, bo poprzednia ramka nie była zwolniona */
+uint32_t hvac_rs485_overruns(void);
+
+#endif /* HVAC_RS485_H */
@@ -0,0 +1,583 @@
+#include <zephyr/kernel.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/storage/disk_access.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "hvac_storage.h"
+#if defined(CONFIG_HVAC_LOG)
+#include "hvac_log.h"
+#endif
+
+LOG_MODULE_REGISTER(hvac_sd_bench, CONFIG_LOG_DEFAULT_LEVEL);
+
+/*
+ * Testy karty SD z powłoki: sekwencyjny i losowy zapis/odczyt blokami
+ * 512 B .. HVAC_SD_BENCH_MAX_BLOCK oraz dopisywanie z fs_sync() jak
+ * w loggerze. Każda operacja jest mierzona osobno, wynik to przepustowość
+ * i histogram czasów (przedziały potęg dwójki), z którego liczone są
+ * percentyle - p99/max zapisu wyznaczają rozmiar bufora loggera.
+ */
+
+#define HVAC_SD_BENCH_FILE      HVAC_STORAGE_MNT "/bench.dat"
+#define HVAC_SD_BENCH_MAX_BLOCK (CONFIG_HVAC_SD_BENCH_MAX_BLOCK_KB * 1024)
+#define HVAC_SD_BENCH_FILE_SIZE (CONFIG_HVAC_SD_BENCH_FILE_KB * 1024)
+#define HVAC_SD_BENCH_MIN_BLOCK 512
+
+/* przedział 0: < 64 us, przedział k: [32 << k, 64 << k) us, ostatni bez górnej granicy */
+#define HVAC_SD_BENCH_BUCKETS   16
+#define HVAC_SD_BENCH_BUCKET0   32
+
+BUILD_ASSERT(HVAC_SD_BENCH_FILE_SIZE >= HVAC_SD_BENCH_MAX_BLOCK,
+             "bench file must hold at least one block");
+
+struct hvac_sd_hist {
+    uint32_t n;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t bucket[HVAC_SD_BENCH_BUCKETS];
+};
+
+static uint8_t hvac_sd_bench_buf[HVAC_SD_BENCH_MAX_BLOCK] __aligned(32);
+static uint32_t hvac_sd_bench_rng = 0x5eed1234u;
+
+/* --- Histogram --- */
+
+static void hvac_sd_hist_reset(struct hvac_sd_hist *h)
+{
+    memset(h, 0, sizeof(*h));
+    h->min_us = UINT32_MAX;
+}
+
+static void hvac_sd_hist_add(struct hvac_sd_hist *h, uint32_t us)
+{
+    int b = 0;
+
+    while (b < HVAC_SD_BENCH_BUCKETS - 1 && us >= ((uint32_t)HVAC_SD_BENCH_BUCKET0 << (b + 1))) {
+        b++;
+    }
+
+    h->bucket[b]++;
+    h->n++;
+    h->sum_us += us;
+    h->min_us = MIN(h->min_us, us);
+    h->max_us = MAX(h->max_us, us);
+}
+
+/* górna granica przedziału, w którym leży percentyl p (max dla ostatniego) */
+static uint32_t hvac_sd_hist_pct(const struct hvac_sd_hist *h, uint32_t p)
+{
+    uint32_t need = (uint32_t)(((uint64_t)h->n * p + 99) / 100);
+    uint32_t acc = 0;
+
+    for (int b = 0; b < HVAC_SD_BENCH_BUCKETS - 1; b++) {
+        acc += h->bucket[b];
+        if (acc >= need) {
+            return MIN((uint32_t)HVAC_SD_BENCH_BUCKET0 << (b + 1), h->max_us);
+        }
+    }
+
+    return h->max_us;
+}
+
+static void hvac_sd_hist_print(const struct shell *sh, const struct hvac_sd_hist *h)
+{
+    uint32_t peak = 1;
+    char bar[33];
+
+    for (int b = 0; b < HVAC_SD_BENCH_BUCKETS; b++) {
+        peak = MAX(peak, h->bucket[b]);
+    }
+
+    for (int b = 0; b < HVAC_SD_BENCH_BUCKETS; b++) {
+        uint32_t lo = (b == 0) ? 0 : ((uint32_t)HVAC_SD_BENCH_BUCKET0 << b);
+        size_t len = (size_t)(((uint64_t)h->bucket[b] * (sizeof(bar) - 1) + peak - 1) / peak);
+
+        if (h->bucket[b] == 0) {
+            continue;
+        }
+
+        memset(bar, '#', len);
+        bar[len] = '\0';
+
+        if (b == HVAC_SD_BENCH_BUCKETS - 1) {
+            shell_print(sh, "    %7u us ..          %7u %s", lo, h->bucket[b], bar);
+        } else {
+            shell_print(sh, "    %7u .. %7u us %7u %s", lo,
+                        (uint32_t)HVAC_SD_BENCH_BUCKET0 << (b + 1), h->bucket[b], bar);
+        }
+    }
+}
+
+static void hvac_sd_row(const struct shell *sh, const char *name, size_t block,
+                        uint64_t bytes, uint64_t total_us, const struct hvac_sd_hist *h)
+{
+    char tp[24] = "";
+
+    if (block != 0) {
+        uint32_t kbps = total_us ? (uint32_t)((bytes * 1000000U) / (total_us * 1024U)) : 0;
+        snprintf(tp, sizeof(tp), "%6u B %6u KB/s", (uint32_t)block, kbps);
+    }
+
+    shell_print(sh, "%-10s %-19s n=%-5u mean=%-6u p50<%-6u p90<%-6u p99<%-6u max=%u us",
+                name, tp, h->n,
+                h->n ? (uint32_t)(h->sum_us / h->n) : 0,
+                hvac_sd_hist_pct(h, 50), hvac_sd_hist_pct(h, 90),
+                hvac_sd_hist_pct(h, 99), h->max_us);
+}
+
+/* --- Operacje z pomiarem --- */
+
+static inline uint32_t hvac_sd_us_since(uint32_t c0)
+{
+    return k_cyc_to_us_floor32(k_cycle_get_32() - c0);
+}
+
+static uint32_t hvac_sd_rand(void)
+{
+    hvac_sd_bench_rng ^= hvac_sd_bench_rng << 13;
+    hvac_sd_bench_rng ^= hvac_sd_bench_rng >> 17;
+    hvac_sd_bench_rng ^= hvac_sd_bench_rng << 5;
+    return hvac_sd_bench_rng;
+}
+
+static void hvac_sd_fill(uint32_t seed)
+{
+    for (size_t i = 0; i < sizeof(hvac_sd_bench_buf); i += 4) {
+        uint32_t v = seed + i;
+        memcpy(&hvac_sd_bench_buf[i], &v, 4);
+    }
+}
+
+static int hvac_sd_check_ready(const struct shell *sh)
+{
+    if (!hvac_storage_is_ready()) {
+        shell_error(sh, "SD card not mounted");
+        return -ENODEV;
+    }
+#if defined(CONFIG_HVAC_LOG)
+    if (hvac_log_is_running()) {
+        shell_warn(sh, "Logger is running - results include its writes");
+    }
+#endif
+    return 0;
+}
+
+/* zapis całego pliku blokami block; czas obejmuje końcowy fs_sync() */
+static int hvac_sd_seq_write(const struct shell *sh, size_t block, bool hist)
+{
+    struct fs_file_t f;
+    struct hvac_sd_hist h;
+    uint32_t ops = HVAC_SD_BENCH_FILE_SIZE / block;
+    uint64_t total_us = 0;
+    int ret;
+
+    hvac_sd_hist_reset(&h);
+    fs_file_t_init(&f);
+
+    ret = fs_open(&f, HVAC_SD_BENCH_FILE, FS_O_CREATE | FS_O_RDWR);
+    if (ret < 0) {
+        shell_error(sh, "Cannot open %s: %d", HVAC_SD_BENCH_FILE, ret);
+        return ret;
+    }
+    (void)fs_truncate(&f, 0);
+
+    for (uint32_t i = 0; i < ops; i++) {
+        uint32_t c0 = k_cycle_get_32();
+        ssize_t n = fs_write(&f, hvac_sd_bench_buf, block);
+        uint32_t us = hvac_sd_us_since(c0);
+
+        if (n != (ssize_t)block) {
+            ret = (n < 0) ? (int)n : -ENOSPC;
+            break;
+        }
+        hvac_sd_hist_add(&h, us);
+        total_us += us;
+    }
+
+    if (ret >= 0) {
+        uint32_t c0 = k_cycle_get_32();
+        ret = fs_sync(&f);
+        total_us += hvac_sd_us_since(c0);
+    }
+
+    fs_close(&f);
+    if (ret < 0) {
+        shell_error(sh, "Write failed: %d", ret);
+        return ret;
+    }
+
+    hvac_sd_row(sh, "seq write", block, (uint64_t)ops * block, total_us, &h);
+    if (hist) {
+        hvac_sd_hist_print(sh, &h);
+    }
+    return 0;
+}
+
+static int hvac_sd_seq_read(const struct shell *sh, size_t block, bool hist)
+{
+    struct fs_file_t f;
+    struct hvac_sd_hist h;
+    uint32_t ops = HVAC_SD_BENCH_FILE_SIZE / block;
+    uint64_t total_us = 0;
+    int ret = 0;
+
+    hvac_sd_hist_reset(&h);
+    fs_file_t_init(&f);
+
+    ret = fs_open(&f, HVAC_SD_BENCH_FILE, FS_O_READ);
+    if (ret < 0) {
+        shell_error(sh, "Cannot open %s: %d", HVAC_SD_BENCH_FILE, ret);
+        return ret;
+    }
+
+    for (uint32_t i = 0; i < ops; i++) {
+        uint32_t c0 = k_cycle_get_32();
+        ssize_t n = fs_read(&f, hvac_sd_bench_buf, block);
+        uint32_t us = hvac_sd_us_since(c0);
+
+        if (n != (ssize_t)block) {
+            ret = (n < 0) ? (int)n : -EIO;
+            break;
+        }
+        hvac_sd_hist_add(&h, us);
+        total_us += us;
+    }
+
+    fs_close(&f);
+    if (ret < 0) {
+        shell_error(sh, "Read failed: %d", ret);
+        return ret;
+    }
+
+    hvac_sd_row(sh, "seq read", block, (uint64_t)ops * block, total_us, &h);
+    if (hist) {
+        hvac_sd_hist_print(sh, &h);
+    }
+    return 0;
+}
+
+/* losowe, wyrównane do block pozycje w pliku testowym; czas obejmuje fs_seek() */
+static int hvac_sd_rand_rw(const struct shell *sh, size_t block, bool write, bool hist)
+{
+    struct fs_file_t f;
+    struct hvac_sd_hist h;
+    uint32_t slots = HVAC_SD_BENCH_FILE_SIZE / block;
+    uint32_t ops = CONFIG_HVAC_SD_BENCH_RAND_OPS;
+    uint64_t total_us = 0;
+    int ret;
+
+    hvac_sd_hist_reset(&h);
+    fs_file_t_init(&f);
+
+    ret = fs_open(&f, HVAC_SD_BENCH_FILE, write ? FS_O_RDWR : FS_O_READ);
+    if (ret < 0) {
+        shell_error(sh, "Cannot open %s: %d (run 'sd bench seq' first)", HVAC_SD_BENCH_FILE, ret);
+        return ret;
+    }
+
+    for (uint32_t i = 0; i < ops; i++) {
+        off_t off = (off_t)(hvac_sd_rand() % slots) * block;
+        uint32_t c0 = k_cycle_get_32();
+        ssize_t n;
+
+        ret = fs_seek(&f, off, FS_SEEK_SET);
+        if (ret < 0) {
+            break;
+        }
+        n = write ? fs_write(&f, hvac_sd_bench_buf, block)
+                  : fs_read(&f, hvac_sd_bench_buf, block);
+        uint32_t us = hvac_sd_us_since(c0);
+
+        if (n != (ssize_t)block) {
+            ret = (n < 0) ? (int)n : -EIO;
+            break;
+        }
+        hvac_sd_hist_add(&h, us);
+        total_us += us;
+    }
+
+    if (ret >= 0 && write) {
+        uint32_t c0 = k_cycle_get_32();
+        ret = fs_sync(&f);
+        total_us += hvac_sd_us_since(c0);
+    }
+
+    fs_close(&f);
+    if (ret < 0) {
+        shell_error(sh, "Random %s failed: %d", write ? "write" : "read", ret);
+        return ret;
+    }
+
+    hvac_sd_row(sh, write ? "rand write" : "rand read", block,
+                (uint64_t)ops * block, total_us, &h);
+    if (hist) {
+        hvac_sd_hist_print(sh, &h);
+    }
+    return 0;
+}
+
+/*
+ * Wzorzec loggera: dopisywanie bloków do nowego pliku z fs_sync() co
+ * sync_every bloków. Czasy zapisu i synchronizacji osobno - najdłuższy
+ * zapis + sync musi się zmieścić w czasie zapełniania drugiego bufora.
+ */
+static int hvac_sd_append(const struct shell *sh, size_t block, uint32_t count,
+                          uint32_t sync_every)
+{
+    struct fs_file_t f;
+    struct hvac_sd_hist hw;
+    struct hvac_sd_hist hs;
+    uint64_t total_us = 0;
+    int ret;
+
+    hvac_sd_hist_reset(&hw);
+    hvac_sd_hist_reset(&hs);
+    fs_file_t_init(&f);
+
+    (void)fs_unlink(HVAC_SD_BENCH_FILE);
+    ret = fs_open(&f, HVAC_SD_BENCH_FILE, FS_O_CREATE | FS_O_WRITE | FS_O_APPEND);
+    if (ret < 0) {
+        shell_error(sh, "Cannot open %s: %d", HVAC_SD_BENCH_FILE, ret);
+        return ret;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        hvac_sd_fill(i);
+
+        uint32_t c0 = k_cycle_get_32();
+        ssize_t n = fs_write(&f, hvac_sd_bench_buf, block);
+        uint32_t us = hvac_sd_us_since(c0);
+
+        if (n != (ssize_t)block) {
+            ret = (n < 0) ? (int)n : -ENOSPC;
+            break;
+        }
+        hvac_sd_hist_add(&hw, us);
+        total_us += us;
+
+        if (sync_every && (i + 1) % sync_every == 0) {
+            c0 = k_cycle_get_32();
+            ret = fs_sync(&f);
+            us = hvac_sd_us_since(c0);
+            if (ret < 0) {
+                break;
+            }
+            hvac_sd_hist_add(&hs, us);
+            total_us += us;
+        }
+    }
+
+    fs_close(&f);
+    if (ret < 0) {
+        shell_error(sh, "Append failed: %d", ret);
+        return ret;
+    }
+
+    shell_print(sh, "append %u x %u B, fs_sync every %u blocks",
+                count, (uint32_t)block, sync_every);
+    hvac_sd_row(sh, "append", block, (uint64_t)count * block, total_us, &hw);
+    hvac_sd_hist_print(sh, &hw);
+    if (hs.n) {
+        hvac_sd_row(sh, "fs_sync", 0, 0, 0, &hs);
+        hvac_sd_hist_print(sh, &hs);
+    }
+    shell_print(sh, "worst write+sync stall: %u us", hw.max_us + (hs.n ? hs.max_us : 0));
+    return 0;
+}
+
+/* --- Polecenia --- */
+
+/* opcjonalny rozmiar bloku: jeden rozmiar + histogram albo wszystkie potęgi dwójki */
+static int hvac_sd_parse_block(const struct shell *sh, size_t argc, char **argv,
+                               size_t *lo, size_t *hi)
+{
+    int err = 0;
+
+    *lo = HVAC_SD_BENCH_MIN_BLOCK;
+    *hi = HVAC_SD_BENCH_MAX_BLOCK;
+
+    if (argc < 2) {
+        return 0;
+    }
+
+    unsigned long b = shell_strtoul(argv[1], 0, &err);
+    if (err != 0 || b < HVAC_SD_BENCH_MIN_BLOCK || b > HVAC_SD_BENCH_MAX_BLOCK ||
+        (b & (b - 1)) != 0) {
+        shell_error(sh, "Block must be a power of two, %u..%u",
+                    HVAC_SD_BENCH_MIN_BLOCK, HVAC_SD_BENCH_MAX_BLOCK);
+        return -EINVAL;
+    }
+
+    *lo = *hi = b;
+    return 0;
+}
+
+static int cmd_sd_info(const struct shell *sh, size_t argc, char **argv)
+{
+    struct fs_statvfs st;
+    uint32_t count;
+    uint32_t size;
+
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    if (!hvac_storage_is_ready()) {
+        shell_error(sh, "SD card not mounted");
+        return -ENODEV;
+    }
+
+    if (disk_access_ioctl(HVAC_STORAGE_DISK, DISK_IOCTL_GET_SECTOR_COUNT, &count) == 0 &&
+        disk_access_ioctl(HVAC_STORAGE_DISK, DISK_IOCTL_GET_SECTOR_SIZE, &size) == 0) {
+        shell_print(sh, "Card:    %u sectors x %u B = %u MB", count, size,
+                    (uint32_t)(((uint64_t)count * size) >> 20));
+    }
+
+    int ret = fs_statvfs(HVAC_STORAGE_MNT, &st);
+    if (ret < 0) {
+        shell_error(sh, "fs_statvfs failed: %d", ret);
+        return ret;
+    }
+
+    uint64_t total = (uint64_t)st.f_frsize * st.f_blocks;
+    uint64_t avail = (uint64_t)st.f_frsize * st.f_bfree;
+
+    shell_print(sh, "Mount:   %s, cluster %u B", HVAC_STORAGE_MNT, (uint32_t)st.f_frsize);
+    shell_print(sh, "Total:   %u MB", (uint32_t)(total >> 20));
+    shell_print(sh, "Free:    %u MB", (uint32_t)(avail >> 20));
+    shell_print(sh, "Used:    %u MB", (uint32_t)((total - avail) >> 20));
+    return 0;
+}
+
+static int cmd_sd_bench_seq(const struct shell *sh, size_t argc, char **argv)
+{
+    size_t lo, hi;
+    int ret = hvac_sd_check_ready(sh);
+
+    if (ret == 0) {
+        ret = hvac_sd_parse_block(sh, argc, argv, &lo, &hi);
+    }
+    if (ret != 0) {
+        return ret;
+    }
+
+    shell_print(sh, "Sequential, %u KB file", CONFIG_HVAC_SD_BENCH_FILE_KB);
+    hvac_sd_fill(0);
+    for (size_t b = lo; b <= hi && ret == 0; b <<= 1) {
+        ret = hvac_sd_seq_write(sh, b, lo == hi);
+        if (ret == 0) {
+            ret = hvac_sd_seq_read(sh, b, lo == hi);
+        }
+    }
+    return ret;
+}
+
+static int cmd_sd_bench_rand(const struct shell *sh, size_t argc, char **argv)
+{
+    struct fs_dirent ent;
+    size_t lo, hi;
+    int ret = hvac_sd_check_ready(sh);
+
+    if (ret == 0) {
+        ret = hvac_sd_parse_block(sh, argc, argv, &lo, &hi);
+    }
+    if (ret != 0) {
+        return ret;
+    }
+
+    /* plik testowy musi mieć pełny rozmiar, inaczej losowe pozycje wyjdą poza koniec */
+    if (fs_stat(HVAC_SD_BENCH_FILE, &ent) != 0 || ent.size < HVAC_SD_BENCH_FILE_SIZE) {
+        hvac_sd_fill(0);
+        ret = hvac_sd_seq_write(sh, HVAC_SD_BENCH_MAX_BLOCK, false);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+
+    shell_print(sh, "Random, %u ops per size in %u KB file",
+                CONFIG_HVAC_SD_BENCH_RAND_OPS, CONFIG_HVAC_SD_BENCH_FILE_KB);
+    for (size_t b = lo; b <= hi && ret == 0; b <<= 1) {
+        ret = hvac_sd_rand_rw(sh, b, false, lo == hi);
+        if (ret == 0) {
+            ret = hvac_sd_rand_rw(sh, b, true, lo == hi);
+        }
+    }
+    return ret;
+}
+
+static int cmd_sd_bench_append(const struct shell *sh, size_t argc, char **argv)
+{
+#if defined(CONFIG_HVAC_LOG)
+    size_t block = CONFIG_HVAC_LOG_BUF_SIZE;
+#else
+    size_t block = 4096;
+#endif
+    uint32_t count = CONFIG_HVAC_SD_BENCH_FILE_KB * 1024 / block;
+    /* logger przy kodowaniu delta zapełnia blok wolniej niż co SYNC_MS - sync po każdym */
+    uint32_t sync_every = 1;
+    int err = 0;
+    int ret = hvac_sd_check_ready(sh);
+
+    if (ret != 0) {
+        return ret;
+    }
+
+    if (argc > 1) {
+        block = shell_strtoul(argv[1], 0, &err);
+    }
+    if (argc > 2) {
+        sync_every = shell_strtoul(argv[2], 0, &err);
+    }
+    if (argc > 3) {
+        count = shell_strtoul(argv[3], 0, &err);
+    }
+    if (err != 0 || block == 0 || block > HVAC_SD_BENCH_MAX_BLOCK || count == 0) {
+        shell_error(sh, "Usage: sd bench append [block<=%u] [sync_every] [count]",
+                    HVAC_SD_BENCH_MAX_BLOCK);
+        return -EINVAL;
+    }
+
+    return hvac_sd_append(sh, block, count, sync_every);
+}
+
+static int cmd_sd_bench_all(const struct shell *sh, size_t argc, char **argv)
+{
+    int ret;
+
+    char *none[] = { argv[0] };
+
+    ARG_UNUSED(argc);
+
+    ret = cmd_sd_bench_seq(sh, 1, none);
+    if (ret == 0) {
+        ret = cmd_sd_bench_rand(sh, 1, none);
+    }
+    if (ret == 0) {
+        ret = cmd_sd_bench_append(sh, 1, none);
+    }
+
+    (void)fs_unlink(HVAC_SD_BENCH_FILE);
+    return ret;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(hvac_sd_bench_cmds,
+    SHELL_CMD_ARG(seq, NULL, "Sequential write/read [block]", cmd_sd_bench_seq, 1, 1),
+    SHELL_CMD_ARG(rand, NULL, "Random read/write [block]", cmd_sd_bench_rand, 1, 1),
+    SHELL_CMD_ARG(append, NULL, "Logger pattern [block] [sync_every] [count]",
+                  cmd_sd_bench_append, 1, 3),
+    SHELL_CMD(all, NULL, "All tests, all block sizes", cmd_sd_bench_all),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_STATIC_SUBCMD_SET_CREATE(hvac_sd_cmds,
+    SHELL_CMD(info, NULL, "Card and filesystem information", cmd_sd_info),
+    SHELL_CMD(bench, &hvac_sd_bench_cmds, "Card benchmarks", NULL),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(sd, &hvac_sd_cmds, "SD card", NULL);
@@ -0,0 +1,604 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/base64.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hvac_cfg_upload.h"
+#include "hvac_io.h"
+#include "hvac_shell.h"
+
+LOG_MODULE_REGISTER(hvac_shell, CONFIG_LOG_DEFAULT_LEVEL);
+
+static const struct hvac_shell_ops *hvac_shell_ops;
+
+#define HVAC_SHELL_F_NAME(id, path, member, min, max) path,
+
+static const char *const hvac_shell_field_names[HVAC_CFG_NUM_INT_FIELDS] = {
+    HVAC_CFG_INT_FIELDS(HVAC_SHELL_F_NAME)
+};
+
+/* --- Pomocnicze --- */
+
+static int hvac_shell_ready(const struct shell *sh)
+{
+    if (hvac_shell_ops == NULL) {
+        shell_error(sh, "Controller not started");
+        return -EAGAIN;
+    }
+    return 0;
+}
+
+static int hvac_shell_int(const struct shell *sh, const char *s, long min, long max, long *out)
+{
+    char *end;
+    long v = strtol(s, &end, 0);
+
+    if (end == s || *end != '\0' || v < min || v > max) {
+        shell_error(sh, "Invalid value '%s' (%ld..%ld)", s, min, max);
+        return -EINVAL;
+    }
+    *out = v;
+    return 0;
+}
+
+static int hvac_shell_float(const struct shell *sh, const char *s, float *out)
+{
+    char *end;
+    float v = strtof(s, &end);
+
+    if (end == s || *end != '\0') {
+        shell_error(sh, "Invalid number '%s'", s);
+        return -EINVAL;
+    }
+    *out = v;
+    return 0;
+}
+
+/* liczby przez snprintf jak etykiety UI - shell_print (cbprintf) może nie mieć %f */
+static void hvac_shell_milli(char *buf, size_t len, float v)
+{
+    snprintf(buf, len, "%.3f", (double)v);
+}
+
+/* zmiana kilku pól naraz: jedna walidacja, jeden zapis */
+static int hvac_shell_set_fields(const struct shell *sh, const enum hvac_cfg_field_id *ids,
+                                 const long *vals, size_t n)
+{
+    struct hvac_config cfg;
+
+    hvac_shell_ops->get_cfg(&cfg);
+    for (size_t i = 0; i < n; i++) {
+        *hvac_cfg_field(&cfg, ids[i]) = (int32_t)vals[i];
+    }
+
+    if (!hvac_cfg_validate(&cfg)) {
+        shell_error(sh, "Rejected: value out of range or band from > to");
+        return -EINVAL;
+    }
+
+    hvac_shell_ops->set_cfg(&cfg);
+    shell_print(sh, "OK, applied on the next UI cycle");
+    return 0;
+}
+
+/* --- hvac io --- */
+
+static int cmd_hvac_io(const struct shell *sh, size_t argc, char **argv)
+{
+    struct hvac_io_image img;
+    char v[16];
+
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    hvac_io_snapshot(&img);
+
+    uint32_t age_ms = (uint32_t)k_ticks_to_ms_floor64(k_uptime_ticks() - img.ai_ts_ticks);
+
+    shell_print(sh, "frame %u, inputs %u ms old", img.frame, age_ms);
+
+    for (int i = 0; i < MAX(HVAC_NUM_AI_CHANNELS, HVAC_NUM_AO_CHANNELS); i++) {
+        char ai[16] = "";
+        char ao[16] = "";
+
+        if (i < HVAC_NUM_AI_CHANNELS) {
+            hvac_shell_milli(ai, sizeof(ai), img.ai_v[i]);
+        }
+        if (i < HVAC_NUM_AO_CHANNELS) {
+            hvac_shell_milli(ao, sizeof(ao), img.ao_v[i]);
+        }
+        shell_print(sh, "  ai%d %8s V    ao%d %8s V%s", i, ai, i, ao,
+                    (img.ao_forced & BIT(i)) ? "  FORCED" : "");
+    }
+
+#if HVAC_NUM_EXT_CHANNELS > 0
+    for (int i = 0; i < HVAC_NUM_EXT_CHANNELS; i++) {
+        hvac_shell_milli(v, sizeof(v), img.ext_v[i]);
+        shell_print(sh, "  ai%d %8s%s", HVAC_NUM_AI_CHANNELS + i, v,
+                    (img.ext_valid & BIT(i)) ? "" : "  STALE");
+    }
+#endif
+
+    if (hvac_shell_ops != NULL) {
+        struct hvac_shell_ctl ctl;
+        char u[16];
+
+        hvac_shell_ops->get_ctl(&ctl);
+        hvac_shell_milli(u, sizeof(u), ctl.u_pct);
+        hvac_shell_milli(v, sizeof(v), ctl.i_term);
+        shell_print(sh, "u %s %%, integrator %s %%", u, v);
+    }
+    return 0;
+}
+
+/* --- hvac ao --- */
+
+static int cmd_hvac_ao_force(const struct shell *sh, size_t argc, char **argv)
+{
+    long ch;
+    long timeout_s = CONFIG_HVAC_SHELL_FORCE_TIMEOUT_S;
+    float v;
+
+    if (hvac_shell_int(sh, argv[1], 0, HVAC_NUM_AO_CHANNELS - 1, &ch) != 0 ||
+        hvac_shell_float(sh, argv[2], &v) != 0) {
+        return -EINVAL;
+    }
+    if (argc > 3 && hvac_shell_int(sh, argv[3], 1, CONFIG_HVAC_SHELL_FORCE_MAX_S,
+                                   &timeout_s) != 0) {
+        return -EINVAL;
+    }
+    if (v < 0.0f || v > 10.0f) {
+        shell_error(sh, "Output range is 0..10 V");
+        return -EINVAL;
+    }
+
+    int ret = hvac_io_force_ao(ch, v, timeout_s * MSEC_PER_SEC);
+    if (ret != 0) {
+        return ret;
+    }
+
+    shell_print(sh, "ao%ld forced for %ld s", ch, timeout_s);
+    return 0;
+}
+
+static int cmd_hvac_ao_release(const struct shell *sh, size_t argc, char **argv)
+{
+    long ch = -1;
+
+    if (argc > 1 && strcmp(argv[1], "all") != 0 &&
+        hvac_shell_int(sh, argv[1], 0, HVAC_NUM_AO_CHANNELS - 1, &ch) != 0) {
+        return -EINVAL;
+    }
+
+    hvac_io_release_ao(ch);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(hvac_ao_cmds,
+    SHELL_CMD_ARG(force, NULL,
+        "Override an output: force <ch> <volts> [timeout_s]", cmd_hvac_ao_force, 3, 1),
+    SHELL_CMD_ARG(release, NULL,
+        "Return outputs to the controller: release [ch|all]", cmd_hvac_ao_release, 1, 1),
+    SHELL_SUBCMD_SET_END
+);
+
+/* --- hvac cfg / set / sp / band / gains --- */
+
+static int cmd_hvac_cfg(const struct shell *sh, size_t argc, char **argv)
+{
+    struct hvac_config cfg;
+
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    int ret = hvac_shell_ready(sh);
+    if (ret != 0) {
+        return ret;
+    }
+
+    hvac_shell_ops->get_cfg(&cfg);
+
+    shell_print(sh, "sequence_type %s", cfg.sequence_type);
+    for (int i = 0; i < HVAC_CFG_NUM_INT_FIELDS; i++) {
+        shell_print(sh, "%-32s %d", hvac_shell_field_names[i], *hvac_cfg_field(&cfg, i));
+    }
+    return 0;
+}
+
+static int cmd_hvac_set(const struct shell *sh, size_t argc, char **argv)
+{
+    long v;
+
+    ARG_UNUSED(argc);
+
+    int ret = hvac_shell_ready(sh);
+    if (ret != 0) {
+        return ret;
+    }
+
+    for (int i = 0; i < HVAC_CFG_NUM_INT_FIELDS; i++) {
+        if (strcmp(argv[1], hvac_shell_field_names[i]) == 0) {
+            enum hvac_cfg_field_id id = i;
+
+            if (hvac_shell_int(sh, argv[2], INT32_MIN, INT32_MAX, &v) != 0) {
+                return -EINVAL;
+            }
+            return hvac_shell_set_fields(sh, &id, &v, 1);
+        }
+    }
+
+    shell_error(sh, "Unknown field '%s' (see 'hvac cfg')", argv[1]);
+    return -ENOENT;
+}
+
+static int cmd_hvac_sp(const struct shell *sh, size_t argc, char **argv)
+{
+    static const enum hvac_cfg_field_id id = HVAC_CFG_F_SETPOINT;
+    struct hvac_config cfg;
+    long v;
+
+    int ret = hvac_shell_ready(sh);
+    if (ret != 0) {
+        return ret;
+    }
+
+    if (argc < 2) {
+        hvac_shell_ops->get_cfg(&cfg);
+        shell_print(sh, "setpoint %d", cfg.setpoint);
+        return 0;
+    }
+
+    if (hvac_shell_int(sh, argv[1], INT32_MIN, INT32_MAX, &v) != 0) {
+        return -EINVAL;
+    }
+    return hvac_shell_set_fields(sh, &id, &v, 1);
+}
+
+static int cmd_hvac_band(const struct shell *sh, size_t argc, char **argv)
+{
+    static const struct {
+        const char *name;
+        enum hvac_cfg_field_id from;
+    } bands[] = {
+        { "cooling",       HVAC_CFG_F_SEQ_COOL_FROM },
+        { "heating",       HVAC_CFG_F_SEQ_HEAT_FROM },
+        { "heat_recovery", HVAC_CFG_F_SEQ_REC_FROM  },
+        { "deadband",      HVAC_CFG_F_SEQ_DEAD_FROM },
+    };
+    long v[2];
+
+    ARG_UNUSED(argc);
+
+    int ret = hvac_shell_ready(sh);
+    if (ret != 0) {
+        return ret;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(bands); i++) {
+        if (strcmp(argv[1], bands[i].name) != 0) {
+            continue;
+        }
+        /* to_percent jest zawsze tuż za from_percent na liście pól */
+        const enum hvac_cfg_field_id ids[2] = { bands[i].from, bands[i].from + 1 };
+
+        if (hvac_shell_int(sh, argv[2], -100, 100, &v[0]) != 0 ||
+            hvac_shell_int(sh, argv[3], -100, 100, &v[1]) != 0) {
+            return -EINVAL;
+        }
+        return hvac_shell_set_fields(sh, ids, v, 2);
+    }
+
+    shell_error(sh, "Unknown band '%s' (cooling, heating, heat_recovery, deadband)", argv[1]);
+    return -ENOENT;
+}
+
+static int cmd_hvac_gains(const struct shell *sh, size_t argc, char **argv)
+{
+    static const enum hvac_cfg_field_id ids[3] = {
+        HVAC_CFG_F_PID_KP, HVAC_CFG_F_PID_KI, HVAC_CFG_F_PID_KD,
+    };
+    long v[3];
+
+    ARG_UNUSED(argc);
+
+    int ret = hvac_shell_ready(sh);
+    if (ret != 0) {
+        return ret;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        if (hvac_shell_int(sh, argv[1 + i], 0, INT16_MAX, &v[i]) != 0) {
+            return -EINVAL;
+        }
+    }
+    return hvac_shell_set_fields(sh, ids, v, 3);
+}
+
+/* --- hvac upload --- */
+
+/*
+ * Config z hosta porcjami base64 (scripts/hvac_cfg_upload.py). Porcja
+ * mieści się w linii powłoki i od razu trafia do parsera - cały plik
+ * nigdy nie leży w RAM-ie. "ok" po każdej porcji to potwierdzenie dla
+ * hosta, bez niego UART konsoli gubiłby znaki.
+ */
+static int cmd_hvac_upload_begin(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    struct hvac_config cfg;
+
+    int ret = hvac_shell_ready(sh);
+    if (ret != 0) {
+        return ret;
+    }
+
+    hvac_shell_ops->get_cfg(&cfg);
+    ret = hvac_cfg_upload_begin(sh, &cfg);
+    if (ret != 0) {
+        shell_error(sh, "Another upload in progress");
+        return ret;
+    }
+
+    shell_print(sh, "ok");
+    return 0;
+}
+
+static int cmd_hvac_upload_put(const struct shell *sh, size_t argc, char **argv)
+{
+    uint8_t buf[CONFIG_SHELL_CMD_BUFF_SIZE * 3 / 4 + 3];
+    size_t n;
+
+    ARG_UNUSED(argc);
+
+    if (base64_decode(buf, sizeof(buf), &n,
+                      (const uint8_t *)argv[1], strlen(argv[1])) != 0) {
+        shell_error(sh, "Bad base64");
+        return -EINVAL;
+    }
+
+    int ret = hvac_cfg_upload_feed(sh, (const char *)buf, n);
+    if (ret == -EPERM) {
+        shell_error(sh, "No upload in progress");
+        return ret;
+    }
+    if (ret < 0) {
+        shell_error(sh, "JSON error: %d", ret);
+        return ret;
+    }
+
+    shell_print(sh, "ok");
+    return 0;
+}
+
+static int cmd_hvac_upload_commit(const struct shell *sh, size_t argc, char **argv)
+{
+    struct hvac_config cfg;
+
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    int ret = hvac_cfg_upload_commit(sh, &cfg);
+    switch (ret) {
+    case -EPERM:
+        shell_error(sh, "No upload in progress");
+        return ret;
+    case -ERANGE:
+        shell_error(sh, "Rejected: value out of range or band from > to");
+        return ret;
+    default:
+        if (ret < 0) {
+            shell_error(sh, "Rejected: invalid or truncated JSON");
+            return ret;
+        }
+        break;
+    }
+
+    hvac_shell_ops->set_cfg(&cfg);
+    shell_print(sh, "ok %d fields, applied on the next UI cycle", ret);
+    return 0;
+}
+
+static int cmd_hvac_upload_abort(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    hvac_cfg_upload_abort(sh);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(hvac_upload_cmds,
+    SHELL_CMD(begin, NULL, "Start a config upload", cmd_hvac_upload_begin),
+    SHELL_CMD_ARG(put, NULL, "Feed a base64 chunk: put <base64>", cmd_hvac_upload_put, 2, 0),
+    SHELL_CMD(commit, NULL, "Validate and apply the uploaded config", cmd_hvac_upload_commit),
+    SHELL_CMD(abort, NULL, "Drop the upload", cmd_hvac_upload_abort),
+    SHELL_SUBCMD_SET_END
+);
+
+/* --- hvac watch --- */
+
+/*
+ * Wypisywanie z kolejki systemowej co zadany okres; powłoka zostaje
+ * wolna, "hvac watch off" kończy. Pozycje: ai<n>, ao<n>, u, i, frame.
+ */
+enum hvac_watch_kind {
+    HVAC_WATCH_AI,
+    HVAC_WATCH_AO,
+    HVAC_WATCH_U,
+    HVAC_WATCH_I,
+    HVAC_WATCH_FRAME,
+};
+
+struct hvac_watch_item {
+    uint8_t kind;
+    uint8_t ch;
+};
+
+static struct {
+    const struct shell    *sh;
+    struct hvac_watch_item items[CONFIG_HVAC_SHELL_WATCH_ITEMS];
+    size_t                 count;
+    uint32_t               period_ms;
+    int64_t                next_ms;
+} hvac_watch;
+
+static void hvac_watch_fn(struct k_work *work)
+{
+    struct hvac_io_image img;
+    struct hvac_shell_ctl ctl = { 0 };
+    char line[CONFIG_HVAC_SHELL_WATCH_ITEMS * 20 + 16];
+    int pos;
+
+    hvac_io_snapshot(&img);
+    if (hvac_shell_ops != NULL) {
+        hvac_shell_ops->get_ctl(&ctl);
+    }
+
+    pos = snprintf(line, sizeof(line), "%u", k_uptime_get_32());
+
+    for (size_t i = 0; i < hvac_watch.count && pos < (int)sizeof(line); i++) {
+        const struct hvac_watch_item *it = &hvac_watch.items[i];
+        char v[16];
+
+        switch (it->kind) {
+        case HVAC_WATCH_AI:
+#if HVAC_NUM_EXT_CHANNELS > 0
+            if (it->ch >= HVAC_NUM_AI_CHANNELS) {
+                hvac_shell_milli(v, sizeof(v), img.ext_v[it->ch - HVAC_NUM_AI_CHANNELS]);
+                break;
+            }
+#endif
+            hvac_shell_milli(v, sizeof(v), img.ai_v[it->ch]);
+            break;
+        case HVAC_WATCH_AO:
+            hvac_shell_milli(v, sizeof(v), img.ao_v[it->ch]);
+            break;
+        case HVAC_WATCH_U:
+            hvac_shell_milli(v, sizeof(v), ctl.u_pct);
+            break;
+        case HVAC_WATCH_I:
+            hvac_shell_milli(v, sizeof(v), ctl.i_term);
+            break;
+        default:
+            snprintf(v, sizeof(v), "%u", img.frame);
+            break;
+        }
+        pos += snprintf(&line[pos], sizeof(line) - pos, " %s", v);
+    }
+
+    shell_print(hvac_watch.sh, "%s", line);
+
+    /* stały okres - czas wypisywania nie przesuwa kolejnych próbek */
+    hvac_watch.next_ms += hvac_watch.period_ms;
+    (void)k_work_schedule(k_work_delayable_from_work(work),
+                          K_TIMEOUT_ABS_MS(hvac_watch.next_ms));
+}
+
+static K_WORK_DELAYABLE_DEFINE(hvac_watch_work, hvac_watch_fn);
+
+static int hvac_watch_parse(const struct shell *sh, const char *s, struct hvac_watch_item *it)
+{
+    long ch;
+
+    if (strcmp(s, "u") == 0) {
+        it->kind = HVAC_WATCH_U;
+    } else if (strcmp(s, "i") == 0) {
+        it->kind = HVAC_WATCH_I;
+    } else if (strcmp(s, "frame") == 0) {
+        it->kind = HVAC_WATCH_FRAME;
+    } else if (strncmp(s, "ai", 2) == 0) {
+        if (hvac_shell_int(sh, &s[2], 0, HVAC_NUM_AI_INPUTS - 1, &ch) != 0) {
+            return -EINVAL;
+        }
+        it->kind = HVAC_WATCH_AI;
+        it->ch = ch;
+    } else if (strncmp(s, "ao", 2) == 0) {
+        if (hvac_shell_int(sh, &s[2], 0, HVAC_NUM_AO_CHANNELS - 1, &ch) != 0) {
+            return -EINVAL;
+        }
+        it->kind = HVAC_WATCH_AO;
+        it->ch = ch;
+    } else {
+        shell_error(sh, "Unknown item '%s' (ai<n>, ao<n>, u, i, frame)", s);
+        return -EINVAL;
+    }
+    return 0;
+}
+
+static int cmd_hvac_watch(const struct shell *sh, size_t argc, char **argv)
+{
+    struct k_work_sync sync;
+    long period;
+
+    if (strcmp(argv[1], "off") == 0) {
+        (void)k_work_cancel_delayable_sync(&hvac_watch_work, &sync);
+        return 0;
+    }
+
+    if (argc < 3) {
+        shell_error(sh, "Usage: hvac watch <period_ms> <item>... | hvac watch off");
+        return -EINVAL;
+    }
+    if (argc - 2 > CONFIG_HVAC_SHELL_WATCH_ITEMS) {
+        shell_error(sh, "At most %d items", CONFIG_HVAC_SHELL_WATCH_ITEMS);
+        return -EINVAL;
+    }
+    if (hvac_shell_int(sh, argv[1], CONFIG_HVAC_SHELL_WATCH_MIN_MS, 60000, &period) != 0) {
+        return -EINVAL;
+    }
+
+    /* poprzedni watch kończy się przed nadpisaniem listy */
+    (void)k_work_cancel_delayable_sync(&hvac_watch_work, &sync);
+
+    for (size_t i = 2; i < argc; i++) {
+        if (hvac_watch_parse(sh, argv[i], &hvac_watch.items[i - 2]) != 0) {
+            return -EINVAL;
+        }
+    }
+
+    hvac_watch.sh        = sh;
+    hvac_watch.count     = argc - 2;
+    hvac_watch.period_ms = period;
+    hvac_watch.next_ms   = k_uptime_get();
+
+    shell_fprintf(sh, SHELL_NORMAL, "t_ms");
+    for (size_t i = 2; i < argc; i++) {
+        shell_fprintf(sh, SHELL_NORMAL, " %s", argv[i]);
+    }
+    shell_print(sh, "    ('hvac watch off' stops)");
+    (void)k_work_schedule(&hvac_watch_work, K_NO_WAIT);
+    return 0;
+}
+
+/* --- Rejestracja --- */
+
+SHELL_STATIC_SUBCMD_SET_CREATE(hvac_cmds,
+    SHELL_CMD(io, NULL, "Process image, forced outputs and controller output", cmd_hvac_io),
+    SHELL_CMD(ao, &hvac_ao_cmds, "Force or release analog outputs", NULL),
+    SHELL_CMD(cfg, NULL, "Show the configuration", cmd_hvac_cfg),
+    SHELL_CMD_ARG(set, NULL, "Set a field: set <field> <value>", cmd_hvac_set, 3, 0),
+    SHELL_CMD_ARG(sp, NULL, "Show or set the setpoint: sp [value]", cmd_hvac_sp, 1, 1),
+    SHELL_CMD_ARG(band, NULL, "Set a sequence band: band <name> <from> <to>",
+                  cmd_hvac_band, 4, 0),
+    SHELL_CMD_ARG(gains, NULL, "Set PID gains: gains <kp> <ki> <kd>", cmd_hvac_gains, 4, 0),
+    SHELL_CMD(upload, &hvac_upload_cmds, "Upload a JSON config in chunks", NULL),
+    SHELL_CMD_ARG(watch, NULL, "Stream values: watch <period_ms> <item>... | watch off",
+                  cmd_hvac_watch, 2, CONFIG_HVAC_SHELL_WATCH_ITEMS),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(hvac, &hvac_cmds, "HVAC controller", NULL);
+
+/* --- API --- */
+
+void hvac_shell_init(const struct hvac_shell_ops *ops)
+{
+    hvac_shell_ops = ops;
+}
@@ -0,0 +1,29 @@
+#ifndef HVAC_SHELL_H
+#define HVAC_SHELL_H
+
+#include "hvac_config.h"
+
+/*
+ * Komendy powłoki "hvac": obraz procesu, wymuszanie AO, zmiana nastaw
+ * w locie i "watch". Stan wejść i wyjść pochodzi wyłącznie z
+ * hvac_io_snapshot() - powłoka nie generuje ruchu na magistrali i nie
+ * czeka na pętlę regulacji. Zmiany configu idą tą samą drogą co zapisy
+ * z Modbus/HTTP: walidacja, potem hvac_apply_config() w wątku UI.
+ */
+
+/* wyjście regulatora z ostatniego kroku */
+struct hvac_shell_ctl {
+    float u_pct;
+    float i_term;
+};
+
+struct hvac_shell_ops {
+    void (*get_cfg)(struct hvac_config *out);
+    void (*set_cfg)(const struct hvac_config *cfg);
+    void (*get_ctl)(struct hvac_shell_ctl *out);
+};
+
+/* do tego czasu komendy odpowiadają -EAGAIN */
+void hvac_shell_init(const struct hvac_shell_ops *ops);
+
+#endif /* HVAC_SHELL_H */
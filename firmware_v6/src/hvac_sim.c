@@ -0,0 +1,391 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+#include <math.h>
+#include <string.h>
+
+#include "hvac_io.h"
+#include "hvac_io_backend.h"
+#include "hvac_sim.h"
+
+LOG_MODULE_REGISTER(hvac_sim, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define HVAC_SIM_STEP_S     0.1f
+#define HVAC_SIM_STEPS_PER_S 10U
+#define HVAC_SIM_DELAY_LEN  ((CONFIG_HVAC_SIM_MAX_DEAD_TIME_S * 10) + 1)
+#define HVAC_SIM_MAX_DT_S   10.0f
+#define HVAC_SIM_PI         3.14159265f
+
+/* linia opóźniająca dla części "dead time" */
+struct hvac_sim_delay {
+    float    buf[HVAC_SIM_DELAY_LEN];
+    uint32_t head;
+};
+
+static struct hvac_sim_params hvac_sim_params = {
+    .tau_supply_s  = 60.0f,
+    .dead_supply_s = 5.0f,
+    .tau_room_s    = 900.0f,
+    .dead_room_s   = 30.0f,
+    .tau_exhaust_s = 20.0f,
+
+    .heater_gain_c = 25.0f,
+    .cooler_gain_c = 12.0f,
+    .hr_efficiency = 0.75f,
+    .vent_coeff    = 3.0f,
+    .fan_min_flow  = 0.1f,
+};
+
+static struct hvac_sim_disturbance hvac_sim_dist = {
+    .t_out_mean_c    = 5.0f,
+    .t_out_amp_c     = 4.0f,
+    .t_out_period_s  = 86400.0f,
+    .t_out_step_c    = 0.0f,
+    .internal_gain_c = 3.0f,
+    .noise_c         = 0.05f,
+};
+
+static struct hvac_io_cfg      hvac_sim_io;
+static struct hvac_sim_state   hvac_sim_st;
+static struct hvac_sim_delay   hvac_sim_supply_delay;
+static struct hvac_sim_delay   hvac_sim_room_delay;
+static float                   hvac_sim_ao_v[HVAC_NUM_AO_CHANNELS];
+static float                   hvac_sim_dt_acc;
+static uint32_t                hvac_sim_rng = CONFIG_HVAC_SIM_SEED;
+static struct k_spinlock       hvac_sim_lock;
+
+static struct {
+    struct hvac_sim_summary sum;
+    float setpoint_c;
+    float band_c;
+    float dir;                /* +1 nagrzewanie, -1 schładzanie */
+    uint64_t t0_steps;
+    float last_pct[HVAC_SIM_ACT_COUNT];
+} hvac_sim_stats;
+
+static void hvac_sim_delay_fill(struct hvac_sim_delay *d, float v)
+{
+    for (int i = 0; i < HVAC_SIM_DELAY_LEN; i++) {
+        d->buf[i] = v;
+    }
+    d->head = 0;
+}
+
+/* wpisuje bieżącą próbkę i zwraca próbkę sprzed dead_s */
+static float hvac_sim_delay_push(struct hvac_sim_delay *d, float v, float dead_s)
+{
+    uint32_t n = (uint32_t)(dead_s / HVAC_SIM_STEP_S + 0.5f);
+    if (n >= HVAC_SIM_DELAY_LEN) {
+        n = HVAC_SIM_DELAY_LEN - 1;
+    }
+
+    d->buf[d->head] = v;
+    uint32_t idx = (d->head + HVAC_SIM_DELAY_LEN - n) % HVAC_SIM_DELAY_LEN;
+    d->head = (d->head + 1) % HVAC_SIM_DELAY_LEN;
+
+    return d->buf[idx];
+}
+
+static float hvac_sim_lag(float y, float u, float tau_s)
+{
+    if (tau_s <= HVAC_SIM_STEP_S) {
+        return u;
+    }
+    return y + (u - y) * (HVAC_SIM_STEP_S / tau_s);
+}
+
+/* xorshift32 - deterministyczny szum, powtarzalne przebiegi */
+static float hvac_sim_noise(float amp)
+{
+    hvac_sim_rng ^= hvac_sim_rng << 13;
+    hvac_sim_rng ^= hvac_sim_rng >> 17;
+    hvac_sim_rng ^= hvac_sim_rng << 5;
+
+    float r = (float)(hvac_sim_rng & 0xFFFF) / 32767.5f - 1.0f;
+    return r * amp;
+}
+
+static float hvac_sim_ao_pct(int32_t ch)
+{
+    if (ch < 0 || ch >= HVAC_NUM_AO_CHANNELS) {
+        return -1.0f;
+    }
+
+    float pct = hvac_sim_ao_v[ch] * 10.0f;
+    return CLAMP(pct, 0.0f, 100.0f);
+}
+
+static float hvac_sim_outdoor(uint64_t step)
+{
+    const struct hvac_sim_disturbance *d = &hvac_sim_dist;
+    float t_out = d->t_out_mean_c + d->t_out_step_c;
+    uint64_t period = (uint64_t)(d->t_out_period_s * HVAC_SIM_STEPS_PER_S + 0.5f);
+
+    if (period > 0) {
+        /* faza z licznika kroków - bez utraty precyzji przy długich przebiegach */
+        float t = (float)(step % period) * HVAC_SIM_STEP_S;
+
+        /* minimum o 3:00, maksimum o 15:00 */
+        t_out -= d->t_out_amp_c * cosf(2.0f * HVAC_SIM_PI * (t - 3.0f * 3600.0f) /
+                                       d->t_out_period_s);
+    }
+
+    return t_out;
+}
+
+static void hvac_sim_stats_update(void)
+{
+    const struct hvac_sim_state *st = &hvac_sim_st;
+    struct hvac_sim_summary *sum = &hvac_sim_stats.sum;
+    const float pct[HVAC_SIM_ACT_COUNT] = {
+        st->heater_pct, st->cooler_pct, st->bypass_pct, st->fan_pct,
+    };
+
+    float err = st->t_extract_c - hvac_sim_stats.setpoint_c;
+
+    sum->duration_s = (float)(st->steps - hvac_sim_stats.t0_steps) * HVAC_SIM_STEP_S;
+    sum->iae_ch += fabsf(err) * (HVAC_SIM_STEP_S / 3600.0);
+
+    if (fabsf(err) > hvac_sim_stats.band_c) {
+        sum->settling_time_s = -1.0f;
+    } else if (sum->settling_time_s < 0.0f) {
+        sum->settling_time_s = sum->duration_s;
+    }
+
+    if (err * hvac_sim_stats.dir > sum->overshoot_c) {
+        sum->overshoot_c = err * hvac_sim_stats.dir;
+    }
+
+    for (int i = 0; i < HVAC_SIM_ACT_COUNT; i++) {
+        sum->travel_pct[i] += fabsf(pct[i] - hvac_sim_stats.last_pct[i]);
+        hvac_sim_stats.last_pct[i] = pct[i];
+    }
+
+    /* bypass to tylko przepustnica - energia ~0, wentylator: moc ~ przepływ^3 */
+    const double dt_h = HVAC_SIM_STEP_S / 3600.0;
+    float fan = pct[HVAC_SIM_ACT_FAN] / 100.0f;
+
+    sum->energy_h[HVAC_SIM_ACT_HEATER] += pct[HVAC_SIM_ACT_HEATER] / 100.0f * dt_h;
+    sum->energy_h[HVAC_SIM_ACT_COOLER] += pct[HVAC_SIM_ACT_COOLER] / 100.0f * dt_h;
+    sum->energy_h[HVAC_SIM_ACT_FAN]    += fan * fan * fan * dt_h;
+}
+
+static void hvac_sim_substep(void)
+{
+    const struct hvac_sim_params *p = &hvac_sim_params;
+    struct hvac_sim_state *st = &hvac_sim_st;
+
+    float heat = hvac_sim_ao_pct(hvac_sim_io.heater_ao);
+    float cool = hvac_sim_ao_pct(hvac_sim_io.cooler_ao);
+    float hr   = hvac_sim_ao_pct(hvac_sim_io.bypass_ao);
+    float fan  = hvac_sim_ao_pct(hvac_sim_io.fan_vfd_ao);
+
+    st->heater_pct = MAX(heat, 0.0f);
+    st->cooler_pct = MAX(cool, 0.0f);
+    st->bypass_pct = MAX(hr, 0.0f);
+    /* brak falownika w konfiguracji = wentylator zawsze na 100 % */
+    st->fan_pct    = (fan < 0.0f) ? 100.0f : fan;
+
+    float flow = p->fan_min_flow + (1.0f - p->fan_min_flow) * st->fan_pct / 100.0f;
+    float eta  = p->hr_efficiency * st->bypass_pct / 100.0f;
+
+    st->t_outdoor_c = hvac_sim_outdoor(st->steps);
+
+    /* nawiew: odzysk + nagrzewnica/chłodnica, przyrost odwrotnie prop. do przepływu */
+    float t_after_hr = st->t_outdoor_c + eta * (st->t_extract_c - st->t_outdoor_c);
+    float t_sup_ss = t_after_hr +
+                     (p->heater_gain_c * st->heater_pct -
+                      p->cooler_gain_c * st->cooler_pct) / (100.0f * flow);
+    t_sup_ss = hvac_sim_delay_push(&hvac_sim_supply_delay, t_sup_ss, p->dead_supply_s);
+    st->t_supply_c = hvac_sim_lag(st->t_supply_c, t_sup_ss, p->tau_supply_s);
+
+    /* pomieszczenie: bilans wentylacja / straty / zyski wewnętrzne */
+    float g_vent = p->vent_coeff * flow;
+    float t_room_ss = (g_vent * st->t_supply_c + st->t_outdoor_c +
+                       hvac_sim_dist.internal_gain_c) / (g_vent + 1.0f);
+    t_room_ss = hvac_sim_delay_push(&hvac_sim_room_delay, t_room_ss, p->dead_room_s);
+    st->t_extract_c = hvac_sim_lag(st->t_extract_c, t_room_ss, p->tau_room_s);
+
+    /* wyrzut: wyciąg oddaje na wymienniku tyle, ile przejął nawiew */
+    float t_exh_ss = st->t_extract_c - eta * (st->t_extract_c - st->t_outdoor_c);
+    st->t_exhaust_c = hvac_sim_lag(st->t_exhaust_c, t_exh_ss, p->tau_exhaust_s);
+
+    st->steps++;
+    st->time_s = (float)st->steps * HVAC_SIM_STEP_S;
+
+    hvac_sim_stats_update();
+}
+
+void hvac_sim_step(float dt_s)
+{
+    if (dt_s > HVAC_SIM_MAX_DT_S) {
+        dt_s = HVAC_SIM_MAX_DT_S;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&hvac_sim_lock);
+
+    hvac_sim_dt_acc += dt_s;
+    while (hvac_sim_dt_acc >= HVAC_SIM_STEP_S) {
+        hvac_sim_substep();
+        hvac_sim_dt_acc -= HVAC_SIM_STEP_S;
+    }
+
+    k_spin_unlock(&hvac_sim_lock, key);
+}
+
+void hvac_sim_reset(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&hvac_sim_lock);
+
+    memset(&hvac_sim_st, 0, sizeof(hvac_sim_st));
+
+    /* start w stanie ustalonym bez sterowania */
+    float t_out = hvac_sim_outdoor(0);
+    float t_room = t_out + hvac_sim_dist.internal_gain_c;
+
+    hvac_sim_st.t_outdoor_c = t_out;
+    hvac_sim_st.t_supply_c  = t_out;
+    hvac_sim_st.t_extract_c = t_room;
+    hvac_sim_st.t_exhaust_c = t_room;
+
+    hvac_sim_delay_fill(&hvac_sim_supply_delay, t_out);
+    hvac_sim_delay_fill(&hvac_sim_room_delay, t_room);
+
+    hvac_sim_dt_acc = 0.0f;
+    hvac_sim_rng = CONFIG_HVAC_SIM_SEED;
+
+    k_spin_unlock(&hvac_sim_lock, key);
+}
+
+void hvac_sim_stats_reset(float setpoint_c, float band_c)
+{
+    k_spinlock_key_t key = k_spin_lock(&hvac_sim_lock);
+
+    memset(&hvac_sim_stats, 0, sizeof(hvac_sim_stats));
+    hvac_sim_stats.setpoint_c = setpoint_c;
+    hvac_sim_stats.band_c     = band_c;
+    hvac_sim_stats.dir        = (hvac_sim_st.t_extract_c <= setpoint_c) ? 1.0f : -1.0f;
+    hvac_sim_stats.t0_steps   = hvac_sim_st.steps;
+    hvac_sim_stats.sum.settling_time_s = -1.0f;
+
+    hvac_sim_stats.last_pct[HVAC_SIM_ACT_HEATER] = hvac_sim_st.heater_pct;
+    hvac_sim_stats.last_pct[HVAC_SIM_ACT_COOLER] = hvac_sim_st.cooler_pct;
+    hvac_sim_stats.last_pct[HVAC_SIM_ACT_BYPASS] = hvac_sim_st.bypass_pct;
+    hvac_sim_stats.last_pct[HVAC_SIM_ACT_FAN]    = hvac_sim_st.fan_pct;
+
+    k_spin_unlock(&hvac_sim_lock, key);
+}
+
+void hvac_sim_stats_get(struct hvac_sim_summary *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&hvac_sim_lock);
+    *out = hvac_sim_stats.sum;
+    k_spin_unlock(&hvac_sim_lock, key);
+}
+
+void hvac_sim_set_io_map(const struct hvac_io_cfg *io)
+{
+    k_spinlock_key_t key = k_spin_lock(&hvac_sim_lock);
+    hvac_sim_io = *io;
+    k_spin_unlock(&hvac_sim_lock, key);
+}
+
+void hvac_sim_get_params(struct hvac_sim_params *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&hvac_sim_lock);
+    *out = hvac_sim_params;
+    k_spin_unlock(&hvac_sim_lock, key);
+}
+
+void hvac_sim_set_params(const struct hvac_sim_params *p)
+{
+    k_spinlock_key_t key = k_spin_lock(&hvac_sim_lock);
+    hvac_sim_params = *p;
+    k_spin_unlock(&hvac_sim_lock, key);
+}
+
+void hvac_sim_get_disturbance(struct hvac_sim_disturbance *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&hvac_sim_lock);
+    *out = hvac_sim_dist;
+    k_spin_unlock(&hvac_sim_lock, key);
+}
+
+void hvac_sim_set_disturbance(const struct hvac_sim_disturbance *d)
+{
+    k_spinlock_key_t key = k_spin_lock(&hvac_sim_lock);
+    hvac_sim_dist = *d;
+    k_spin_unlock(&hvac_sim_lock, key);
+}
+
+void hvac_sim_get_state(struct hvac_sim_state *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&hvac_sim_lock);
+    *out = hvac_sim_st;
+    k_spin_unlock(&hvac_sim_lock, key);
+}
+
+/* --- Backend I/O --- */
+
+static int64_t hvac_sim_last_ms;
+
+static float hvac_sim_temp_to_v(float t_c)
+{
+    float v = (t_c + hvac_sim_noise(hvac_sim_dist.noise_c)) / HVAC_TEMP_C_PER_VOLT;
+    return CLAMP(v, 0.0f, CONFIG_HVAC_IO_AI_FULL_SCALE_MV / 1000.0f);
+}
+
+static void hvac_sim_put_ai(float ai_v[HVAC_NUM_AI_CHANNELS], int32_t ch, float t_c)
+{
+    if (ch >= 0 && ch < HVAC_NUM_AI_CHANNELS) {
+        ai_v[ch] = hvac_sim_temp_to_v(t_c);
+    }
+}
+
+static int hvac_io_sim_init(void)
+{
+    hvac_sim_reset();
+    hvac_sim_last_ms = k_uptime_get();
+    return 0;
+}
+
+static int hvac_io_sim_start_read(void)
+{
+    float ai_v[HVAC_NUM_AI_CHANNELS] = { 0 };
+
+#if !defined(CONFIG_HVAC_SIM_FAST)
+    int64_t now_ms = k_uptime_get();
+    hvac_sim_step((now_ms - hvac_sim_last_ms) / 1000.0f);
+    hvac_sim_last_ms = now_ms;
+#endif
+    /* w trybie przyspieszonym czas obiektu przesuwa hvac_sim_step() z pętli scenariusza */
+
+    k_spinlock_key_t key = k_spin_lock(&hvac_sim_lock);
+
+    const struct hvac_sim_state *st = &hvac_sim_st;
+    hvac_sim_put_ai(ai_v, hvac_sim_io.t_supply_ai,  st->t_supply_c);
+    hvac_sim_put_ai(ai_v, hvac_sim_io.t_extract_ai, st->t_extract_c);
+    hvac_sim_put_ai(ai_v, hvac_sim_io.t_exhaust_ai, st->t_exhaust_c);
+    hvac_sim_put_ai(ai_v, hvac_sim_io.t_outdoor_ai, st->t_outdoor_c);
+    /* termostat przeciwzamrożeniowy mierzy powietrze za nagrzewnicą */
+    hvac_sim_put_ai(ai_v, hvac_sim_io.frost_ai,     st->t_supply_c);
+
+    k_spin_unlock(&hvac_sim_lock, key);
+
+    hvac_io_ai_frame_done(ai_v, 0);
+    return 0;
+}
+
+static void hvac_io_sim_write(const float ao_v[HVAC_NUM_AO_CHANNELS])
+{
+    k_spinlock_key_t key = k_spin_lock(&hvac_sim_lock);
+    memcpy(hvac_sim_ao_v, ao_v, sizeof(hvac_sim_ao_v));
+    k_spin_unlock(&hvac_sim_lock, key);
+}
+
+const struct hvac_io_backend hvac_io_backend_sim = {
+    .name       = "sim-ahu",
+    .init       = hvac_io_sim_init,
+    .start_read = hvac_io_sim_start_read,
+    .write      = hvac_io_sim_write,
+};
@@ -0,0 +1,83 @@
+#ifndef HVAC_SIM_H
+#define HVAC_SIM_H
+
+#include "hvac_config.h"
+
+/*
+ * Symulowany obiekt: centrala nawiewno-wywiewna z odzyskiem ciepła.
+ * Temperatury nawiewu, wyciągu (pomieszczenia) i wyrzutu są modelowane
+ * jako człony inercyjne I rzędu z opóźnieniem (FOPDT), pobudzane
+ * wyjściami grzałki, chłodnicy, bypassu (odzysku) i wentylatora.
+ */
+
+struct hvac_sim_params {
+    float tau_supply_s;       /* stała czasowa nagrzewnicy/chłodnicy */
+    float dead_supply_s;      /* opóźnienie transportowe kanału nawiewnego */
+    float tau_room_s;         /* stała czasowa pomieszczenia */
+    float dead_room_s;
+    float tau_exhaust_s;
+
+    float heater_gain_c;      /* przyrost T nawiewu przy 100 % grzania */
+    float cooler_gain_c;      /* spadek T nawiewu przy 100 % chłodzenia */
+    float hr_efficiency;      /* sprawność odzysku przy 100 % sygnału bypassu */
+    float vent_coeff;         /* wentylacja względem strat przez przegrody */
+    float fan_min_flow;       /* względny przepływ przy 0 % falownika */
+};
+
+struct hvac_sim_disturbance {
+    float t_out_mean_c;       /* średnia temperatura zewnętrzna */
+    float t_out_amp_c;        /* amplituda dobowa */
+    float t_out_period_s;
+    float t_out_step_c;       /* skok temperatury zewnętrznej (front) */
+    float internal_gain_c;    /* zyski wewnętrzne jako przyrost T pomieszczenia */
+    float noise_c;            /* szum pomiarowy (wartość szczytowa) */
+};
+
+struct hvac_sim_state {
+    uint64_t steps;           /* kroki modelu (0.1 s) od resetu */
+    float time_s;             /* steps w sekundach - tylko do wyświetlania */
+    float t_supply_c;
+    float t_extract_c;
+    float t_exhaust_c;
+    float t_outdoor_c;
+
+    float heater_pct;
+    float cooler_pct;
+    float bypass_pct;
+    float fan_pct;
+};
+
+/* Podsumowanie przebiegu - liczone z temperatury wyciągu (wielkość regulowana) */
+enum hvac_sim_act {
+    HVAC_SIM_ACT_HEATER,
+    HVAC_SIM_ACT_COOLER,
+    HVAC_SIM_ACT_BYPASS,
+    HVAC_SIM_ACT_FAN,
+    HVAC_SIM_ACT_COUNT,
+};
+
+struct hvac_sim_summary {
+    float duration_s;
+    float settling_time_s;    /* ostatnie wyjście poza pasmo, < 0 = nie ustalił się */
+    float overshoot_c;        /* przeregulowanie ponad zadaną (w kierunku ruchu) */
+    /* sumy po krokach 0.1 s - double, bo przez rok float przestaje przyrastać */
+    double iae_ch;            /* całka |e| [C*h] */
+    double travel_pct[HVAC_SIM_ACT_COUNT];
+    double energy_h[HVAC_SIM_ACT_COUNT];  /* godziny pełnego obciążenia */
+};
+
+void hvac_sim_reset(void);
+void hvac_sim_set_io_map(const struct hvac_io_cfg *io);
+
+void hvac_sim_get_params(struct hvac_sim_params *out);
+void hvac_sim_set_params(const struct hvac_sim_params *p);
+void hvac_sim_get_disturbance(struct hvac_sim_disturbance *out);
+void hvac_sim_set_disturbance(const struct hvac_sim_disturbance *d);
+
+void hvac_sim_step(float dt_s);
+void hvac_sim_get_state(struct hvac_sim_state *out);
+
+void hvac_sim_stats_reset(float setpoint_c, float band_c);
+void hvac_sim_stats_get(struct hvac_sim_summary *out);
+
+#endif /* HVAC_SIM_H */
@@ -0,0 +1,128 @@
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/slist.h>
+
+#include "hvac_spi_sched.h"
+
+LOG_MODULE_REGISTER(hvac_spi, CONFIG_LOG_DEFAULT_LEVEL);
+
+struct hvac_spi_bus {
+    sys_slist_t        queue;
+    struct k_spinlock  lock;
+    struct k_sem       pending;
+    struct k_thread    thread;
+    bool               started;
+};
+
+static struct hvac_spi_bus hvac_spi_buses[HVAC_SPI_BUS_COUNT];
+
+K_THREAD_STACK_ARRAY_DEFINE(hvac_spi_stacks, HVAC_SPI_BUS_COUNT,
+                            CONFIG_HVAC_SPI_SCHED_STACK_SIZE);
+
+static struct hvac_spi_xfer *hvac_spi_next(struct hvac_spi_bus *bus)
+{
+    k_spinlock_key_t key = k_spin_lock(&bus->lock);
+    sys_snode_t *node = sys_slist_get(&bus->queue);
+    k_spin_unlock(&bus->lock, key);
+
+    return node ? CONTAINER_OF(node, struct hvac_spi_xfer, node) : NULL;
+}
+
+static void hvac_spi_run(struct hvac_spi_xfer *xfer)
+{
+    uint32_t start = k_cycle_get_32();
+
+    xfer->result = 0;
+
+    for (int i = 0; i < xfer->count; i++) {
+        const struct spi_buf_set *rx = xfer->rx ? &xfer->rx[i] : NULL;
+
+        int ret = spi_transceive_dt(xfer->spec, &xfer->tx[i], rx);
+        if (ret < 0) {
+            xfer->result = ret;
+            break;
+        }
+    }
+
+    xfer->duration_cyc = k_cycle_get_32() - start;
+}
+
+static void hvac_spi_thread(void *p1, void *p2, void *p3)
+{
+    struct hvac_spi_bus *bus = p1;
+
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    while (1) {
+        k_sem_take(&bus->pending, K_FOREVER);
+
+        struct hvac_spi_xfer *xfer = hvac_spi_next(bus);
+        if (!xfer) {
+            continue;
+        }
+
+        hvac_spi_run(xfer);
+
+        if (xfer->result < 0) {
+            LOG_ERR("SPI xfer failed: %d", xfer->result);
+        }
+
+        if (xfer->done) {
+            xfer->done(xfer);
+        }
+    }
+}
+
+int hvac_spi_sched_init(void)
+{
+    static const char *const names[HVAC_SPI_BUS_COUNT] = {
+        "hvac_spi_adc",
+        "hvac_spi_dac",
+    };
+
+    for (int b = 0; b < HVAC_SPI_BUS_COUNT; b++) {
+        struct hvac_spi_bus *bus = &hvac_spi_buses[b];
+
+        if (bus->started) {
+            continue;
+        }
+
+        sys_slist_init(&bus->queue);
+        k_sem_init(&bus->pending, 0, K_SEM_MAX_LIMIT);
+
+        k_tid_t tid = k_thread_create(&bus->thread,
+                                      hvac_spi_stacks[b],
+                                      K_THREAD_STACK_SIZEOF(hvac_spi_stacks[b]),
+                                      hvac_spi_thread,
+                                      bus, NULL, NULL,
+                                      CONFIG_HVAC_SPI_SCHED_PRIORITY, 0, K_NO_WAIT);
+        k_thread_name_set(tid, names[b]);
+
+        bus->started = true;
+    }
+
+    return 0;
+}
+
+int hvac_spi_submit(int bus_idx, struct hvac_spi_xfer *xfer)
+{
+    if (bus_idx < 0 || bus_idx >= HVAC_SPI_BUS_COUNT ||
+        xfer == NULL || xfer->count == 0) {
+        return -EINVAL;
+    }
+
+    struct hvac_spi_bus *bus = &hvac_spi_buses[bus_idx];
+    if (!bus->started) {
+        return -EAGAIN;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&bus->lock);
+    sys_slist_append(&bus->queue, &xfer->node);
+    k_spin_unlock(&bus->lock, key);
+
+    k_sem_give(&bus->pending);
+
+    return 0;
+}
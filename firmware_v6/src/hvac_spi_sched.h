@@ -0,0 +1,45 @@
+#ifndef HVAC_SPI_SCHED_H
+#define HVAC_SPI_SCHED_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/sys/slist.h>
+
+/*
+ * Kolejkowanie transakcji SPI. Każda magistrala ma własny wątek i jedną
+ * kolejkę FIFO. Na magistrali są tylko ramki wejść/wyjść pętli regulacji -
+ * UI czyta obraz procesu (hvac_io_snapshot()), więc nie ma z czym konkurować.
+ */
+
+enum {
+    HVAC_SPI_BUS_ADC = 0,   /* ADS8688 */
+    HVAC_SPI_BUS_DAC,       /* DAC7568 */
+    HVAC_SPI_BUS_COUNT
+};
+
+struct hvac_spi_xfer;
+
+typedef void (*hvac_spi_done_t)(struct hvac_spi_xfer *xfer);
+
+/*
+ * Jedna transakcja = `count` ramek, każda z osobnym cyklem CS
+ * (ADS8688 wymaga podniesienia CS po każdej 32-bitowej ramce).
+ */
+struct hvac_spi_xfer {
+    sys_snode_t node;
+
+    const struct spi_dt_spec  *spec;
+    const struct spi_buf_set  *tx;      /* tablica `count` elementów */
+    const struct spi_buf_set  *rx;      /* NULL albo tablica `count` elementów */
+    uint8_t                    count;
+
+    hvac_spi_done_t done;               /* wołane z wątku magistrali */
+    void           *user_data;
+    int             result;
+    uint32_t        duration_cyc;       /* czas trwania na magistrali */
+};
+
+int hvac_spi_sched_init(void);
+int hvac_spi_submit(int bus, struct hvac_spi_xfer *xfer);
+
+#endif /* HVAC_SPI_SCHED_H */
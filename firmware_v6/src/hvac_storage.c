@@ -0,0 +1,212 @@
+#include <zephyr/kernel.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/disk_access.h>
+#include <errno.h>
+
+#include <ff.h>
+
+#include "hvac_storage.h"
+
+LOG_MODULE_REGISTER(hvac_storage, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define HVAC_STORAGE_MAX_SUBS 4
+#define HVAC_STORAGE_RETRY_MS 2000
+
+#define HVAC_STORAGE_SDMMC DT_NODELABEL(sdmmc1)
+
+#if DT_NODE_HAS_PROP(HVAC_STORAGE_SDMMC, cd_gpios)
+#define HVAC_STORAGE_HAS_CD 1
+/* flaga ACTIVE_LOW z devicetree - stan logiczny 1 = karta w gnieździe */
+static const struct gpio_dt_spec hvac_storage_cd = GPIO_DT_SPEC_GET(HVAC_STORAGE_SDMMC, cd_gpios);
+static struct gpio_callback hvac_storage_cd_cb;
+#else
+#define HVAC_STORAGE_HAS_CD 0
+#endif
+
+static FATFS hvac_storage_fat;
+
+static struct fs_mount_t hvac_storage_mnt = {
+    .type        = FS_FATFS,
+    .fs_data     = &hvac_storage_fat,
+    .mnt_point   = HVAC_STORAGE_MNT,
+    .storage_dev = (void *)HVAC_STORAGE_DISK,
+};
+
+static volatile bool hvac_storage_ready;
+
+static hvac_storage_cb_t hvac_storage_subs[HVAC_STORAGE_MAX_SUBS];
+static int hvac_storage_num_subs;
+
+static K_SEM_DEFINE(hvac_storage_sem, 0, 1);
+
+/* --- Karta --- */
+
+static bool hvac_storage_card_present(void)
+{
+#if HVAC_STORAGE_HAS_CD
+    if (device_is_ready(hvac_storage_cd.port)) {
+        return gpio_pin_get_dt(&hvac_storage_cd) > 0;
+    }
+#endif
+    return true;        /* bez card-detect zakładamy, że karta jest */
+}
+
+static int hvac_storage_mount(void)
+{
+    uint32_t block_count;
+    uint32_t block_size;
+    int ret;
+
+    ret = disk_access_ioctl(HVAC_STORAGE_DISK, DISK_IOCTL_CTRL_INIT, NULL);
+    if (ret != 0) {
+        LOG_ERR("SD init failed: %d", ret);
+        return -ENODEV;
+    }
+
+    if (disk_access_ioctl(HVAC_STORAGE_DISK, DISK_IOCTL_GET_SECTOR_COUNT, &block_count) == 0 &&
+        disk_access_ioctl(HVAC_STORAGE_DISK, DISK_IOCTL_GET_SECTOR_SIZE, &block_size) == 0) {
+        LOG_INF("SD size: %u MB", (uint32_t)(((uint64_t)block_count * block_size) >> 20));
+    }
+
+    ret = fs_mount(&hvac_storage_mnt);
+    if (ret != 0) {
+        LOG_ERR("fs_mount(%s) failed: %d", HVAC_STORAGE_MNT, ret);
+        (void)disk_access_ioctl(HVAC_STORAGE_DISK, DISK_IOCTL_CTRL_DEINIT, NULL);
+        return ret;
+    }
+
+    hvac_storage_ready = true;
+    LOG_INF("SD mounted on %s", HVAC_STORAGE_MNT);
+    return 0;
+}
+
+static void hvac_storage_unmount(void)
+{
+    hvac_storage_ready = false;
+
+    (void)fs_unmount(&hvac_storage_mnt);
+    /* następny montaż zaczyna od pełnej inicjalizacji nowej karty */
+    (void)disk_access_ioctl(HVAC_STORAGE_DISK, DISK_IOCTL_CTRL_DEINIT, NULL);
+
+    LOG_INF("SD unmounted");
+}
+
+static void hvac_storage_notify(enum hvac_storage_event ev)
+{
+    for (int i = 0; i < hvac_storage_num_subs; i++) {
+        hvac_storage_subs[i](ev);
+    }
+}
+
+/* --- Wątek karty --- */
+
+#if HVAC_STORAGE_HAS_CD
+static void hvac_storage_cd_isr(const struct device *port, struct gpio_callback *cb,
+                                uint32_t pins)
+{
+    ARG_UNUSED(port);
+    ARG_UNUSED(cb);
+    ARG_UNUSED(pins);
+
+    k_sem_give(&hvac_storage_sem);
+}
+#endif
+
+static void hvac_storage_thread(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    bool mount_failed = false;
+
+    while (1) {
+        /* drgania styków: stan musi być stały przez cały czas DEBOUNCE_MS */
+        do {
+            k_sleep(K_MSEC(CONFIG_HVAC_STORAGE_DEBOUNCE_MS));
+        } while (k_sem_take(&hvac_storage_sem, K_NO_WAIT) == 0);
+
+        bool present = hvac_storage_card_present();
+
+        if (present && !hvac_storage_ready) {
+            mount_failed = (hvac_storage_mount() != 0);
+            if (!mount_failed) {
+                hvac_storage_notify(HVAC_STORAGE_EV_MOUNTED);
+            }
+        } else if (!present && hvac_storage_ready) {
+            LOG_INF("SD removed");
+            /* is_ready() już false - nikt nie otworzy nowego pliku */
+            hvac_storage_ready = false;
+            hvac_storage_notify(HVAC_STORAGE_EV_REMOVED);
+            hvac_storage_unmount();
+        }
+
+        /* karta, której nie udało się zamontować: ponowna próba co jakiś czas */
+        k_timeout_t wait = (present && mount_failed) ? K_MSEC(HVAC_STORAGE_RETRY_MS)
+                                                     : K_FOREVER;
+        (void)k_sem_take(&hvac_storage_sem, wait);
+    }
+}
+
+K_THREAD_DEFINE(hvac_storage_thread_id, CONFIG_HVAC_STORAGE_STACK_SIZE,
+                hvac_storage_thread, NULL, NULL, NULL,
+                CONFIG_HVAC_STORAGE_PRIORITY, 0, SYS_FOREVER_MS);  /* startuje hvac_storage_start() */
+
+/* --- API --- */
+
+int hvac_storage_subscribe(hvac_storage_cb_t cb)
+{
+    if (hvac_storage_num_subs == HVAC_STORAGE_MAX_SUBS) {
+        return -ENOMEM;
+    }
+
+    hvac_storage_subs[hvac_storage_num_subs++] = cb;
+    return 0;
+}
+
+int hvac_storage_start(void)
+{
+#if HVAC_STORAGE_HAS_CD
+    if (device_is_ready(hvac_storage_cd.port)) {
+        int ret = gpio_pin_configure_dt(&hvac_storage_cd, GPIO_INPUT);
+        if (ret == 0) {
+            ret = gpio_pin_interrupt_configure_dt(&hvac_storage_cd, GPIO_INT_EDGE_BOTH);
+        }
+        if (ret == 0) {
+            gpio_init_callback(&hvac_storage_cd_cb, hvac_storage_cd_isr,
+                               BIT(hvac_storage_cd.pin));
+            ret = gpio_add_callback_dt(&hvac_storage_cd, &hvac_storage_cd_cb);
+        }
+        if (ret != 0) {
+            LOG_ERR("Card detect setup failed: %d", ret);
+        }
+    } else {
+        LOG_WRN("Card detect GPIO not ready, hot-plug disabled");
+    }
+#endif
+
+    k_thread_start(hvac_storage_thread_id);
+    return 0;
+}
+
+bool hvac_storage_is_ready(void)
+{
+    return hvac_storage_ready;
+}
+
+int hvac_storage_mtime(const char *path, uint32_t *mtime)
+{
+    FILINFO fno;
+
+    /* fs_stat() w Zephyrze nie zwraca czasu - pytamy FatFs wprost ("SD:/...") */
+    if (path[0] != '/' || f_stat(&path[1], &fno) != FR_OK) {
+        *mtime = 0;
+        return -ENOENT;
+    }
+
+    *mtime = ((uint32_t)fno.fdate << 16) | fno.ftime;
+    return 0;
+}
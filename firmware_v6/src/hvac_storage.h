@@ -0,0 +1,39 @@
+#ifndef HVAC_STORAGE_H
+#define HVAC_STORAGE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Karta SD (FAT, sterownik sdmmc z devicetree płytki) zamontowana pod
+ * HVAC_STORAGE_MNT. Wspólna dla katalogu configów i loggera.
+ *
+ * Montowaniem zajmuje się osobny wątek: przerwanie z pinu card-detect
+ * (cd-gpios węzła sdmmc1) budzi go, po odczekaniu drgań styków montuje
+ * albo odmontowuje kartę i powiadamia subskrybentów. Ani UI, ani pętla
+ * regulacji nie czekają na kartę.
+ */
+
+#define HVAC_STORAGE_DISK "SD"
+#define HVAC_STORAGE_MNT  "/" HVAC_STORAGE_DISK ":"
+
+enum hvac_storage_event {
+    HVAC_STORAGE_EV_MOUNTED,      /* karta zamontowana, można otwierać pliki */
+    HVAC_STORAGE_EV_REMOVED,      /* karta wyjęta - zamknąć pliki, zaraz fs_unmount() */
+};
+
+/* wołane z wątku karty - może blokować, ale nie z wątku UI */
+typedef void (*hvac_storage_cb_t)(enum hvac_storage_event ev);
+
+/* przed hvac_storage_start(); -ENOMEM, gdy lista pełna */
+int  hvac_storage_subscribe(hvac_storage_cb_t cb);
+
+/* startuje wątek karty - pierwszy montaż odbywa się w tle */
+int  hvac_storage_start(void);
+
+bool hvac_storage_is_ready(void);
+
+/* czas modyfikacji pliku w formacie FAT (data << 16 | czas), 0 = nieznany */
+int  hvac_storage_mtime(const char *path, uint32_t *mtime);
+
+#endif /* HVAC_STORAGE_H */
@@ -0,0 +1,248 @@
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/linker/section_tags.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <errno.h>
+#include <string.h>
+
+#include "hvac_telem.h"
+
+LOG_MODULE_REGISTER(hvac_telem, CONFIG_LOG_DEFAULT_LEVEL);
+
+/* same pola 4-bajtowe po nagłówku - bez wypełnienia, układ = bajty na łączu */
+BUILD_ASSERT(sizeof(struct hvac_telem_rec) ==
+             24 + 3 * 4 + 4 * (HVAC_NUM_AI_CHANNELS + HVAC_NUM_AO_CHANNELS),
+             "telemetry record must not contain padding");
+
+#define HVAC_TELEM_RAW_MAX  (sizeof(struct hvac_telem_rec) + 2)
+/* COBS: bajt narzutu na każde rozpoczęte 254 bajty, plus separator */
+#define HVAC_TELEM_FRAME_MAX (HVAC_TELEM_RAW_MAX + HVAC_TELEM_RAW_MAX / 254 + 2)
+
+static const struct device *const hvac_telem_uart =
+    DEVICE_DT_GET(DT_CHOSEN(hvac_telemetry_uart));
+
+/* bufor DMA poza cache - jak w hvac_rs485.c */
+static uint8_t hvac_telem_buf[CONFIG_HVAC_TELEM_BUF_SIZE] __nocache __aligned(32);
+static struct ring_buf hvac_telem_rb;
+
+/* pierścień dzielą wątek regulacji i przerwanie UART */
+static struct k_spinlock hvac_telem_lock;
+static bool     hvac_telem_running;
+static bool     hvac_telem_async;
+static bool     hvac_telem_busy;          /* nadawanie w toku */
+static uint32_t hvac_telem_seq;
+static struct hvac_telem_stats hvac_telem_st;
+
+/* --- COBS --- */
+
+static size_t hvac_telem_cobs(uint8_t *dst, const uint8_t *src, size_t len)
+{
+    size_t code_pos = 0;
+    size_t out = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < len; i++) {
+        if (src[i] == 0) {
+            dst[code_pos] = code;
+            code_pos = out++;
+            code = 1;
+            continue;
+        }
+        dst[out++] = src[i];
+        if (++code == 0xff) {
+            dst[code_pos] = code;
+            code_pos = out++;
+            code = 1;
+        }
+    }
+    dst[code_pos] = code;
+    dst[out++] = 0x00;
+
+    return out;
+}
+
+/* --- Nadawanie --- */
+
+/* pod hvac_telem_lock */
+static void hvac_telem_kick(void)
+{
+    uint8_t *p;
+
+    if (hvac_telem_busy || ring_buf_is_empty(&hvac_telem_rb)) {
+        return;
+    }
+
+#if defined(CONFIG_UART_ASYNC_API)
+    if (hvac_telem_async) {
+        /* ciągły fragment pierścienia; po zawinięciu reszta idzie następnym DMA */
+        uint32_t n = ring_buf_get_claim(&hvac_telem_rb, &p, CONFIG_HVAC_TELEM_BUF_SIZE);
+
+        if (uart_tx(hvac_telem_uart, p, n, SYS_FOREVER_US) != 0) {
+            (void)ring_buf_get_finish(&hvac_telem_rb, 0);
+            hvac_telem_st.tx_err++;
+            return;
+        }
+        hvac_telem_busy = true;
+        return;
+    }
+#endif
+
+#if defined(CONFIG_UART_INTERRUPT_DRIVEN)
+    ARG_UNUSED(p);
+    hvac_telem_busy = true;
+    uart_irq_tx_enable(hvac_telem_uart);
+#endif
+}
+
+#if defined(CONFIG_UART_ASYNC_API)
+static void hvac_telem_uart_cb(const struct device *dev, struct uart_event *evt, void *user_data)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(user_data);
+
+    if (evt->type != UART_TX_DONE && evt->type != UART_TX_ABORTED) {
+        return;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&hvac_telem_lock);
+
+    /* przy ABORTED len = bajty faktycznie wysłane */
+    (void)ring_buf_get_finish(&hvac_telem_rb, evt->data.tx.len);
+    hvac_telem_st.bytes += evt->data.tx.len;
+    if (evt->type == UART_TX_ABORTED) {
+        hvac_telem_st.tx_err++;
+    }
+    hvac_telem_busy = false;
+    hvac_telem_kick();
+
+    k_spin_unlock(&hvac_telem_lock, key);
+}
+#endif
+
+#if defined(CONFIG_UART_INTERRUPT_DRIVEN)
+static void hvac_telem_uart_isr(const struct device *dev, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    k_spinlock_key_t key = k_spin_lock(&hvac_telem_lock);
+
+    while (uart_irq_update(dev) && uart_irq_tx_ready(dev)) {
+        uint8_t *p;
+        uint32_t n = ring_buf_get_claim(&hvac_telem_rb, &p, CONFIG_HVAC_TELEM_BUF_SIZE);
+
+        if (n == 0) {
+            (void)ring_buf_get_finish(&hvac_telem_rb, 0);
+            uart_irq_tx_disable(dev);
+            hvac_telem_busy = false;
+            break;
+        }
+
+        int sent = uart_fifo_fill(dev, p, n);
+        sent = MAX(sent, 0);
+        (void)ring_buf_get_finish(&hvac_telem_rb, sent);
+        hvac_telem_st.bytes += sent;
+        if ((uint32_t)sent < n) {
+            break;                  /* FIFO pełne - dokończy następne przerwanie */
+        }
+    }
+
+    k_spin_unlock(&hvac_telem_lock, key);
+}
+#endif
+
+/* --- API --- */
+
+int hvac_telem_start(void)
+{
+    int ret = -ENOTSUP;
+
+    if (!device_is_ready(hvac_telem_uart)) {
+        LOG_ERR("Telemetry UART not ready");
+        return -ENODEV;
+    }
+
+    ring_buf_init(&hvac_telem_rb, sizeof(hvac_telem_buf), hvac_telem_buf);
+
+#if defined(CONFIG_UART_ASYNC_API)
+    ret = uart_callback_set(hvac_telem_uart, hvac_telem_uart_cb, NULL);
+    hvac_telem_async = (ret == 0);
+#endif
+#if defined(CONFIG_UART_INTERRUPT_DRIVEN)
+    if (!hvac_telem_async) {
+        ret = uart_irq_callback_user_data_set(hvac_telem_uart, hvac_telem_uart_isr, NULL);
+    }
+#endif
+    if (ret != 0) {
+        LOG_ERR("Telemetry UART has neither async nor interrupt API: %d", ret);
+        return ret;
+    }
+
+    hvac_telem_running = true;
+
+    LOG_INF("Telemetry on %s (%s), %u B records",
+            hvac_telem_uart->name, hvac_telem_async ? "DMA" : "IRQ",
+            (unsigned int)sizeof(struct hvac_telem_rec));
+    return 0;
+}
+
+void hvac_telem_cycle(int32_t setpoint, float u_pct, float i_term,
+                      uint32_t dt_us, uint32_t exec_us)
+{
+    struct hvac_io_image img;
+    struct hvac_telem_rec rec;
+    uint8_t raw[HVAC_TELEM_RAW_MAX];
+    uint8_t frame[HVAC_TELEM_FRAME_MAX];
+
+    if (!hvac_telem_running) {
+        return;
+    }
+
+    hvac_io_snapshot(&img);
+
+    rec.type     = HVAC_TELEM_TYPE_CYCLE;
+    rec.version  = HVAC_TELEM_VERSION;
+    rec.num_ai   = HVAC_NUM_AI_CHANNELS;
+    rec.num_ao   = HVAC_NUM_AO_CHANNELS;
+    rec.seq      = hvac_telem_seq++;
+    rec.t_us     = (uint32_t)k_ticks_to_us_floor64(img.ai_ts_ticks);
+    rec.frame    = img.frame;
+    rec.dt_us    = dt_us;
+    rec.exec_us  = exec_us;
+    rec.setpoint = (float)setpoint;
+    rec.u_pct    = u_pct;
+    rec.i_term   = i_term;
+    memcpy(rec.ai_v, img.ai_v, sizeof(rec.ai_v));
+    memcpy(rec.ao_v, img.ao_v, sizeof(rec.ao_v));
+
+    memcpy(raw, &rec, sizeof(rec));
+    sys_put_le16(crc16_itu_t(0xffff, raw, sizeof(rec)), &raw[sizeof(rec)]);
+
+    size_t n = hvac_telem_cobs(frame, raw, sizeof(raw));
+
+    k_spinlock_key_t key = k_spin_lock(&hvac_telem_lock);
+
+    /* cała ramka albo nic - połówka rozsynchronizowałaby odbiorcę */
+    if (ring_buf_space_get(&hvac_telem_rb) < n) {
+        hvac_telem_st.dropped++;
+    } else {
+        (void)ring_buf_put(&hvac_telem_rb, frame, n);
+        hvac_telem_st.records++;
+        hvac_telem_kick();
+    }
+
+    k_spin_unlock(&hvac_telem_lock, key);
+}
+
+void hvac_telem_get_stats(struct hvac_telem_stats *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&hvac_telem_lock);
+
+    *out = hvac_telem_st;
+
+    k_spin_unlock(&hvac_telem_lock, key);
+}
@@ -0,0 +1,58 @@
+#ifndef HVAC_TELEM_H
+#define HVAC_TELEM_H
+
+#include <stdint.h>
+
+#include "hvac_io.h"
+
+/*
+ * Telemetria binarna na UART (chosen hvac,telemetry-uart) - pełny stan
+ * regulacji co krok, do podglądu na żywo (scripts/hvac_telem.py).
+ *
+ * Wątek regulacji koduje rekord i wrzuca ramkę do bufora pierścieniowego
+ * (bez blokowania, bez LOG_* - ramka, która się nie mieści, jest gubiona
+ * i liczona; odbiorca widzi lukę w seq). Bufor opróżnia DMA (UART async
+ * API) albo przerwanie FIFO (CDC ACM, który async API nie ma).
+ *
+ * Ramka na łączu: COBS(rekord + crc16) + 0x00. CRC-16/CCITT-FALSE
+ * (crc16_itu_t, seed 0xffff) po rekordzie, little-endian. Zero
+ * występuje tylko jako separator, więc odbiorca łapie synchronizację
+ * od najbliższego zera.
+ */
+
+#define HVAC_TELEM_TYPE_CYCLE 0x01
+#define HVAC_TELEM_VERSION    1
+
+struct hvac_telem_rec {
+    uint8_t  type;                /* HVAC_TELEM_TYPE_CYCLE */
+    uint8_t  version;
+    uint8_t  num_ai;
+    uint8_t  num_ao;
+    uint32_t seq;                 /* kolejny rekord; luka = ramki zgubione */
+    uint32_t t_us;                /* koniec odczytu ramki wejść (zawija się) */
+    uint32_t frame;
+    uint32_t dt_us;               /* od poprzedniego kroku */
+    uint32_t exec_us;             /* krok regulacji do chwili zapisu rekordu */
+    float    setpoint;
+    float    u_pct;
+    float    i_term;
+    float    ai_v[HVAC_NUM_AI_CHANNELS];
+    float    ao_v[HVAC_NUM_AO_CHANNELS];  /* wyjścia obowiązujące podczas pomiaru */
+};
+
+struct hvac_telem_stats {
+    uint32_t records;
+    uint32_t dropped;             /* brak miejsca w buforze - łącze nie nadąża */
+    uint32_t bytes;               /* wysłane bajty ramek */
+    uint32_t tx_err;
+};
+
+int hvac_telem_start(void);
+
+/* wołane z wątku regulacji raz na cykl; nie blokuje */
+void hvac_telem_cycle(int32_t setpoint, float u_pct, float i_term,
+                      uint32_t dt_us, uint32_t exec_us);
+
+void hvac_telem_get_stats(struct hvac_telem_stats *out);
+
+#endif /* HVAC_TELEM_H */
@@ -3,92 +3,99 @@
 #include <zephyr/drivers/display.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/sys/util.h>
-#include <zephyr/data/json.h>
 #include <lvgl.h>
+#include <math.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
 
-#define button_color lv_color_hex(0x0A854A)
-
-/* Ikona nastawy temperatury */
-LV_IMG_DECLARE(TP_type1__not_active);
-
-/* Obrazki z wykresami sekwencji (musisz je wygenerować LVGL converterem) */
-LV_IMG_DECLARE(seq_img_cool_dead_heat);
-LV_IMG_DECLARE(seq_img_cool_rec_dead_rec_heat);
+#include "hvac_config.h"
+#include "hvac_cfg_json.h"
+#if defined(CONFIG_HVAC_CFG_BIN)
+#include "hvac_cfg_bin.h"
+#endif
+#include "hvac_io.h"
+#include "hvac_assets.h"
+
+#if defined(CONFIG_HVAC_DO)
+#include "hvac_do.h"
+#endif
+#if defined(CONFIG_HVAC_IO_BACKEND_SIM)
+#include "hvac_sim.h"
+#endif
+#if defined(CONFIG_HVAC_PERSIST)
+#include "hvac_persist.h"
+#endif
+#if defined(CONFIG_HVAC_STORAGE)
+#include "hvac_storage.h"
+#endif
+#if defined(CONFIG_HVAC_CFG_CATALOG)
+#include "hvac_cfg_catalog.h"
+#endif
+#if defined(CONFIG_HVAC_LOG)
+#include "hvac_log.h"
+#endif
+#if defined(CONFIG_HVAC_LOG_BACKEND_LFS)
+#include "hvac_log_lfs.h"
+#endif
+#if defined(CONFIG_HVAC_LV_FS)
+#include "hvac_lv_fs.h"
+#endif
+#if defined(CONFIG_HVAC_JOURNAL)
+#include "hvac_journal.h"
+#endif
+#if defined(CONFIG_HVAC_MODBUS)
+#include "hvac_modbus.h"
+#endif
+#if defined(CONFIG_HVAC_MB_MASTER)
+#include "hvac_mb_master.h"
+#endif
+#if defined(CONFIG_HVAC_HTTP)
+#include "hvac_http.h"
+#endif
+#if defined(CONFIG_HVAC_TELEM)
+#include "hvac_telem.h"
+#endif
+#if defined(CONFIG_HVAC_SHELL)
+#include "hvac_shell.h"
+#endif
+#if defined(CONFIG_HVAC_MODBUS) || defined(CONFIG_HVAC_HTTP) || defined(CONFIG_HVAC_SHELL)
+#define HVAC_REMOTE_CFG 1
+#endif
+#if defined(CONFIG_HVAC_SIM_FAST) || defined(CONFIG_HVAC_BENCH)
+#include <zephyr/sys/printk.h>
+#endif
+#if defined(CONFIG_ARCH_POSIX)
+#include "posix_board_if.h"
+#endif
+#if defined(CONFIG_HVAC_BENCH)
+#include "hvac_bench.h"
+#endif
 
-LV_IMG_DECLARE(snowflake);
-LV_IMG_DECLARE(heater);
-LV_IMG_DECLARE(heat_exchange);
+#define button_color lv_color_hex(0x0A854A)
 
 LOG_MODULE_REGISTER(app, CONFIG_LOG_DEFAULT_LEVEL);
 
-#define HVAC_NUM_AI_CHANNELS 8
-#define HVAC_NUM_AO_CHANNELS 8
-
 #define ABSF(x) ((x) < 0.0f ? -(x) : (x))
 
-/* --- Placeholdery I/O --- */
+/* --- Warstwa I/O (obraz procesu w hvac_io.c) --- */
 
 static float read_ai_voltage(int ch)
 {
-    ARG_UNUSED(ch);
-    return 0.0f;
+    return hvac_io_ai_voltage(ch);
 }
 
 static float read_ao_voltage(int ch)
 {
-    ARG_UNUSED(ch);
-    return 0.0f;
+    return hvac_io_ao_voltage(ch);
 }
 
 static void write_ao_voltage(int ch, float voltage)
 {
-    ARG_UNUSED(ch);
-    ARG_UNUSED(voltage);
+    hvac_io_set_ao_voltage(ch, voltage);
 }
 
-/* --- Struktury konfiguracji --- */
-
-struct hvac_pid_cfg {
-    int32_t kp;
-    int32_t ki;
-    int32_t kd;
-};
-
-struct hvac_io_cfg {
-    int32_t t_supply_ai;        // temp. nawiewu
-    int32_t t_extract_ai;       // temp. wyciągu
-    int32_t t_exhaust_ai;       // temp. wyrzutni
-    int32_t t_outdoor_ai;       // temp. zewnętrzna / czerpnia
-    int32_t frost_ai;           // czujnik przeciwzamrożeniowy
-
-    int32_t bypass_ao;          // sterowanie bypassem wymiennika
-    int32_t fan_vfd_ao;         // falownik wentylatora
-    int32_t heater_ao;          // grzałka / nagrzewnica
-    int32_t cooler_ao;          // chłodnica
-};
-
-struct hvac_seq_band {
-    int32_t from_percent;
-    int32_t to_percent;
-};
-
-struct hvac_seq_cfg {
-    struct hvac_seq_band cooling;
-    struct hvac_seq_band heating;
-    struct hvac_seq_band heat_recovery;
-    struct hvac_seq_band deadband;
-};
-
-struct hvac_config {
-    int32_t setpoint;
-    struct hvac_pid_cfg pid;
-    struct hvac_io_cfg  io;
-    struct hvac_seq_cfg seq;
-    const char *sequence_type;   /* np. "cool_dead_heat" albo "cool_rec_dead_rec_heat" */
-};
+/* --- Stan regulatora --- */
 
 struct hvac_pid_state {
     float i_term;
@@ -120,6 +127,26 @@ static lv_obj_t *screen_seq_viewer;   /* nowy ekran */
 
 static lv_obj_t *config_status_label;
 
+#if defined(CONFIG_HVAC_CFG_CATALOG)
+#define HVAC_CATALOG_ROWS CONFIG_HVAC_CFG_CATALOG_PAGE_ROWS
+
+static lv_obj_t *catalog_row_btns[HVAC_CATALOG_ROWS];
+static lv_obj_t *catalog_row_labels[HVAC_CATALOG_ROWS];
+static lv_obj_t *catalog_page_label;
+static int catalog_page;
+static atomic_t catalog_dirty;      /* indeks zmieniony przez wątek karty */
+#endif
+
+#if defined(CONFIG_HVAC_JOURNAL)
+#define HVAC_DIAG_ROWS CONFIG_HVAC_JOURNAL_PAGE_ROWS
+
+static lv_obj_t *screen_diag;
+static lv_obj_t *diag_row_labels[HVAC_DIAG_ROWS];
+static lv_obj_t *diag_page_label;
+static uint32_t diag_top;           /* strona: rekordy o seq < diag_top */
+static bool diag_follow = true;     /* strona z najnowszymi rekordami */
+#endif
+
 static lv_obj_t *ai_value_labels[HVAC_NUM_AI_CHANNELS];
 static lv_obj_t *ai_unit_labels[HVAC_NUM_AI_CHANNELS];
 static lv_obj_t *ai_name_labels[HVAC_NUM_AI_CHANNELS];
@@ -142,6 +169,9 @@ static lv_obj_t *seq_to_labels[HVAC_SEQ_IDX_COUNT];
 
 static lv_obj_t *seq_viewer_image;    /* obrazek na ekranie Sequence Viewer */
 
+/* ikony dashboardu wg hvac_asset_id - po przeładowaniu paczki dostają nowe deskryptory */
+static lv_obj_t *asset_imgs[HVAC_ASSET_COUNT];
+
 struct seq_btn_ctx {
     uint8_t band_index;
     uint8_t is_from;
@@ -153,7 +183,7 @@ static struct seq_btn_ctx g_seq_btn_ctx[HVAC_SEQ_IDX_COUNT][2][2];
 /* --- Globalna konfiguracja --- */
 
 static struct hvac_config g_hvac_cfg = {
-    .setpoint = 0,
+    .setpoint = CONFIG_HVAC_SETPOINT_DEFAULT,
     .pid = { .kp = 0, .ki = 0, .kd = 0 },
     .io = {
         .t_supply_ai      = -1,
@@ -178,6 +208,32 @@ static struct hvac_config g_hvac_cfg = {
 };
 
 static struct hvac_pid_state g_hvac_pid_state;
+static bool g_hvac_ctrl_input_ok = true;   /* tylko wątek regulacji */
+
+/*
+ * g_hvac_cfg należy do wątku UI. Pętla regulacji pracuje na własnej kopii
+ * g_hvac_ctrl_cfg, którą na początku kroku podmienia w całości na ostatnią
+ * wersję opublikowaną przez hvac_cfg_publish() - nigdy nie widzi konfiguracji
+ * w połowie zapisu.
+ */
+static struct k_spinlock g_hvac_cfg_lock;
+static struct hvac_config g_hvac_cfg_pub;
+static uint32_t g_hvac_cfg_pub_gen;
+
+static struct hvac_config g_hvac_ctrl_cfg;
+static uint32_t g_hvac_ctrl_cfg_gen;
+
+#if defined(HVAC_REMOTE_CFG)
+/* zapis z Modbus/HTTP/powłoki czekający na wątek UI (pod g_hvac_cfg_lock) */
+static struct hvac_config g_hvac_cfg_remote;
+static bool g_hvac_cfg_remote_pending;
+#endif
+
+#if defined(CONFIG_HVAC_SHELL)
+/* wyjście regulatora z ostatniego kroku - dla "hvac io" i "hvac watch" */
+static struct k_spinlock g_hvac_ctl_out_lock;
+static struct hvac_shell_ctl g_hvac_ctl_out;
+#endif
 
 /* --- Forward declarations --- */
 
@@ -185,6 +241,9 @@ static void nav_to_dashboard(lv_event_t *e);
 static void nav_to_io(lv_event_t *e);
 static void nav_to_config(lv_event_t *e);
 static void nav_to_seq_viewer(lv_event_t *e);
+#if defined(CONFIG_HVAC_JOURNAL)
+static void nav_to_diag(lv_event_t *e);
+#endif
 
 static int  hvac_load_config_from_json(const char *json_src, size_t len,
                                       struct hvac_config *out_cfg);
@@ -192,6 +251,10 @@ static void hvac_apply_config(const struct hvac_config *cfg);
 
 static void on_btn_load_cfg1(lv_event_t *e);
 static void on_btn_load_cfg2(lv_event_t *e);
+#if defined(CONFIG_HVAC_CFG_CATALOG)
+static void on_catalog_row(lv_event_t *e);
+static void on_catalog_page(lv_event_t *e);
+#endif
 
 static void on_btn_setpoint_minus(lv_event_t *e);
 static void on_btn_setpoint_plus(lv_event_t *e);
@@ -205,6 +268,7 @@ static void on_io_show_ao(lv_event_t *e);
 
 static void hvac_refresh_dashboard(void);
 static void hvac_refresh_dashboard_setpoint(void);
+static void hvac_refresh_dashboard_seq_row(int i);
 static void hvac_refresh_dashboard_seq_labels(void);
 static void hvac_refresh_sequence_viewer(void);
 
@@ -220,11 +284,20 @@ static void hvac_apply_sequence(float pid_out_pct,
                                 float *cooler_pct,
                                 float *bypass_pct);
 
+static void hvac_cfg_publish(const struct hvac_config *cfg);
 static float hvac_get_extract_temp_c(void);
 static void hvac_control_step(float dt_sec);
 
 /* --- Pomocnicze --- */
 
+/* bity hvac_cfg_diff() dla wierszy pasm na dashboardzie */
+static const uint32_t hvac_seq_band_change_bits[HVAC_SEQ_IDX_COUNT] = {
+    [HVAC_SEQ_IDX_COOLING]       = HVAC_CFG_CH_SEQ_COOLING,
+    [HVAC_SEQ_IDX_HEATING]       = HVAC_CFG_CH_SEQ_HEATING,
+    [HVAC_SEQ_IDX_HEAT_RECOVERY] = HVAC_CFG_CH_SEQ_HEAT_REC,
+    [HVAC_SEQ_IDX_DEADBAND]      = HVAC_CFG_CH_SEQ_DEADBAND,
+};
+
 static struct hvac_seq_band *hvac_get_seq_band_by_index(struct hvac_seq_cfg *seq, int index)
 {
     switch (index) {
@@ -236,128 +309,26 @@ static struct hvac_seq_band *hvac_get_seq_band_by_index(struct hvac_seq_cfg *seq
     }
 }
 
-/* --- JSON config przykładowy --- */
-
-static char hvac_config1_json[] =
-    "{"
-    "  \"setpoint\": 21,"
-    "  \"pid\": {"
-    "    \"kp\": 10,"
-    "    \"ki\": 2,"
-    "    \"kd\": 1"
-    "  },"
-    "  \"seq\": {"
-    "    \"cooling\": {"
-    "      \"from_percent\": -100,"
-    "      \"to_percent\": -30"
-    "    },"
-    "    \"deadband\": {"
-    "      \"from_percent\": -30,"
-    "      \"to_percent\": 30"
-    "    },"
-    "    \"heating\": {"
-    "      \"from_percent\": 30,"
-    "      \"to_percent\": 100"
-    "    },"
-    "    \"heat_recovery\": {"
-    "      \"from_percent\": 0,"
-    "      \"to_percent\": 0"
-    "    }"
-    "  },"
-    "  \"sequence_type\": \"cool_dead_heat\","
-    "  \"io\": {"
-    "    \"t_supply_ai\": 0,"
-    "    \"t_extract_ai\": 1,"
-    "    \"t_exhaust_ai\": 2,"
-    "    \"t_outdoor_ai\": 3,"
-    "    \"frost_ai\": -1,"
-    "    \"bypass_ao\": -1,"
-    "    \"fan_vfd_ao\": 1,"
-    "    \"heater_ao\": 2,"
-    "    \"cooler_ao\": 3"
-    "  }"
-    "}";
-
-static char hvac_config2_json[] =
-    "{"
-    "  \"setpoint\": 23,"
-    "  \"pid\": {"
-    "    \"kp\": 15,"
-    "    \"ki\": 3,"
-    "    \"kd\": 2"
-    "  },"
-    "  \"seq\": {"
-    "    \"cooling\": {"
-    "      \"from_percent\": -100,"
-    "      \"to_percent\": -60"
-    "    },"
-    "    \"heating\": {"
-    "      \"from_percent\": 60,"
-    "      \"to_percent\": 100"
-    "    },"
-    "    \"heat_recovery\": {"
-    "      \"from_percent\": -60,"
-    "      \"to_percent\": 60"
-    "    },"
-    "    \"deadband\": {"
-    "      \"from_percent\": -10,"
-    "      \"to_percent\": 10"
-    "    }"
-    "  },"
-    "  \"sequence_type\": \"cool_rec_dead_rec_heat\","
-    "  \"io\": {"
-    "    \"t_supply_ai\": 1,"
-    "    \"t_extract_ai\": 0,"
-    "    \"t_exhaust_ai\": 2,"
-    "    \"t_outdoor_ai\": 3,"
-    "    \"frost_ai\": 4,"
-    "    \"bypass_ao\": 0,"
-    "    \"fan_vfd_ao\": 1,"
-    "    \"heater_ao\": 2,"
-    "    \"cooler_ao\": 3"
-    "  }"
-    "}";
-
-/* --- JSON deskriptory --- */
-
-static const struct json_obj_descr hvac_pid_descr[] = {
-    JSON_OBJ_DESCR_PRIM(struct hvac_pid_cfg, kp, JSON_TOK_NUMBER),
-    JSON_OBJ_DESCR_PRIM(struct hvac_pid_cfg, ki, JSON_TOK_NUMBER),
-    JSON_OBJ_DESCR_PRIM(struct hvac_pid_cfg, kd, JSON_TOK_NUMBER),
-};
+/* --- JSON config przykładowy (configs/config*.json) --- */
 
-static const struct json_obj_descr hvac_io_descr[] = {
-    JSON_OBJ_DESCR_PRIM(struct hvac_io_cfg, t_supply_ai,  JSON_TOK_NUMBER),
-    JSON_OBJ_DESCR_PRIM(struct hvac_io_cfg, t_extract_ai, JSON_TOK_NUMBER),
-    JSON_OBJ_DESCR_PRIM(struct hvac_io_cfg, t_exhaust_ai, JSON_TOK_NUMBER),
-    JSON_OBJ_DESCR_PRIM(struct hvac_io_cfg, t_outdoor_ai, JSON_TOK_NUMBER),
-    JSON_OBJ_DESCR_PRIM(struct hvac_io_cfg, frost_ai,     JSON_TOK_NUMBER),
-
-    JSON_OBJ_DESCR_PRIM(struct hvac_io_cfg, bypass_ao,    JSON_TOK_NUMBER),
-    JSON_OBJ_DESCR_PRIM(struct hvac_io_cfg, fan_vfd_ao,   JSON_TOK_NUMBER),
-    JSON_OBJ_DESCR_PRIM(struct hvac_io_cfg, heater_ao,    JSON_TOK_NUMBER),
-    JSON_OBJ_DESCR_PRIM(struct hvac_io_cfg, cooler_ao,    JSON_TOK_NUMBER),
+static const char hvac_config1_json[] = {
+#include "config1.json.inc"
 };
 
-static const struct json_obj_descr hvac_seq_band_descr[] = {
-    JSON_OBJ_DESCR_PRIM(struct hvac_seq_band, from_percent, JSON_TOK_NUMBER),
-    JSON_OBJ_DESCR_PRIM(struct hvac_seq_band, to_percent,   JSON_TOK_NUMBER),
+static const char hvac_config2_json[] = {
+#include "config2.json.inc"
 };
 
-static const struct json_obj_descr hvac_seq_descr[] = {
-    JSON_OBJ_DESCR_OBJECT(struct hvac_seq_cfg, cooling,       hvac_seq_band_descr),
-    JSON_OBJ_DESCR_OBJECT(struct hvac_seq_cfg, heating,       hvac_seq_band_descr),
-    JSON_OBJ_DESCR_OBJECT(struct hvac_seq_cfg, heat_recovery, hvac_seq_band_descr),
-    JSON_OBJ_DESCR_OBJECT(struct hvac_seq_cfg, deadband,      hvac_seq_band_descr),
+#if defined(CONFIG_HVAC_CFG_BIN)
+/* te same configi skompilowane do formatu binarnego (scripts/hvac_cfg2bin.py) */
+static const uint8_t hvac_config1_bin[] __aligned(4) = {
+#include "config1.bin.inc"
 };
 
-static const struct json_obj_descr hvac_cfg_descr[] = {
-    JSON_OBJ_DESCR_PRIM(struct hvac_config, setpoint, JSON_TOK_NUMBER),
-    JSON_OBJ_DESCR_OBJECT(struct hvac_config, pid, hvac_pid_descr),
-    JSON_OBJ_DESCR_OBJECT(struct hvac_config, io,  hvac_io_descr),
-    JSON_OBJ_DESCR_OBJECT(struct hvac_config, seq, hvac_seq_descr),
-    //JSON_OBJ_DESCR_PRIM(struct hvac_config, sequence_type, JSON_TOK_STRING),
+static const uint8_t hvac_config2_bin[] __aligned(4) = {
+#include "config2.bin.inc"
 };
+#endif
 
 /* --- Opisy ról kanałów --- */
 
@@ -376,10 +347,8 @@ static const char *const hvac_ao_role_names[] = {
     "Cooler",
 };
 
-static const char *hvac_ai_role_name_for_channel(int ch)
+static const char *hvac_ai_role_name_for_channel(const struct hvac_io_cfg *io, int ch)
 {
-    const struct hvac_io_cfg *io = &g_hvac_cfg.io;
-
     if (ch == io->t_supply_ai)      return "T supply";
     if (ch == io->t_extract_ai)     return "T extract";
     if (ch == io->t_exhaust_ai)     return "T exhaust";
@@ -389,10 +358,8 @@ static const char *hvac_ai_role_name_for_channel(int ch)
     return "Unused";
 }
 
-static const char *hvac_ao_role_name_for_channel(int ch)
+static const char *hvac_ao_role_name_for_channel(const struct hvac_io_cfg *io, int ch)
 {
-    const struct hvac_io_cfg *io = &g_hvac_cfg.io;
-
     if (ch == io->bypass_ao)   return "Bypass";
     if (ch == io->fan_vfd_ao)  return "Fan VFD";
     if (ch == io->heater_ao)   return "Heater";
@@ -430,14 +397,34 @@ static void hvac_refresh_io_role_labels(void)
 {
     for (int i = 0; i < HVAC_NUM_AI_CHANNELS; i++) {
         if (ai_name_labels[i]) {
-            const char *role = hvac_ai_role_name_for_channel(i);
+            const char *role = hvac_ai_role_name_for_channel(&g_hvac_cfg.io, i);
             lv_label_set_text(ai_name_labels[i], role);
         }
     }
 
     for (int i = 0; i < HVAC_NUM_AO_CHANNELS; i++) {
         if (ao_name_labels[i]) {
-            const char *role = hvac_ao_role_name_for_channel(i);
+            const char *role = hvac_ao_role_name_for_channel(&g_hvac_cfg.io, i);
+            lv_label_set_text(ao_name_labels[i], role);
+        }
+    }
+}
+
+/* tylko kanały, których rola faktycznie się zmieniła względem old */
+static void hvac_refresh_io_role_labels_diff(const struct hvac_io_cfg *old)
+{
+    for (int i = 0; i < HVAC_NUM_AI_CHANNELS; i++) {
+        const char *role = hvac_ai_role_name_for_channel(&g_hvac_cfg.io, i);
+
+        if (ai_name_labels[i] && role != hvac_ai_role_name_for_channel(old, i)) {
+            lv_label_set_text(ai_name_labels[i], role);
+        }
+    }
+
+    for (int i = 0; i < HVAC_NUM_AO_CHANNELS; i++) {
+        const char *role = hvac_ao_role_name_for_channel(&g_hvac_cfg.io, i);
+
+        if (ao_name_labels[i] && role != hvac_ao_role_name_for_channel(old, i)) {
             lv_label_set_text(ao_name_labels[i], role);
         }
     }
@@ -474,6 +461,15 @@ static void create_nav_buttons(lv_obj_t *nav_container)
     lv_obj_center(lbl_cfg);
     lv_obj_add_event_cb(btn_cfg, nav_to_config, LV_EVENT_CLICKED, NULL);
     lv_obj_set_style_bg_color(btn_cfg, button_color, LV_PART_MAIN | LV_STATE_DEFAULT);
+
+#if defined(CONFIG_HVAC_JOURNAL)
+    lv_obj_t *btn_diag = lv_btn_create(nav_container);
+    lv_obj_t *lbl_diag = lv_label_create(btn_diag);
+    lv_label_set_text(lbl_diag, "Diag");
+    lv_obj_center(lbl_diag);
+    lv_obj_add_event_cb(btn_diag, nav_to_diag, LV_EVENT_CLICKED, NULL);
+    lv_obj_set_style_bg_color(btn_diag, button_color, LV_PART_MAIN | LV_STATE_DEFAULT);
+#endif
 }
 
 static void create_header(lv_obj_t *parent, const char *title_text)
@@ -512,39 +508,42 @@ static void hvac_refresh_dashboard_setpoint(void)
     lv_label_set_text(setpoint_label, buf);
 }
 
-static void hvac_refresh_dashboard_seq_labels(void)
+static void hvac_refresh_dashboard_seq_row(int i)
 {
-    struct hvac_seq_cfg *seq = &g_hvac_cfg.seq;
+    lv_obj_t *row = seq_rows[i];
+    if (!row) {
+        return;
+    }
 
-    for (int i = 0; i < HVAC_SEQ_IDX_COUNT; i++) {
-        lv_obj_t *row = seq_rows[i];
-        if (!row) {
-            continue;
-        }
+    struct hvac_seq_band *band = hvac_get_seq_band_by_index(&g_hvac_cfg.seq, i);
+    if (!band) {
+        return;
+    }
 
-        struct hvac_seq_band *band = hvac_get_seq_band_by_index(seq, i);
-        if (!band) {
-            continue;
-        }
+    bool active = (band->from_percent != band->to_percent);
 
-        bool active = (band->from_percent != band->to_percent);
+    if (active) {
+        lv_obj_clear_flag(row, LV_OBJ_FLAG_HIDDEN);
+    } else {
+        lv_obj_add_flag(row, LV_OBJ_FLAG_HIDDEN);
+    }
 
-        if (active) {
-            lv_obj_clear_flag(row, LV_OBJ_FLAG_HIDDEN);
-        } else {
-            lv_obj_add_flag(row, LV_OBJ_FLAG_HIDDEN);
-        }
+    char buf[16];
 
-        char buf[16];
+    if (seq_from_labels[i]) {
+        snprintf(buf, sizeof(buf), "%d %%", band->from_percent);
+        lv_label_set_text(seq_from_labels[i], buf);
+    }
+    if (seq_to_labels[i]) {
+        snprintf(buf, sizeof(buf), "%d %%", band->to_percent);
+        lv_label_set_text(seq_to_labels[i], buf);
+    }
+}
 
-        if (seq_from_labels[i]) {
-            snprintf(buf, sizeof(buf), "%d %%", band->from_percent);
-            lv_label_set_text(seq_from_labels[i], buf);
-        }
-        if (seq_to_labels[i]) {
-            snprintf(buf, sizeof(buf), "%d %%", band->to_percent);
-            lv_label_set_text(seq_to_labels[i], buf);
-        }
+static void hvac_refresh_dashboard_seq_labels(void)
+{
+    for (int i = 0; i < HVAC_SEQ_IDX_COUNT; i++) {
+        hvac_refresh_dashboard_seq_row(i);
     }
 }
 
@@ -564,9 +563,9 @@ static void hvac_refresh_sequence_viewer(void)
 
     if (g_hvac_cfg.sequence_type != NULL) {
         if (strcmp(g_hvac_cfg.sequence_type, "cool_dead_heat") == 0) {
-            img = &seq_img_cool_dead_heat;
+            img = hvac_asset(HVAC_ASSET_SEQ_COOL_DEAD_HEAT);
         } else if (strcmp(g_hvac_cfg.sequence_type, "cool_rec_dead_rec_heat") == 0) {
-            img = &seq_img_cool_rec_dead_rec_heat;
+            img = hvac_asset(HVAC_ASSET_SEQ_COOL_REC_DEAD_REC_HEAT);
         }
     }
 
@@ -575,20 +574,56 @@ static void hvac_refresh_sequence_viewer(void)
     }
 }
 
+static void hvac_set_asset(lv_obj_t *img, enum hvac_asset_id id)
+{
+    const lv_img_dsc_t *src = hvac_asset(id);
+
+    asset_imgs[id] = img;
+    if (src) {
+        lv_img_set_src(img, src);
+    }
+}
+
+#if defined(CONFIG_HVAC_ASSETS)
+static void hvac_refresh_assets(void)
+{
+    for (int i = 0; i < HVAC_ASSET_COUNT; i++) {
+        if (asset_imgs[i] != NULL) {
+            hvac_set_asset(asset_imgs[i], i);
+        }
+    }
+    hvac_refresh_sequence_viewer();
+}
+#endif
+
 /* --- Dashboard handlers --- */
 
 static void on_btn_setpoint_minus(lv_event_t *e)
 {
     ARG_UNUSED(e);
+    if (g_hvac_cfg.setpoint <= CONFIG_HVAC_SETPOINT_MIN) {
+        return;
+    }
     g_hvac_cfg.setpoint -= 1;
+    hvac_cfg_publish(&g_hvac_cfg);
     hvac_refresh_dashboard_setpoint();
+#if defined(CONFIG_HVAC_PERSIST)
+    hvac_persist_request(&g_hvac_cfg);
+#endif
 }
 
 static void on_btn_setpoint_plus(lv_event_t *e)
 {
     ARG_UNUSED(e);
+    if (g_hvac_cfg.setpoint >= CONFIG_HVAC_SETPOINT_MAX) {
+        return;
+    }
     g_hvac_cfg.setpoint += 1;
+    hvac_cfg_publish(&g_hvac_cfg);
     hvac_refresh_dashboard_setpoint();
+#if defined(CONFIG_HVAC_PERSIST)
+    hvac_persist_request(&g_hvac_cfg);
+#endif
 }
 
 static void on_seq_band_adjust(lv_event_t *e)
@@ -617,7 +652,11 @@ static void on_seq_band_adjust(lv_event_t *e)
         band->to_percent = band->from_percent;
     }
 
-    hvac_refresh_dashboard_seq_labels();
+    hvac_cfg_publish(&g_hvac_cfg);
+    hvac_refresh_dashboard_seq_row(ctx->band_index);
+#if defined(CONFIG_HVAC_PERSIST)
+    hvac_persist_request(&g_hvac_cfg);
+#endif
 }
 
 /* callback: pokaż Screen 1 (setpoint + cooling + heating) */
@@ -737,7 +776,7 @@ static void create_dashboard_screen(void)
 
     /* Ikona nastawy temperatury */
     lv_obj_t *img_sp = lv_img_create(row_sp);
-    lv_img_set_src(img_sp, &TP_type1__not_active);
+    hvac_set_asset(img_sp, HVAC_ASSET_SETPOINT);
     lv_img_set_zoom(img_sp, 128);
     lv_obj_set_size(img_sp, 32, 32);
 
@@ -785,18 +824,18 @@ static void create_dashboard_screen(void)
 
         if (i == HVAC_SEQ_IDX_COOLING) {
             lv_obj_t *img_cool = lv_img_create(row);
-            lv_img_set_src(img_cool, &snowflake);   /* nazwa jak w LV_IMG_DECLARE */
+            hvac_set_asset(img_cool, HVAC_ASSET_SNOWFLAKE);
             lv_img_set_zoom(img_cool, 128);              /* podobnie jak przy TP_type1__not_active */
             lv_obj_set_size(img_cool, 32, 32);
         } else if (i == HVAC_SEQ_IDX_HEATING) {
             lv_obj_t *img_heat = lv_img_create(row);
-            lv_img_set_src(img_heat, &heater);   /* nazwa jak w LV_IMG_DECLARE */
+            hvac_set_asset(img_heat, HVAC_ASSET_HEATER);
             lv_img_set_zoom(img_heat, 128);          /* podobnie jak przy TP_type1__not_active */
             lv_obj_set_size(img_heat, 32, 32);
         }else if (i == HVAC_SEQ_IDX_HEAT_RECOVERY)
         {
             lv_obj_t *img_heat_ex = lv_img_create(row);
-            lv_img_set_src(img_heat_ex, &heat_exchange);   
+            hvac_set_asset(img_heat_ex, HVAC_ASSET_HEAT_EXCHANGE);
             lv_img_set_zoom(img_heat_ex, 128);          
             lv_obj_set_size(img_heat_ex, 32, 32);
         }
@@ -1064,7 +1103,7 @@ static void create_io_visualiser(lv_obj_t *parent)
         lv_label_set_text(lbl_ai_unit, "V");
         ai_unit_labels[i] = lbl_ai_unit;
 
-        const char *ai_role = hvac_ai_role_name_for_channel(i);
+        const char *ai_role = hvac_ai_role_name_for_channel(&g_hvac_cfg.io, i);
         lv_obj_t *lbl_ai_name = lv_label_create(row);
         lv_label_set_text(lbl_ai_name, ai_role);
         ai_name_labels[i] = lbl_ai_name;
@@ -1157,7 +1196,7 @@ static void create_io_visualiser(lv_obj_t *parent)
         lv_label_set_text(lbl_ao_unit, "V");
         ao_unit_labels[i] = lbl_ao_unit;
 
-        const char *ao_role = hvac_ao_role_name_for_channel(i);
+        const char *ao_role = hvac_ao_role_name_for_channel(&g_hvac_cfg.io, i);
         lv_obj_t *lbl_ao_name = lv_label_create(row);
         lv_label_set_text(lbl_ao_name, ao_role);
         ao_name_labels[i] = lbl_ao_name;
@@ -1182,6 +1221,91 @@ static void create_io_screen(void)
 
 /* --- Ekran Config --- */
 
+#if defined(CONFIG_HVAC_CFG_CATALOG)
+/* --- Katalog configów z karty SD --- */
+
+/* ekran czyta tylko indeks - stała liczba wierszy, niezależnie od liczby plików */
+static void hvac_refresh_catalog_page(void)
+{
+    int count = hvac_cfg_catalog_count();
+    int pages = (count + HVAC_CATALOG_ROWS - 1) / HVAC_CATALOG_ROWS;
+
+    if (count < 0) {
+        count = 0;
+    }
+    if (pages < 1) {
+        pages = 1;
+    }
+    if (catalog_page >= pages) {
+        catalog_page = pages - 1;
+    }
+
+    for (int i = 0; i < HVAC_CATALOG_ROWS; i++) {
+        struct hvac_cfg_catalog_entry ent;
+        int idx = catalog_page * HVAC_CATALOG_ROWS + i;
+
+        if (hvac_cfg_catalog_get(idx, &ent) != 0) {
+            lv_obj_add_flag(catalog_row_btns[i], LV_OBJ_FLAG_HIDDEN);
+            continue;
+        }
+
+        char buf[HVAC_CFG_CATALOG_NAME_LEN + 48];
+
+        if (ent.flags & HVAC_CFG_CATALOG_F_BAD) {
+            snprintf(buf, sizeof(buf), "%s  (invalid)", ent.name);
+        } else {
+            snprintf(buf, sizeof(buf), "%s  SP %d C  %s", ent.name, ent.setpoint,
+                     ent.seq_type ? hvac_cfg_seq_types[ent.seq_type - 1] : "-");
+        }
+
+        lv_label_set_text(catalog_row_labels[i], buf);
+        lv_obj_set_style_bg_color(catalog_row_btns[i],
+                                  (ent.flags & HVAC_CFG_CATALOG_F_BAD) ?
+                                  lv_palette_main(LV_PALETTE_GREY) : button_color,
+                                  LV_PART_MAIN | LV_STATE_DEFAULT);
+        lv_obj_clear_flag(catalog_row_btns[i], LV_OBJ_FLAG_HIDDEN);
+    }
+
+    char buf[24];
+    snprintf(buf, sizeof(buf), "%d / %d  (%d)", catalog_page + 1, pages, count);
+    lv_label_set_text(catalog_page_label, buf);
+}
+
+static void on_catalog_page(lv_event_t *e)
+{
+    int delta = (int)(intptr_t)lv_event_get_user_data(e);
+
+    if (catalog_page + delta < 0) {
+        return;
+    }
+    catalog_page += delta;
+    hvac_refresh_catalog_page();
+}
+
+static void on_catalog_row(lv_event_t *e)
+{
+    struct hvac_cfg_catalog_entry ent;
+    struct hvac_config tmp;
+    char buf[HVAC_CFG_CATALOG_NAME_LEN + 16];
+    int idx = catalog_page * HVAC_CATALOG_ROWS + (int)(intptr_t)lv_event_get_user_data(e);
+
+    if (hvac_cfg_catalog_get(idx, &ent) != 0) {
+        return;
+    }
+
+    /* parsowany jest tylko wybrany plik */
+    int ret = hvac_cfg_catalog_load(idx, &tmp);
+
+    if (ret == 0) {
+        hvac_apply_config(&tmp);
+        snprintf(buf, sizeof(buf), "Loaded %s", ent.name);
+    } else {
+        snprintf(buf, sizeof(buf), "Error loading %s", ent.name);
+    }
+    lv_label_set_text(config_status_label, buf);
+}
+#endif /* CONFIG_HVAC_CFG_CATALOG */
+
 static void create_config_screen(void)
 {
     screen_config = lv_obj_create(NULL);
@@ -1202,22 +1326,86 @@ static void create_config_screen(void)
     lv_obj_set_style_border_width(cont, 0, LV_PART_MAIN);
     lv_obj_set_style_bg_opa(cont, LV_OPA_TRANSP, LV_PART_MAIN);
 
-    lv_obj_t *btn1 = lv_btn_create(cont);
+#if defined(CONFIG_HVAC_CFG_CATALOG)
+    /* wbudowane configi w jednym wierszu, pod nimi lista z karty SD */
+    lv_obj_t *builtin = lv_obj_create(cont);
+    lv_obj_set_size(builtin, LV_PCT(100), LV_SIZE_CONTENT);
+    lv_obj_set_flex_flow(builtin, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(builtin,
+                          LV_FLEX_ALIGN_CENTER,
+                          LV_FLEX_ALIGN_CENTER,
+                          LV_FLEX_ALIGN_CENTER);
+    lv_obj_clear_flag(builtin, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_pad_all(builtin, 0, LV_PART_MAIN);
+    lv_obj_set_style_border_width(builtin, 0, LV_PART_MAIN);
+    lv_obj_set_style_bg_opa(builtin, LV_OPA_TRANSP, LV_PART_MAIN);
+#else
+    lv_obj_t *builtin = cont;
+#endif
+
+    lv_obj_t *btn1 = lv_btn_create(builtin);
     lv_obj_t *lbl1 = lv_label_create(btn1);
     lv_label_set_text(lbl1, "Load Config 1");
     lv_obj_center(lbl1);
     lv_obj_add_event_cb(btn1, on_btn_load_cfg1, LV_EVENT_CLICKED, NULL);
     lv_obj_set_style_bg_color(btn1, button_color, LV_PART_MAIN | LV_STATE_DEFAULT);
 
-    lv_obj_t *btn2 = lv_btn_create(cont);
+    lv_obj_t *btn2 = lv_btn_create(builtin);
     lv_obj_t *lbl2 = lv_label_create(btn2);
     lv_label_set_text(lbl2, "Load Config 2");
     lv_obj_center(lbl2);
     lv_obj_add_event_cb(btn2, on_btn_load_cfg2, LV_EVENT_CLICKED, NULL);
     lv_obj_set_style_bg_color(btn2, button_color, LV_PART_MAIN | LV_STATE_DEFAULT);
 
-    config_status_label = lv_label_create(cont);
+    config_status_label = lv_label_create(builtin);
     lv_label_set_text(config_status_label, "No config loaded");
+
+#if defined(CONFIG_HVAC_CFG_CATALOG)
+    for (int i = 0; i < HVAC_CATALOG_ROWS; i++) {
+        lv_obj_t *btn = lv_btn_create(cont);
+        lv_obj_set_size(btn, LV_PCT(100), 26);
+        lv_obj_set_style_pad_ver(btn, 2, LV_PART_MAIN);
+        lv_obj_add_event_cb(btn, on_catalog_row, LV_EVENT_CLICKED, (void *)(intptr_t)i);
+
+        lv_obj_t *lbl = lv_label_create(btn);
+        lv_obj_set_width(lbl, LV_PCT(100));
+        lv_label_set_long_mode(lbl, LV_LABEL_LONG_DOT);
+        lv_obj_align(lbl, LV_ALIGN_LEFT_MID, 0, 0);
+
+        catalog_row_btns[i]   = btn;
+        catalog_row_labels[i] = lbl;
+    }
+
+    lv_obj_t *pager = lv_obj_create(cont);
+    lv_obj_set_size(pager, LV_PCT(100), LV_SIZE_CONTENT);
+    lv_obj_set_flex_flow(pager, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(pager,
+                          LV_FLEX_ALIGN_CENTER,
+                          LV_FLEX_ALIGN_CENTER,
+                          LV_FLEX_ALIGN_CENTER);
+    lv_obj_clear_flag(pager, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_pad_all(pager, 0, LV_PART_MAIN);
+    lv_obj_set_style_border_width(pager, 0, LV_PART_MAIN);
+    lv_obj_set_style_bg_opa(pager, LV_OPA_TRANSP, LV_PART_MAIN);
+
+    lv_obj_t *btn_prev = lv_btn_create(pager);
+    lv_obj_t *lbl_prev = lv_label_create(btn_prev);
+    lv_label_set_text(lbl_prev, LV_SYMBOL_LEFT);
+    lv_obj_center(lbl_prev);
+    lv_obj_add_event_cb(btn_prev, on_catalog_page, LV_EVENT_CLICKED, (void *)(intptr_t)-1);
+    lv_obj_set_style_bg_color(btn_prev, button_color, LV_PART_MAIN | LV_STATE_DEFAULT);
+
+    catalog_page_label = lv_label_create(pager);
+
+    lv_obj_t *btn_next = lv_btn_create(pager);
+    lv_obj_t *lbl_next = lv_label_create(btn_next);
+    lv_label_set_text(lbl_next, LV_SYMBOL_RIGHT);
+    lv_obj_center(lbl_next);
+    lv_obj_add_event_cb(btn_next, on_catalog_page, LV_EVENT_CLICKED, (void *)(intptr_t)1);
+    lv_obj_set_style_bg_color(btn_next, button_color, LV_PART_MAIN | LV_STATE_DEFAULT);
+
+    hvac_refresh_catalog_page();
+#endif
 }
 
 /* --- Ekran Sequence Viewer --- */
@@ -1251,6 +1439,126 @@ static void create_seq_viewer_screen(void)
     hvac_refresh_sequence_viewer();
 }
 
+#if defined(CONFIG_HVAC_JOURNAL)
+/* --- Ekran Diagnostics --- */
+
+/* jedna strona = HVAC_DIAG_ROWS odczytów flasha, niezależnie od długości dziennika */
+static void hvac_refresh_diag_page(void)
+{
+    struct hvac_journal_rec recs[HVAC_DIAG_ROWS];
+
+    if (diag_follow) {
+        diag_top = hvac_journal_head();
+    }
+
+    int n = hvac_journal_read(diag_top, recs, HVAC_DIAG_ROWS);
+    if (n < 0) {
+        n = 0;
+    }
+
+    for (int i = 0; i < HVAC_DIAG_ROWS; i++) {
+        char buf[64];
+
+        if (i >= n) {
+            lv_label_set_text(diag_row_labels[i], "");
+            continue;
+        }
+
+        const struct hvac_journal_rec *r = &recs[i];
+
+        /* czas od startu - każdy start zaczyna się wpisem "Boot" */
+        snprintf(buf, sizeof(buf), "#%u  %u:%02u:%02u  %s  ch %u  %d",
+                 r->seq, r->t_s / 3600, (r->t_s / 60) % 60, r->t_s % 60,
+                 hvac_journal_code_name(r->code), r->channel, r->value);
+        lv_label_set_text(diag_row_labels[i], buf);
+    }
+
+    char buf[40];
+    snprintf(buf, sizeof(buf), "%s  (lost %u)", diag_follow ? "newest" : "history",
+             hvac_journal_dropped());
+    lv_label_set_text(diag_page_label, buf);
+}
+
+static void on_diag_page(lv_event_t *e)
+{
+    int delta = (int)(intptr_t)lv_event_get_user_data(e);
+    struct hvac_journal_rec rec;
+
+    if (delta < 0) {
+        /* starsza strona tylko, jeśli jest na niej choć jeden rekord */
+        if (diag_top <= HVAC_DIAG_ROWS ||
+            hvac_journal_read(diag_top - HVAC_DIAG_ROWS, &rec, 1) != 1) {
+            return;
+        }
+        diag_top -= HVAC_DIAG_ROWS;
+        diag_follow = false;
+    } else {
+        diag_top += HVAC_DIAG_ROWS;
+        diag_follow = (diag_top >= hvac_journal_head());
+    }
+    hvac_refresh_diag_page();
+}
+
+static void create_diag_screen(void)
+{
+    screen_diag = lv_obj_create(NULL);
+    lv_obj_clear_flag(screen_diag, LV_OBJ_FLAG_SCROLLABLE);
+    create_header(screen_diag, "Diagnostics");
+
+    lv_obj_t *cont = lv_obj_create(screen_diag);
+    lv_obj_set_size(cont, LV_PCT(100), LV_PCT(80));
+    lv_obj_align(cont, LV_ALIGN_BOTTOM_MID, 0, 0);
+
+    lv_obj_set_flex_flow(cont, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_flex_align(cont,
+                          LV_FLEX_ALIGN_START,
+                          LV_FLEX_ALIGN_START,
+                          LV_FLEX_ALIGN_CENTER);
+    lv_obj_clear_flag(cont, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_pad_all(cont, 4, LV_PART_MAIN);
+    lv_obj_set_style_border_width(cont, 0, LV_PART_MAIN);
+    lv_obj_set_style_bg_opa(cont, LV_OPA_TRANSP, LV_PART_MAIN);
+
+    for (int i = 0; i < HVAC_DIAG_ROWS; i++) {
+        lv_obj_t *lbl = lv_label_create(cont);
+        lv_obj_set_width(lbl, LV_PCT(100));
+        lv_label_set_long_mode(lbl, LV_LABEL_LONG_DOT);
+        diag_row_labels[i] = lbl;
+    }
+
+    lv_obj_t *pager = lv_obj_create(cont);
+    lv_obj_set_size(pager, LV_PCT(100), LV_SIZE_CONTENT);
+    lv_obj_set_flex_flow(pager, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(pager,
+                          LV_FLEX_ALIGN_CENTER,
+                          LV_FLEX_ALIGN_CENTER,
+                          LV_FLEX_ALIGN_CENTER);
+    lv_obj_clear_flag(pager, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_pad_all(pager, 0, LV_PART_MAIN);
+    lv_obj_set_style_border_width(pager, 0, LV_PART_MAIN);
+    lv_obj_set_style_bg_opa(pager, LV_OPA_TRANSP, LV_PART_MAIN);
+
+    /* w lewo starsze, w prawo nowsze */
+    lv_obj_t *btn_prev = lv_btn_create(pager);
+    lv_obj_t *lbl_prev = lv_label_create(btn_prev);
+    lv_label_set_text(lbl_prev, LV_SYMBOL_LEFT);
+    lv_obj_center(lbl_prev);
+    lv_obj_add_event_cb(btn_prev, on_diag_page, LV_EVENT_CLICKED, (void *)(intptr_t)-1);
+    lv_obj_set_style_bg_color(btn_prev, button_color, LV_PART_MAIN | LV_STATE_DEFAULT);
+
+    diag_page_label = lv_label_create(pager);
+
+    lv_obj_t *btn_next = lv_btn_create(pager);
+    lv_obj_t *lbl_next = lv_label_create(btn_next);
+    lv_label_set_text(lbl_next, LV_SYMBOL_RIGHT);
+    lv_obj_center(lbl_next);
+    lv_obj_add_event_cb(btn_next, on_diag_page, LV_EVENT_CLICKED, (void *)(intptr_t)1);
+    lv_obj_set_style_bg_color(btn_next, button_color, LV_PART_MAIN | LV_STATE_DEFAULT);
+
+    hvac_refresh_diag_page();
+}
+#endif /* CONFIG_HVAC_JOURNAL */
+
 /* --- Nawigacja ekranów --- */
 
 static void nav_to_dashboard(lv_event_t *e)
@@ -1285,38 +1593,35 @@ static void nav_to_seq_viewer(lv_event_t *e)
     }
 }
 
+#if defined(CONFIG_HVAC_JOURNAL)
+static void nav_to_diag(lv_event_t *e)
+{
+    ARG_UNUSED(e);
+    if (screen_diag != NULL) {
+        diag_follow = true;
+        hvac_refresh_diag_page();
+        lv_scr_load(screen_diag);
+    }
+}
+#endif
+
 /* --- JSON loader --- */
 /* --- JSON loader --- */
 
 static int hvac_load_config_from_json(const char *json_src, size_t len,
                                       struct hvac_config *out_cfg)
 {
-    char buf[612];
-
-    /* Ze sizeof() masz zwykle wliczone końcowe '\0', obetnij je */
-    if (len > 0 && json_src[len - 1] == '\0') {
-        len--;
-    }
-
-    if (len >= sizeof(buf)) {
-        LOG_ERR("JSON too big for local buffer (%u bytes)", (unsigned)len);
-        return -ENOMEM;
-    }
-
-    memcpy(buf, json_src, len);
-    buf[len] = '\0';
-
-    memset(out_cfg, 0, sizeof(*out_cfg));
-
-    int ret = json_obj_parse(buf, len,
-                             hvac_cfg_descr,
-                             ARRAY_SIZE(hvac_cfg_descr),
-                             out_cfg);
+    /* parser strumieniowy - bez kopii dokumentu na stosie */
+    int ret = hvac_cfg_json_load_mem(json_src, len, out_cfg);
 
     if (ret < 0) {
         LOG_ERR("JSON parse error: %d", ret);
         return ret;
     }
+    if (!hvac_cfg_validate(out_cfg)) {
+        LOG_ERR("JSON config: value out of range");
+        return -ERANGE;
+    }
 
     LOG_INF("Loaded config: setpoint=%d, kp=%d, ki=%d, kd=%d, "
             "cool=[%d,%d], db=[%d,%d], heat=[%d,%d], HR=[%d,%d]",
@@ -1434,47 +1739,206 @@ static void hvac_apply_sequence(float pid_out_pct,
     }
 }
 
+/* --- Podmiana konfiguracji pętli regulacji --- */
+
+static void hvac_cfg_publish(const struct hvac_config *cfg)
+{
+    k_spinlock_key_t key = k_spin_lock(&g_hvac_cfg_lock);
+
+    g_hvac_cfg_pub = *cfg;
+    g_hvac_cfg_pub_gen++;
+
+    k_spin_unlock(&g_hvac_cfg_lock, key);
+
+#if defined(CONFIG_HVAC_MODBUS)
+    hvac_modbus_cfg_changed(cfg);
+#endif
+}
+
+#if defined(HVAC_REMOTE_CFG)
+/*
+ * Wątki Modbus, HTTP i powłoki nie dotykają g_hvac_cfg: zapis czeka na
+ * hvac_apply_config() w pętli UI. Kolejne zapisy przed przejęciem
+ * nadpisują się - każdy powstaje z poprzedniego, więc liczy się ostatni.
+ */
+static void hvac_remote_set_cfg(const struct hvac_config *cfg)
+{
+    k_spinlock_key_t key = k_spin_lock(&g_hvac_cfg_lock);
+
+    g_hvac_cfg_remote = *cfg;
+    g_hvac_cfg_remote_pending = true;
+
+    k_spin_unlock(&g_hvac_cfg_lock, key);
+}
+
+#if defined(CONFIG_HVAC_MODBUS)
+static const struct hvac_modbus_ops hvac_mb_ops = {
+    .set_cfg = hvac_remote_set_cfg,
+};
+#endif
+
+#if defined(CONFIG_HVAC_HTTP) || defined(CONFIG_HVAC_SHELL)
+/* zapis czekający na UI jest nowszy od opublikowanego */
+static void hvac_remote_get_cfg(struct hvac_config *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&g_hvac_cfg_lock);
+
+    *out = g_hvac_cfg_remote_pending ? g_hvac_cfg_remote : g_hvac_cfg_pub;
+
+    k_spin_unlock(&g_hvac_cfg_lock, key);
+}
+
+#endif
+
+#if defined(CONFIG_HVAC_HTTP)
+static const struct hvac_http_ops hvac_http_ops = {
+    .get_cfg = hvac_remote_get_cfg,
+    .set_cfg = hvac_remote_set_cfg,
+};
+#endif
+
+#if defined(CONFIG_HVAC_SHELL)
+static void hvac_shell_get_ctl(struct hvac_shell_ctl *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&g_hvac_ctl_out_lock);
+
+    *out = g_hvac_ctl_out;
+
+    k_spin_unlock(&g_hvac_ctl_out_lock, key);
+}
+
+static const struct hvac_shell_ops hvac_shell_ops = {
+    .get_cfg = hvac_remote_get_cfg,
+    .set_cfg = hvac_remote_set_cfg,
+    .get_ctl = hvac_shell_get_ctl,
+};
+#endif
+
+/* wątek UI */
+static bool hvac_take_remote_config(struct hvac_config *out)
+{
+    bool pending;
+
+    k_spinlock_key_t key = k_spin_lock(&g_hvac_cfg_lock);
+
+    pending = g_hvac_cfg_remote_pending;
+    if (pending) {
+        *out = g_hvac_cfg_remote;
+        g_hvac_cfg_remote_pending = false;
+    }
+
+    k_spin_unlock(&g_hvac_cfg_lock, key);
+    return pending;
+}
+#endif
+
+/*
+ * Wołane z wątku regulacji na początku kroku. Stan PI jest zerowany tylko
+ * wtedy, gdy zmieniły się nastawy albo wejście pętli - zmiana zadanej,
+ * pasm sekwencji czy wyjść AO nie gubi całki (przejście bezuderzeniowe).
+ */
+static void hvac_ctrl_sync_config(void)
+{
+    struct hvac_config next;
+    uint32_t gen;
+
+    k_spinlock_key_t key = k_spin_lock(&g_hvac_cfg_lock);
+
+    gen = g_hvac_cfg_pub_gen;
+    if (gen == g_hvac_ctrl_cfg_gen) {
+        k_spin_unlock(&g_hvac_cfg_lock, key);
+        return;
+    }
+    next = g_hvac_cfg_pub;
+
+    k_spin_unlock(&g_hvac_cfg_lock, key);
+
+    uint32_t changed = hvac_cfg_diff(&g_hvac_ctrl_cfg, &next);
+
+    if (changed & (HVAC_CFG_CH_PID | HVAC_CFG_CH_LOOP_INPUT)) {
+        hvac_pid_reset(&g_hvac_pid_state);
+    }
+
+    g_hvac_ctrl_cfg = next;
+    g_hvac_ctrl_cfg_gen = gen;
+}
+
 static float hvac_get_extract_temp_c(void)
 {
-    int ch = g_hvac_cfg.io.t_extract_ai;
-    if (ch < 0 || ch >= HVAC_NUM_AI_CHANNELS) {
-        return 0.0f;
+    int ch = g_hvac_ctrl_cfg.io.t_extract_ai;
+    if (ch < 0 || ch >= HVAC_NUM_AI_INPUTS) {
+        return NAN;
     }
 
+    /* NAN z wejścia zewnętrznego bez ważnego odczytu przechodzi dalej */
     float v = read_ai_voltage(ch);
 
     /* placeholder: 1 V = 5 C */
-    return v * 5.0f;
+    return v * HVAC_TEMP_C_PER_VOLT;
 }
 
 static void hvac_control_step(float dt_sec)
 {
-    float t_extract = hvac_get_extract_temp_c();
-    float sp = (float)g_hvac_cfg.setpoint;
-    float error = sp - t_extract;
+#if defined(CONFIG_HVAC_TELEM)
+    uint32_t step_start = k_cycle_get_32();
+#endif
 
-    float u_pct = hvac_pid_step(&g_hvac_cfg.pid,
-                                &g_hvac_pid_state,
-                                error,
-                                dt_sec);
+    hvac_ctrl_sync_config();
 
+    float t_extract = hvac_get_extract_temp_c();
+    float u_pct = 0.0f;
     float heater_pct = 0.0f;
     float cooler_pct = 0.0f;
     float bypass_pct = 0.0f;
 
-    hvac_apply_sequence(u_pct, &g_hvac_cfg,
-                        &heater_pct, &cooler_pct, &bypass_pct);
+    /*
+     * Brak wejścia regulatora (nieprzypisane albo kanał zewnętrzny bez
+     * ważnego odczytu): wyjścia wyłączone, stan PID zamrożony do powrotu
+     * pomiaru - bez tego stara wartość albo 0 C prowadziłyby regulację.
+     */
+    bool input_ok = !isnan(t_extract);
+
+    if (input_ok != g_hvac_ctrl_input_ok) {
+        g_hvac_ctrl_input_ok = input_ok;
+        if (input_ok) {
+            LOG_INF("Control input back, regulating");
+        } else {
+            LOG_WRN("Control input missing, outputs off");
+        }
+    }
 
-    const struct hvac_io_cfg *io = &g_hvac_cfg.io;
+    if (input_ok) {
+        float sp = (float)g_hvac_ctrl_cfg.setpoint;
+        float error = sp - t_extract;
 
-    if (io->heater_ao >= 0 && io->heater_ao < HVAC_NUM_AO_CHANNELS) {
+        u_pct = hvac_pid_step(&g_hvac_ctrl_cfg.pid,
+                              &g_hvac_pid_state,
+                              error,
+                              dt_sec);
+
+        hvac_apply_sequence(u_pct, &g_hvac_ctrl_cfg,
+                            &heater_pct, &cooler_pct, &bypass_pct);
+    }
+
+    const struct hvac_io_cfg *io = &g_hvac_ctrl_cfg.io;
+
+    /* grzałka na liniach DO nie dostaje równolegle napięcia 0-10 V */
+    if (!IS_ENABLED(CONFIG_HVAC_DO_HEATER_TPWM) && !IS_ENABLED(CONFIG_HVAC_DO_HEATER_STAGED) &&
+        io->heater_ao >= 0 && io->heater_ao < HVAC_NUM_AO_CHANNELS) {
         float v = (heater_pct / 100.0f) * 10.0f;
         if (v < 0.0f) v = 0.0f;
         if (v > 10.0f) v = 10.0f;
         write_ao_voltage(io->heater_ao, v);
     }
 
-    if (io->cooler_ao >= 0 && io->cooler_ao < HVAC_NUM_AO_CHANNELS) {
+#if defined(CONFIG_HVAC_DO)
+    /* grzałka i chłodnica na SSR / stycznikach - przełącza timer w hvac_do.c */
+    hvac_do_set_pct(HVAC_DO_OUT_HEATER, heater_pct);
+    hvac_do_set_pct(HVAC_DO_OUT_COOLER, cooler_pct);
+#endif
+
+    if (!IS_ENABLED(CONFIG_HVAC_DO_COOLER_TPWM) && !IS_ENABLED(CONFIG_HVAC_DO_COOLER_STAGED) &&
+        io->cooler_ao >= 0 && io->cooler_ao < HVAC_NUM_AO_CHANNELS) {
         float v = (cooler_pct / 100.0f) * 10.0f;
         if (v < 0.0f) v = 0.0f;
         if (v > 10.0f) v = 10.0f;
@@ -1496,10 +1960,77 @@ static void hvac_control_step(float dt_sec)
         float v = (any_pct > 0.0f) ? 10.0f : 0.0f;
         write_ao_voltage(io->fan_vfd_ao, v);
     }
+
+#if defined(CONFIG_HVAC_LOG)
+    hvac_log_cycle(g_hvac_ctrl_cfg.setpoint, u_pct, g_hvac_pid_state.i_term);
+#endif
+#if defined(CONFIG_HVAC_SHELL)
+    k_spinlock_key_t key = k_spin_lock(&g_hvac_ctl_out_lock);
+    g_hvac_ctl_out.u_pct  = u_pct;
+    g_hvac_ctl_out.i_term = g_hvac_pid_state.i_term;
+    k_spin_unlock(&g_hvac_ctl_out_lock, key);
+#endif
+#if defined(CONFIG_HVAC_TELEM)
+    hvac_telem_cycle(g_hvac_ctrl_cfg.setpoint, u_pct, g_hvac_pid_state.i_term,
+                     (uint32_t)(dt_sec * 1000000.0f),
+                     k_cyc_to_us_floor32(k_cycle_get_32() - step_start));
+#endif
 }
 
 #define HVAC_CTRL_STACK_SIZE 2048
 #define HVAC_CTRL_PRIORITY   5
+#define HVAC_CTRL_PERIOD_MS  100
+
+#if !defined(CONFIG_HVAC_SIM_FAST) && !defined(CONFIG_HVAC_BENCH)
+
+#if defined(CONFIG_HVAC_DO)
+static void hvac_do_setup(void)
+{
+    if (hvac_do_init() != 0) {
+        return;
+    }
+
+    struct hvac_do_cfg heater = {
+        .mode       = HVAC_DO_MODE_OFF,
+        .first_line = CONFIG_HVAC_DO_HEATER_FIRST_LINE,
+        .min_on_ms  = CONFIG_HVAC_DO_HEATER_MIN_ON_MS,
+        .min_off_ms = CONFIG_HVAC_DO_HEATER_MIN_OFF_MS,
+    };
+
+#if defined(CONFIG_HVAC_DO_HEATER_TPWM)
+    heater.mode      = HVAC_DO_MODE_TPWM;
+    heater.period_ms = CONFIG_HVAC_DO_HEATER_PERIOD_MS;
+#elif defined(CONFIG_HVAC_DO_HEATER_STAGED)
+    heater.mode       = HVAC_DO_MODE_STAGED;
+    heater.num_stages = CONFIG_HVAC_DO_HEATER_STAGES;
+#endif
+
+    int ret = hvac_do_configure(HVAC_DO_OUT_HEATER, &heater);
+    if (ret != 0) {
+        LOG_ERR("Heater DO configure failed: %d", ret);
+    }
+
+    struct hvac_do_cfg cooler = {
+        .mode       = HVAC_DO_MODE_OFF,
+        .first_line = CONFIG_HVAC_DO_COOLER_FIRST_LINE,
+        .min_on_ms  = CONFIG_HVAC_DO_COOLER_MIN_ON_MS,
+        .min_off_ms = CONFIG_HVAC_DO_COOLER_MIN_OFF_MS,
+    };
+
+#if defined(CONFIG_HVAC_DO_COOLER_TPWM)
+    cooler.mode      = HVAC_DO_MODE_TPWM;
+    cooler.period_ms = CONFIG_HVAC_DO_COOLER_PERIOD_MS;
+#elif defined(CONFIG_HVAC_DO_COOLER_STAGED)
+    cooler.mode       = HVAC_DO_MODE_STAGED;
+    cooler.num_stages = CONFIG_HVAC_DO_COOLER_STAGES;
+#endif
+
+    ret = hvac_do_configure(HVAC_DO_OUT_COOLER, &cooler);
+    if (ret != 0) {
+        LOG_ERR("Cooler DO configure failed: %d", ret);
+    }
+}
+#endif
 
 static void hvac_control_thread(void *p1, void *p2, void *p3)
 {
@@ -1508,6 +2039,11 @@ static void hvac_control_thread(void *p1, void *p2, void *p3)
     ARG_UNUSED(p3);
 
     hvac_pid_reset(&g_hvac_pid_state);
+    hvac_io_init();
+
+#if defined(CONFIG_HVAC_DO)
+    hvac_do_setup();
+#endif
 
     int64_t last_ctrl_ms = k_uptime_get();
 
@@ -1515,13 +2051,23 @@ static void hvac_control_thread(void *p1, void *p2, void *p3)
         int64_t now_ms  = k_uptime_get();
         int64_t diff_ms = now_ms - last_ctrl_ms;
 
-        if (diff_ms >= 100) {
+        if (diff_ms >= HVAC_CTRL_PERIOD_MS) {
             float dt_sec = diff_ms / 1000.0f;
+
+            /* ramka wejść jest zwykle gotowa - odczyt startuje przed cyklem */
+            if (hvac_io_cycle_begin(K_MSEC(HVAC_CTRL_PERIOD_MS)) != 0) {
+                LOG_WRN("Input frame not available");
+#if defined(CONFIG_HVAC_JOURNAL)
+                hvac_journal_add(HVAC_EV_IO_FRAME_LATE, 0, 0);
+#endif
+            }
+
             hvac_control_step(dt_sec);
+            hvac_io_cycle_end(HVAC_CTRL_PERIOD_MS * USEC_PER_MSEC);
             last_ctrl_ms = now_ms;
         }
 
-        k_msleep(10);
+        k_sleep(K_TIMEOUT_ABS_MS(last_ctrl_ms + HVAC_CTRL_PERIOD_MS));
     }
 }
 
@@ -1529,18 +2075,289 @@ K_THREAD_DEFINE(hvac_ctrl_thread_id,
                 HVAC_CTRL_STACK_SIZE,
                 hvac_control_thread,
                 NULL, NULL, NULL,
-                HVAC_CTRL_PRIORITY, 0, 0);
+                HVAC_CTRL_PRIORITY, 0, SYS_FOREVER_MS);  /* startuje main() */
+
+#endif /* !CONFIG_HVAC_SIM_FAST && !CONFIG_HVAC_BENCH */
+
+#if defined(CONFIG_HVAC_SIM_FAST)
+/* --- Symulacja przyspieszona (native_sim, bez okna) --- */
+
+/*
+ * Pętla regulacji, sekwencja i obiekt liczone w czasie wirtualnym:
+ * krok obiektu -> ramka wejść -> hvac_control_step() -> ramka wyjść.
+ * Nic tu nie śpi, więc doba symulacji trwa kilka sekund.
+ */
+static int hvac_sim_fast_run(void)
+{
+    struct hvac_config cfg;
+    int ret;
+
+#if CONFIG_HVAC_SIM_FAST_CONFIG == 2
+    ret = hvac_load_config_from_json(hvac_config2_json, sizeof(hvac_config2_json), &cfg);
+    cfg.sequence_type = "cool_rec_dead_rec_heat";
+#else
+    ret = hvac_load_config_from_json(hvac_config1_json, sizeof(hvac_config1_json), &cfg);
+    cfg.sequence_type = "cool_dead_heat";
+#endif
+    if (ret != 0) {
+        printk("SIM: config %d load failed: %d\n", CONFIG_HVAC_SIM_FAST_CONFIG, ret);
+        return 1;
+    }
+
+    /* bez hvac_apply_config() - nie ma ekranów do odświeżenia */
+    g_hvac_cfg = cfg;
+    hvac_cfg_publish(&g_hvac_cfg);
+    hvac_io_init();
+    hvac_sim_set_io_map(&g_hvac_cfg.io);
+
+    struct hvac_sim_disturbance dist;
+    hvac_sim_get_disturbance(&dist);
+
+    const float dt_sec = HVAC_CTRL_PERIOD_MS / 1000.0f;
+    /* 64 bity: rok to 3.15e10 ms, więcej niż mieści uint32 */
+    const uint64_t steps = (uint64_t)CONFIG_HVAC_SIM_FAST_HOURS * 3600U * 1000U /
+                           HVAC_CTRL_PERIOD_MS;
+    const uint64_t step_at = (uint64_t)CONFIG_HVAC_SIM_FAST_T_OUT_STEP_AT_H * 3600U * 1000U /
+                             HVAC_CTRL_PERIOD_MS;
+
+    hvac_sim_stats_reset((float)g_hvac_cfg.setpoint,
+                         CONFIG_HVAC_SIM_FAST_SETTLE_BAND_DC / 10.0f);
+
+    for (uint64_t i = 0; i < steps; i++) {
+        if (i == step_at && CONFIG_HVAC_SIM_FAST_T_OUT_STEP_DC != 0) {
+            dist.t_out_step_c = CONFIG_HVAC_SIM_FAST_T_OUT_STEP_DC / 10.0f;
+            hvac_sim_set_disturbance(&dist);
+        }
+
+        hvac_sim_step(dt_sec);
+
+        if (hvac_io_cycle_begin(K_NO_WAIT) != 0) {
+            printk("SIM: input frame not available at step %llu\n", (unsigned long long)i);
+            return 1;
+        }
+        hvac_control_step(dt_sec);
+        hvac_io_cycle_end(HVAC_CTRL_PERIOD_MS * USEC_PER_MSEC);
+    }
+
+    struct hvac_sim_summary sum;
+    struct hvac_sim_state st;
+    hvac_sim_stats_get(&sum);
+    hvac_sim_get_state(&st);
+
+    printk("SIM: config=%d duration_h=%.2f setpoint_c=%d band_c=%.1f\n",
+           CONFIG_HVAC_SIM_FAST_CONFIG, (double)(sum.duration_s / 3600.0f),
+           g_hvac_cfg.setpoint, (double)(CONFIG_HVAC_SIM_FAST_SETTLE_BAND_DC / 10.0f));
+    printk("SIM: settling_s=%.0f overshoot_c=%.2f iae_ch=%.2f final_extract_c=%.2f\n",
+           (double)sum.settling_time_s, (double)sum.overshoot_c,
+           (double)sum.iae_ch, (double)st.t_extract_c);
+    printk("SIM: travel_pct heater=%.0f cooler=%.0f bypass=%.0f fan=%.0f\n",
+           (double)sum.travel_pct[HVAC_SIM_ACT_HEATER],
+           (double)sum.travel_pct[HVAC_SIM_ACT_COOLER],
+           (double)sum.travel_pct[HVAC_SIM_ACT_BYPASS],
+           (double)sum.travel_pct[HVAC_SIM_ACT_FAN]);
+    printk("SIM: energy_h heater=%.2f cooler=%.2f fan=%.2f\n",
+           (double)sum.energy_h[HVAC_SIM_ACT_HEATER],
+           (double)sum.energy_h[HVAC_SIM_ACT_COOLER],
+           (double)sum.energy_h[HVAC_SIM_ACT_FAN]);
+
+    /* kod wyjścia dla skryptów: 2 = regulator nie wszedł w pasmo */
+    return (sum.settling_time_s < 0.0f) ? 2 : 0;
+}
+#endif /* CONFIG_HVAC_SIM_FAST */
+
+#if defined(CONFIG_HVAC_BENCH)
+/* --- Benchmarki ścieżki regulacji --- */
+
+static struct {
+    float error[HVAC_BENCH_NUM_INPUTS];
+    float u_pct[HVAC_BENCH_NUM_INPUTS];
+    int32_t setpoint[HVAC_BENCH_NUM_INPUTS];
+    const struct hvac_config *cfg[HVAC_BENCH_NUM_INPUTS];
+    const char *json[HVAC_BENCH_NUM_INPUTS];
+    size_t json_len[HVAC_BENCH_NUM_INPUTS];
+} hvac_bench_in;
+
+static struct hvac_config hvac_bench_cfg[2];
+static volatile float hvac_bench_sink;
+
+static void hvac_bench_pid_step(void *ctx, uint32_t idx)
+{
+    struct hvac_pid_state *st = ctx;
+
+    hvac_bench_sink = hvac_pid_step(&hvac_bench_cfg[0].pid, st,
+                                    hvac_bench_in.error[idx % HVAC_BENCH_NUM_INPUTS],
+                                    HVAC_CTRL_PERIOD_MS / 1000.0f);
+}
+
+static void hvac_bench_apply_sequence(void *ctx, uint32_t idx)
+{
+    float heater_pct, cooler_pct, bypass_pct;
+
+    ARG_UNUSED(ctx);
+    idx %= HVAC_BENCH_NUM_INPUTS;
+
+    hvac_apply_sequence(hvac_bench_in.u_pct[idx], hvac_bench_in.cfg[idx],
+                        &heater_pct, &cooler_pct, &bypass_pct);
+    hvac_bench_sink = heater_pct + cooler_pct + bypass_pct;
+}
+
+static void hvac_bench_control_step(void *ctx, uint32_t idx)
+{
+    ARG_UNUSED(ctx);
+
+    /* uchyb przemiatany przez zadaną - wejścia czytane z obrazu procesu */
+    g_hvac_cfg.setpoint = hvac_bench_in.setpoint[idx % HVAC_BENCH_NUM_INPUTS];
+    hvac_cfg_publish(&g_hvac_cfg);
+    hvac_control_step(HVAC_CTRL_PERIOD_MS / 1000.0f);
+}
+
+#if defined(CONFIG_HVAC_CFG_BIN)
+static void hvac_bench_load_bin(void *ctx, uint32_t idx)
+{
+    struct hvac_config cfg;
+
+    ARG_UNUSED(ctx);
+
+    if (hvac_bench_in.json[idx % HVAC_BENCH_NUM_INPUTS] == hvac_config2_json) {
+        (void)hvac_cfg_bin_load(hvac_config2_bin, sizeof(hvac_config2_bin), &cfg);
+    } else {
+        (void)hvac_cfg_bin_load(hvac_config1_bin, sizeof(hvac_config1_bin), &cfg);
+    }
+    hvac_bench_sink = (float)cfg.setpoint;
+}
+#endif
+
+static void hvac_bench_load_json(void *ctx, uint32_t idx)
+{
+    struct hvac_config cfg;
+
+    ARG_UNUSED(ctx);
+    idx %= HVAC_BENCH_NUM_INPUTS;
+
+    (void)hvac_load_config_from_json(hvac_bench_in.json[idx],
+                                     hvac_bench_in.json_len[idx], &cfg);
+    hvac_bench_sink = (float)cfg.setpoint;
+}
+
+static int hvac_bench_main(void)
+{
+    struct hvac_bench_result res;
+    struct hvac_pid_state pid_st;
+    int failed = 0;
+
+    if (hvac_bench_init() != 0) {
+        return 1;
+    }
+
+    if (hvac_load_config_from_json(hvac_config1_json, sizeof(hvac_config1_json),
+                                   &hvac_bench_cfg[0]) != 0 ||
+        hvac_load_config_from_json(hvac_config2_json, sizeof(hvac_config2_json),
+                                   &hvac_bench_cfg[1]) != 0) {
+        printk("BENCH: built-in config load failed\n");
+        return 1;
+    }
+
+    for (int i = 0; i < HVAC_BENCH_NUM_INPUTS; i++) {
+        int c = hvac_bench_rand() & 1;
+
+        hvac_bench_in.error[i]    = hvac_bench_rand_range(-20.0f, 20.0f);
+        hvac_bench_in.u_pct[i]    = hvac_bench_rand_range(-100.0f, 100.0f);
+        hvac_bench_in.setpoint[i] = 15 + (int32_t)(hvac_bench_rand() % 11);
+        hvac_bench_in.cfg[i]      = &hvac_bench_cfg[c];
+        hvac_bench_in.json[i]     = c ? hvac_config2_json : hvac_config1_json;
+        hvac_bench_in.json_len[i] = c ? sizeof(hvac_config2_json) : sizeof(hvac_config1_json);
+    }
+
+    g_hvac_cfg = hvac_bench_cfg[0];
+    hvac_cfg_publish(&g_hvac_cfg);
+    hvac_io_init();
+
+    hvac_pid_reset(&pid_st);
+    if (hvac_bench_run("hvac_pid_step", hvac_bench_pid_step, &pid_st,
+                       CONFIG_HVAC_BENCH_BUDGET_PID_NS, &res) != 0) {
+        failed++;
+    }
+    hvac_bench_print(&res);
+
+    if (hvac_bench_run("hvac_apply_sequence", hvac_bench_apply_sequence, NULL,
+                       CONFIG_HVAC_BENCH_BUDGET_SEQ_NS, &res) != 0) {
+        failed++;
+    }
+    hvac_bench_print(&res);
+
+    if (hvac_bench_run("hvac_control_step", hvac_bench_control_step, NULL,
+                       CONFIG_HVAC_BENCH_BUDGET_CTRL_NS, &res) != 0) {
+        failed++;
+    }
+    hvac_bench_print(&res);
+
+    if (hvac_bench_run("hvac_load_config_from_json", hvac_bench_load_json, NULL,
+                       CONFIG_HVAC_BENCH_BUDGET_JSON_NS, &res) != 0) {
+        failed++;
+    }
+    hvac_bench_print(&res);
+
+#if defined(CONFIG_HVAC_CFG_BIN)
+    if (hvac_bench_run("hvac_cfg_bin_load", hvac_bench_load_bin, NULL,
+                       CONFIG_HVAC_BENCH_BUDGET_BIN_NS, &res) != 0) {
+        failed++;
+    }
+    hvac_bench_print(&res);
+#endif
+
+    printk("BENCH: %s (%d over budget)\n", failed ? "FAIL" : "PASS", failed);
+    return failed ? 1 : 0;
+}
+#endif /* CONFIG_HVAC_BENCH */
 
 /* --- Zastosowanie konfiguracji --- */
 
+/*
+ * Nowy config trafia do pętli regulacji w całości (podmiana na początku
+ * następnego kroku), a na ekranach odświeżane są tylko widżety pól,
+ * które faktycznie się zmieniły.
+ */
 static void hvac_apply_config(const struct hvac_config *cfg)
 {
+    uint32_t changed = hvac_cfg_diff(&g_hvac_cfg, cfg);
+    if (changed == 0) {
+        return;
+    }
+
+    struct hvac_io_cfg old_io = g_hvac_cfg.io;
+
     g_hvac_cfg = *cfg;
+    hvac_cfg_publish(&g_hvac_cfg);
 
-    hvac_pid_reset(&g_hvac_pid_state);
-    hvac_refresh_io_role_labels();
-    hvac_refresh_dashboard();
-    hvac_refresh_sequence_viewer();
+#if defined(CONFIG_HVAC_JOURNAL)
+    hvac_journal_add(HVAC_EV_CFG_APPLIED, 0, (int32_t)changed);
+#endif
+
+#if defined(CONFIG_HVAC_IO_BACKEND_SIM)
+    if (changed & (HVAC_CFG_CH_IO_AI | HVAC_CFG_CH_IO_AO)) {
+        hvac_sim_set_io_map(&g_hvac_cfg.io);
+    }
+#endif
+#if defined(CONFIG_HVAC_PERSIST)
+    if (changed & (HVAC_CFG_CH_SETPOINT | HVAC_CFG_CH_SEQ_BANDS)) {
+        hvac_persist_request(&g_hvac_cfg);
+    }
+#endif
+
+    if (changed & (HVAC_CFG_CH_IO_AI | HVAC_CFG_CH_IO_AO)) {
+        hvac_refresh_io_role_labels_diff(&old_io);
+    }
+    if (changed & HVAC_CFG_CH_SETPOINT) {
+        hvac_refresh_dashboard_setpoint();
+    }
+    for (int i = 0; i < HVAC_SEQ_IDX_COUNT; i++) {
+        if (changed & hvac_seq_band_change_bits[i]) {
+            hvac_refresh_dashboard_seq_row(i);
+        }
+    }
+    if (changed & HVAC_CFG_CH_SEQ_TYPE) {
+        hvac_refresh_sequence_viewer();
+    }
 }
 
 /* --- Callbacki ładowania configu --- */
@@ -1550,11 +2367,16 @@ static void on_btn_load_cfg1(lv_event_t *e)
     ARG_UNUSED(e);
 
     struct hvac_config tmp;
+#if defined(CONFIG_HVAC_CFG_BIN)
+    /* obraz binarny sprawdzany w miejscu - bez parsowania */
+    int ret = hvac_cfg_bin_load(hvac_config1_bin, sizeof(hvac_config1_bin), &tmp);
+#else
     int ret = hvac_load_config_from_json(
         hvac_config1_json,
         sizeof(hvac_config1_json),
         &tmp
     );
+#endif
 
     if (ret == 0) {
         tmp.sequence_type = "cool_dead_heat";  /* ręcznie ustawiamy typ sekwencji */
@@ -1570,11 +2392,16 @@ static void on_btn_load_cfg2(lv_event_t *e)
     ARG_UNUSED(e);
 
     struct hvac_config tmp;
+#if defined(CONFIG_HVAC_CFG_BIN)
+    /* obraz binarny sprawdzany w miejscu - bez parsowania */
+    int ret = hvac_cfg_bin_load(hvac_config2_bin, sizeof(hvac_config2_bin), &tmp);
+#else
     int ret = hvac_load_config_from_json(
         hvac_config2_json,
         sizeof(hvac_config2_json),
         &tmp
     );
+#endif
 
     if (ret == 0) {
         tmp.sequence_type = "cool_rec_dead_rec_heat";  /* tutaj drugi typ */
@@ -1585,12 +2412,111 @@ static void on_btn_load_cfg2(lv_event_t *e)
     }
 }
 
+#if defined(CONFIG_HVAC_STORAGE)
+/* --- Karta SD --- */
+
+/* wątek karty - tu wolno czekać na kartę, UI dowiaduje się przez flagi */
+static void hvac_on_storage(enum hvac_storage_event ev)
+{
+    switch (ev) {
+    case HVAC_STORAGE_EV_MOUNTED:
+#if defined(CONFIG_HVAC_JOURNAL)
+        hvac_journal_add(HVAC_EV_SD_MOUNTED, 0, 0);
+#endif
+#if defined(CONFIG_HVAC_CFG_CATALOG)
+        /* jedno przejście po katalogu - przeindeksowane są tylko zmienione pliki */
+        (void)hvac_cfg_catalog_scan();
+        atomic_set(&catalog_dirty, 1);
+#endif
+#if defined(CONFIG_HVAC_LOG_BACKEND_SD)
+        (void)hvac_log_start(HVAC_CTRL_PERIOD_MS);
+#elif defined(CONFIG_HVAC_LOG_LFS_OFFLOAD)
+        /* rejestrator pisze do flasha dalej, na kartę idą zamknięte pliki */
+        (void)hvac_log_lfs_offload(CONFIG_HVAC_LOG_LFS_OFFLOAD_DIR);
+#endif
+#if defined(CONFIG_HVAC_ASSETS)
+        /* przełączenie w pętli UI */
+        (void)hvac_assets_load();
+#endif
+        break;
+
+    case HVAC_STORAGE_EV_REMOVED:
+#if defined(CONFIG_HVAC_JOURNAL)
+        hvac_journal_add(HVAC_EV_SD_REMOVED, 0, 0);
+#endif
+#if defined(CONFIG_HVAC_LOG_BACKEND_SD)
+        (void)hvac_log_stop();
+#endif
+#if defined(CONFIG_HVAC_CFG_CATALOG)
+        hvac_cfg_catalog_clear();
+        atomic_set(&catalog_dirty, 1);
+#endif
+        break;
+    }
+}
+#endif /* CONFIG_HVAC_STORAGE */
+
 /* --- main() --- */
 
 int main(void)
 {
+#if defined(CONFIG_HVAC_SIM_FAST)
+    posix_exit(hvac_sim_fast_run());
+#elif defined(CONFIG_HVAC_BENCH)
+    int bench_ret = hvac_bench_main();
+#if defined(CONFIG_ARCH_POSIX)
+    posix_exit(bench_ret);
+#endif
+    return bench_ret;
+#endif
+
     LOG_INF("Starting LVGL UI with JSON config loader + HVAC PI controller (placeholders IO)");
 
+#if !defined(CONFIG_HVAC_SIM_FAST) && !defined(CONFIG_HVAC_BENCH)
+#if defined(CONFIG_HVAC_PERSIST)
+    /* nastawy z flasha muszą być wczytane przed pierwszym krokiem regulacji */
+    if (hvac_persist_init() == 0) {
+        hvac_persist_load(&g_hvac_cfg);
+    }
+#endif
+#if defined(CONFIG_HVAC_JOURNAL)
+    (void)hvac_journal_init();
+#endif
+    /* pierwsza publikacja przed startem pętli - g_hvac_ctrl_cfg jest jeszcze pusty */
+    hvac_cfg_publish(&g_hvac_cfg);
+    k_thread_start(hvac_ctrl_thread_id);
+#endif
+
+#if defined(CONFIG_HVAC_LOG_BACKEND_LFS)
+    /* flash jest zawsze na miejscu - rejestrator startuje od razu, bez karty */
+    if (hvac_log_lfs_mount() == 0) {
+        (void)hvac_log_start(HVAC_CTRL_PERIOD_MS);
+    }
+#endif
+#if defined(CONFIG_HVAC_MODBUS) && !defined(CONFIG_HVAC_SIM_FAST) && !defined(CONFIG_HVAC_BENCH)
+    (void)hvac_modbus_start(&hvac_mb_ops);
+#endif
+#if defined(CONFIG_HVAC_MB_MASTER) && !defined(CONFIG_HVAC_SIM_FAST) && !defined(CONFIG_HVAC_BENCH)
+    (void)hvac_mb_master_start();
+#endif
+#if defined(CONFIG_HVAC_HTTP) && !defined(CONFIG_HVAC_SIM_FAST) && !defined(CONFIG_HVAC_BENCH)
+    (void)hvac_http_start(&hvac_http_ops);
+#endif
+#if defined(CONFIG_HVAC_TELEM) && !defined(CONFIG_HVAC_SIM_FAST) && !defined(CONFIG_HVAC_BENCH)
+    (void)hvac_telem_start();
+#endif
+#if defined(CONFIG_HVAC_SHELL) && !defined(CONFIG_HVAC_SIM_FAST) && !defined(CONFIG_HVAC_BENCH)
+    hvac_shell_init(&hvac_shell_ops);
+#endif
+#if defined(CONFIG_HVAC_LV_FS)
+    hvac_lv_fs_init();
+#endif
+#if defined(CONFIG_HVAC_STORAGE)
+    /* montaż w tle - ekrany startują z obrazami z flasha, paczka dochodzi po montażu */
+    (void)hvac_storage_subscribe(hvac_on_storage);
+    (void)hvac_storage_start();
+#endif
+
     display_dev = DEVICE_DT_GET(DT_CHOSEN(zephyr_display));
     if (!device_is_ready(display_dev)) {
         LOG_ERR("Display device not ready");
@@ -1601,6 +2527,9 @@ int main(void)
     create_io_screen();
     create_config_screen();
     create_seq_viewer_screen();
+#if defined(CONFIG_HVAC_JOURNAL)
+    create_diag_screen();
+#endif
 
     lv_scr_load(screen_dashboard);
 
@@ -1611,11 +2540,35 @@ int main(void)
     while (1) {
         lv_timer_handler();
 
+#if defined(CONFIG_HVAC_ASSETS)
+        /* paczka wczytana po włożeniu karty albo przeładowana z powłoki */
+        (void)hvac_assets_apply_pending(hvac_refresh_assets);
+#endif
+#if defined(CONFIG_HVAC_CFG_CATALOG)
+        if (atomic_cas(&catalog_dirty, 1, 0)) {
+            hvac_refresh_catalog_page();
+        }
+#endif
+#if defined(HVAC_REMOTE_CFG)
+        {
+            struct hvac_config remote;
+
+            if (hvac_take_remote_config(&remote)) {
+                hvac_apply_config(&remote);
+            }
+        }
+#endif
+
         int64_t now_ms  = k_uptime_get();
         int64_t diff_ms = now_ms - last_io_update_ms;
 
         if (diff_ms >= 1000) {
             hvac_update_io_values();
+#if defined(CONFIG_HVAC_JOURNAL)
+            if (diag_follow && lv_scr_act() == screen_diag) {
+                hvac_refresh_diag_page();
+            }
+#endif
             last_io_update_ms = now_ms;
         }
 